@@ -89,6 +89,14 @@ void L76B::handle_uart() {
         if (c == '\n' || c == '\r') {
             rx_buffer[rx_buffer_index] = '\0';  // Null-terminate the string
 
+            // Every sentence to the log, the parser only needs RMC
+            if (rx_buffer[0] == '$') {
+                NMEASentence sentence;
+                sentence.ms = systime();
+                memcpy(sentence.text, rx_buffer, rx_buffer_index + 1);
+                queue_try_add(&nmea_queue, &sentence);
+            }
+
             if (strncmp(rx_buffer, "$GNRMC", 6) == 0) {
                 parse(rx_buffer);
             }
@@ -154,6 +162,17 @@ void L76B::parse(const char* buffer) {
     working_data.timestamp = to_epoch(date, time);
     working_data.status = (working_data.timestamp != 0);
 
+    // Milliseconds from the string, a float of hhmmss.sss cannot hold them
+    working_data.ms = 0;
+    const char* fraction = strchr(tokens[1], '.');
+    if (fraction) {
+        int scale = 100;
+        for (const char* digit = fraction + 1; *digit >= '0' && *digit <= '9' && scale > 0; digit++) {
+            working_data.ms += (*digit - '0') * scale;
+            scale /= 10;
+        }
+    }
+
     // Update kalman and share data
     share();
 }
@@ -198,7 +217,8 @@ void L76B::share() {
         .lon = kf.getLongitude(),
         .speed = kf.getSpeed(),
         .course = kf.getCourse(),
-        .status = true  // Always valid if filtered
+        .status = true,  // Always valid if filtered
+        .ms = working_data.ms
     };
     mutex_exit(&filtered_data_mutex);
 
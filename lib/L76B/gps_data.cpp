@@ -11,3 +11,5 @@ GPSBuffer gps_buffer[GPS_BUFFER_SIZE] = {};
 size_t gps_buffer_index = 0;
 size_t gps_buffer_count = 0;
 mutex_t gps_buffer_mutex;
+
+queue_t nmea_queue;
@@ -1,5 +1,6 @@
 #pragma once
 #include "pico/sync.h"
+#include "pico/util/queue.h"
 
 #define GPS_BUFFER_SIZE 100
 
@@ -11,6 +12,7 @@ struct GPSFix {
     float speed;     // Speed in knots
     float course;    // Course in degrees
     bool status;     // Status flag (true if valid fix)
+    uint16_t ms;     // Milliseconds past timestamp, fixes come at 5 Hz
 };
 
 // Dual buffer of raw and filtered data
@@ -43,3 +45,14 @@ extern mutex_t raw_data_mutex;
 // Shared filtered fix data from Kalman filter
 extern GPSFix filtered_data;
 extern mutex_t filtered_data_mutex;
+
+// Every NMEA sentence the receiver sends, from the UART interrupt on core 1
+// to the logger on core 0; dropped when the queue is full
+#define NMEA_QUEUE_SIZE 16
+
+struct NMEASentence {
+    uint32_t ms;     // Boot time it came in at
+    char text[83];   // From '$' to the line end, NUL terminated
+};
+
+extern queue_t nmea_queue;
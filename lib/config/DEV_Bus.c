@@ -0,0 +1,209 @@
+/*****************************************************************************
+* | File      	:	DEV_Bus.c
+* | Function    :	Arbiter of the SPI bus shared by the LCD, touch and SD card
+* | Info        :
+*   The state is guarded by a hardware spin lock, so the LCD transport
+*   can give the bus back from its DMA IRQ on either core. Waiters sleep
+*   in WFE; a release sends an event to wake the other core.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+* | Info        :   Basic version
+*
+******************************************************************************/
+#include "DEV_Bus.h"
+#include "hardware/sync.h"
+
+typedef struct {
+	UDOUBLE Baudrate;
+	spi_cpol_t Cpol;
+	spi_cpha_t Cpha;
+} DEV_BUS_CONFIG;
+
+DEV_BUS_STATS sDev_Bus_Stats[DEV_BUS_NUM];
+
+//The SD card has to start at 400 kHz, its driver raises the clock after
+static DEV_BUS_CONFIG Bus_Config[DEV_BUS_NUM] = {
+	{SPI_BAUDRATE, SPI_CPOL_0, SPI_CPHA_0},		//LCD
+	{SPI_BAUDRATE, SPI_CPOL_0, SPI_CPHA_0},		//Touch, TP_Init lowers it
+	{400 * 1000, SPI_CPOL_0, SPI_CPHA_0},		//SD card
+};
+
+static spin_lock_t *Bus_Lock;
+static volatile DEV_BUS_DEV Bus_Owner = DEV_BUS_NUM;		//DEV_BUS_NUM while the bus is free
+static volatile uint8_t Bus_Depth;					//Nested acquires of the owner
+static volatile uint Bus_Owner_Core;				//The core that took it, the only one that may nest
+static volatile uint16_t Bus_Waiting[DEV_BUS_NUM];
+static uint64_t Bus_Grant_Us;
+static DEV_BUS_CONFIG Bus_Applied = {SPI_BAUDRATE, SPI_CPOL_0, SPI_CPHA_0};
+static UDOUBLE Bus_Clock_Hz;						//What the port made of Bus_Applied.Baudrate
+
+/******************************************************************************
+function:	Set up the arbiter, with the port at the clock spi_init gave it
+******************************************************************************/
+void DEV_Bus_Init(void)
+{
+	if(Bus_Lock)
+		return;
+	Bus_Lock = spin_lock_init(spin_lock_claim_unused(true));
+	Bus_Clock_Hz = spi_get_baudrate(SPI_PORT);
+}
+
+/******************************************************************************
+function:	Clock and mode of a device, from its next transaction on
+******************************************************************************/
+void DEV_Bus_SetClock(DEV_BUS_DEV Dev, UDOUBLE Baudrate)
+{
+	Bus_Config[Dev].Baudrate = Baudrate;
+}
+
+void DEV_Bus_SetMode(DEV_BUS_DEV Dev, spi_cpol_t Cpol, spi_cpha_t Cpha)
+{
+	Bus_Config[Dev].Cpol = Cpol;
+	Bus_Config[Dev].Cpha = Cpha;
+}
+
+/******************************************************************************
+function:	Whether the bus can go to Dev, with the lock held
+******************************************************************************/
+static bool DEV_Bus_Grantable(DEV_BUS_DEV Dev)
+{
+	uint8_t i;
+
+	if(Bus_Owner != DEV_BUS_NUM)
+		return false;
+	for(i = 0; i < Dev; i++) {
+		if(Bus_Waiting[i])
+			return false;
+	}
+	return true;
+}
+
+/******************************************************************************
+function:	Take the bus for a transaction
+parameter:
+	Dev :   The device, its clock and mode are set before this returns
+note:
+	Blocks until every transaction in front of it, and every more urgent
+	device that asks meanwhile, is done. The owner may acquire again on
+	the core that took the bus, each acquire needs its release; the same
+	device on the other core waits like any other. The release may come
+	from either core.
+******************************************************************************/
+void DEV_Bus_Acquire(DEV_BUS_DEV Dev)
+{
+	DEV_BUS_STATS *pStats = &sDev_Bus_Stats[Dev];
+	DEV_BUS_CONFIG *pConfig = &Bus_Config[Dev];
+	uint64_t Start = 0, Waited;
+	uint32_t Irq;
+
+	Irq = spin_lock_blocking(Bus_Lock);
+	if(Bus_Owner == Dev && Bus_Owner_Core == get_core_num()) {
+		Bus_Depth++;
+		spin_unlock(Bus_Lock, Irq);
+		return;
+	}
+	if(!DEV_Bus_Grantable(Dev)) {
+		Start = time_us_64();
+		Bus_Waiting[Dev]++;
+		do {
+			spin_unlock(Bus_Lock, Irq);
+			__wfe();
+			Irq = spin_lock_blocking(Bus_Lock);
+		} while(!DEV_Bus_Grantable(Dev));
+		Bus_Waiting[Dev]--;
+	}
+	Bus_Owner = Dev;
+	Bus_Owner_Core = get_core_num();
+	Bus_Depth = 1;
+	spin_unlock(Bus_Lock, Irq);
+
+	//Only the owner touches the port
+	if(pConfig->Baudrate != Bus_Applied.Baudrate) {
+		Bus_Clock_Hz = spi_set_baudrate(SPI_PORT, pConfig->Baudrate);
+		Bus_Applied.Baudrate = pConfig->Baudrate;
+	}
+	if(pConfig->Cpol != Bus_Applied.Cpol || pConfig->Cpha != Bus_Applied.Cpha) {
+		spi_set_format(SPI_PORT, 8, pConfig->Cpol, pConfig->Cpha, SPI_MSB_FIRST);
+		Bus_Applied.Cpol = pConfig->Cpol;
+		Bus_Applied.Cpha = pConfig->Cpha;
+	}
+
+	Bus_Grant_Us = time_us_64();
+	Waited = Start ? Bus_Grant_Us - Start : 0;
+	pStats->Grants++;
+	pStats->Wait_Us += Waited;
+	if(Waited > pStats->Wait_Max_Us)
+		pStats->Wait_Max_Us = Waited;
+}
+
+/******************************************************************************
+function:	End a transaction, the chip select has to be high already
+note:
+	Safe from an IRQ handler
+******************************************************************************/
+void DEV_Bus_Release(DEV_BUS_DEV Dev)
+{
+	uint64_t Held;
+	uint32_t Irq;
+
+	Irq = spin_lock_blocking(Bus_Lock);
+	if(Bus_Owner != Dev || --Bus_Depth) {
+		spin_unlock(Bus_Lock, Irq);
+		return;
+	}
+	Held = time_us_64() - Bus_Grant_Us;
+	if(Held > sDev_Bus_Stats[Dev].Hold_Max_Us)
+		sDev_Bus_Stats[Dev].Hold_Max_Us = Held;
+	Bus_Owner = DEV_BUS_NUM;
+	spin_unlock(Bus_Lock, Irq);
+	__sev();
+}
+
+/******************************************************************************
+function:	The clock the port runs at for the owner
+note:
+	The port divides the peripheral clock by an even prescaler and a
+	postdivider, so this is the rate asked for or the next one below it
+******************************************************************************/
+UDOUBLE DEV_Bus_GetClock(void)
+{
+	return Bus_Clock_Hz;
+}
+
+/******************************************************************************
+function:	Whether a more urgent device waits for the bus
+******************************************************************************/
+bool DEV_Bus_Wanted(DEV_BUS_DEV Dev)
+{
+	uint8_t i;
+
+	for(i = 0; i < Dev; i++) {
+		if(Bus_Waiting[i])
+			return true;
+	}
+	return false;
+}
+
+/******************************************************************************
+function:	Step aside at a transaction boundary if a more urgent device waits
+parameter:
+	Dev      :   The owner
+	Deselect :   Ends the device's part, chip select high
+	Select   :   Picks up where it left off, chip select low
+return:
+	Whether it stepped aside
+note:
+	Only for an owner that acquired once
+******************************************************************************/
+bool DEV_Bus_Yield(DEV_BUS_DEV Dev, void (*Deselect)(void), void (*Select)(void))
+{
+	if(!DEV_Bus_Wanted(Dev))
+		return false;
+	sDev_Bus_Stats[Dev].Yields++;
+	Deselect();
+	DEV_Bus_Release(Dev);
+	DEV_Bus_Acquire(Dev);
+	Select();
+	return true;
+}
@@ -0,0 +1,52 @@
+/*****************************************************************************
+* | File      	:	DEV_Bus.h
+* | Function    :	Arbiter of the SPI bus shared by the LCD, touch and SD card
+* | Info        :
+*   Each device takes the bus for one transaction, from its chip select
+*   going low until it goes high again, and gets its own clock and SPI
+*   mode while it has it. Both cores may ask. When the bus comes free it
+*   goes to the most urgent device that is waiting, in the order of
+*   DEV_BUS_DEV; the LCD first, so a log write never holds up a frame
+*   for more than one transaction. A long transfer calls DEV_Bus_Yield at
+*   its boundaries (between SD blocks) to let a more urgent device in.
+*   The SPI4W_* transfers expect the caller to hold the bus.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+* | Info        :   Basic version
+*
+******************************************************************************/
+#ifndef _DEV_BUS_H_
+#define _DEV_BUS_H_
+
+#include "DEV_Config.h"
+
+typedef enum {
+	DEV_BUS_LCD = 0,	//Most urgent first
+	DEV_BUS_TP,
+	DEV_BUS_SD,
+	DEV_BUS_NUM,
+} DEV_BUS_DEV;
+
+/**
+ * Per device counters
+**/
+typedef struct {
+	UDOUBLE Grants;			//Transactions
+	UDOUBLE Wait_Us;		//Time spent waiting for the bus
+	UDOUBLE Wait_Max_Us;
+	UDOUBLE Hold_Max_Us;	//Longest transaction
+	UDOUBLE Yields;			//Times it stepped aside for a more urgent device
+} DEV_BUS_STATS;
+extern DEV_BUS_STATS sDev_Bus_Stats[DEV_BUS_NUM];
+
+void DEV_Bus_Init(void);
+void DEV_Bus_SetClock(DEV_BUS_DEV Dev, UDOUBLE Baudrate);
+void DEV_Bus_SetMode(DEV_BUS_DEV Dev, spi_cpol_t Cpol, spi_cpha_t Cpha);
+UDOUBLE DEV_Bus_GetClock(void);
+void DEV_Bus_Acquire(DEV_BUS_DEV Dev);
+void DEV_Bus_Release(DEV_BUS_DEV Dev);
+bool DEV_Bus_Wanted(DEV_BUS_DEV Dev);
+bool DEV_Bus_Yield(DEV_BUS_DEV Dev, void (*Deselect)(void), void (*Select)(void));
+
+#endif
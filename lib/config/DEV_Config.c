@@ -11,6 +11,9 @@
 *
 ******************************************************************************/
 #include "DEV_Config.h"
+#include "DEV_Bus.h"
+
+DEV_SPI_STATS sDev_SPI_Stats;
 
 void DEV_Digital_Write(UWORD Pin, UBYTE Value)
 {
@@ -48,10 +51,33 @@ void DEV_GPIO_Init(void)
 
     DEV_Digital_Write(TP_CS_PIN, 1);
     DEV_Digital_Write(LCD_CS_PIN, 1);
-    DEV_Digital_Write(LCD_BKL_PIN, 1);  // Turn off backlight
+    DEV_Digital_Write(LCD_BKL_PIN, 1);  // Backlight on until the PWM takes over
     DEV_Digital_Write(SD_CS_PIN, 1);
 }
 
+/********************************************************************************
+function:	Backlight PWM
+note:
+	DEV_Set_PWM(Duty) : Duty 0 (off) to 1000 (always on)
+********************************************************************************/
+void DEV_PWM_Init(void)
+{
+	uint Slice = pwm_gpio_to_slice_num(LCD_BKL_PIN);
+
+	gpio_set_function(LCD_BKL_PIN, GPIO_FUNC_PWM);
+	pwm_set_wrap(Slice, BKL_PWM_WRAP);
+	pwm_set_clkdiv(Slice, BKL_PWM_DIV);
+	pwm_set_gpio_level(LCD_BKL_PIN, BKL_PWM_WRAP + 1);
+	pwm_set_enabled(Slice, true);
+}
+
+void DEV_Set_PWM(UWORD Duty)
+{
+	if(Duty > BKL_PWM_WRAP + 1)
+		Duty = BKL_PWM_WRAP + 1;
+	pwm_set_gpio_level(LCD_BKL_PIN, Duty);
+}
+
 
 /********************************************************************************
 function:	System Init
@@ -62,10 +88,12 @@ uint8_t System_Init(void)
 {
 	stdio_init_all();
 	DEV_GPIO_Init();
+	DEV_PWM_Init();
 	spi_init(SPI_PORT,SPI_BAUDRATE);
 	gpio_set_function(LCD_CLK_PIN,GPIO_FUNC_SPI);
 	gpio_set_function(LCD_MOSI_PIN,GPIO_FUNC_SPI);
 	gpio_set_function(LCD_MISO_PIN,GPIO_FUNC_SPI);
+	DEV_Bus_Init();
 
     return 0;
 }
@@ -80,14 +108,36 @@ function:	Hardware interface
 note:
 	SPI4W_Write_Byte(value) : 
 		Register hardware SPI
+	SPI4W_Write_nByte(pData, Len) :
+		Burst write, the bytes go out back to back
+		without waiting for each one to be read back
+	SPI4W_Transfer_nByte(pTx, pRx, Len) :
+		Burst write that keeps what was read back
+	The caller holds the bus, see DEV_Bus.h
 *********************************************/	
 uint8_t SPI4W_Write_Byte(uint8_t value)                                    
 {   
 	uint8_t rxDat;
 	spi_write_read_blocking(spi1,&value,&rxDat,1);
+	sDev_SPI_Stats.Bytes++;
+	sDev_SPI_Stats.Transfers++;
     return rxDat;
 }
 
+void SPI4W_Write_nByte(const uint8_t *pData, uint32_t Len)
+{
+	spi_write_blocking(spi1, pData, Len);
+	sDev_SPI_Stats.Bytes += Len;
+	sDev_SPI_Stats.Transfers++;
+}
+
+void SPI4W_Transfer_nByte(const uint8_t *pTx, uint8_t *pRx, uint32_t Len)
+{
+	spi_write_read_blocking(spi1, pTx, pRx, Len);
+	sDev_SPI_Stats.Bytes += Len;
+	sDev_SPI_Stats.Transfers++;
+}
+
 uint8_t SPI4W_Read_Byte(uint8_t value)                                    
 {
 	return SPI4W_Write_Byte(value);
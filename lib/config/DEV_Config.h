@@ -15,6 +15,7 @@
 
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
+#include "hardware/pwm.h"
 #include "stdio.h"
 
 #define UBYTE   uint8_t
@@ -32,20 +33,38 @@
 #define TP_IRQ_PIN		17
 #define SD_CS_PIN		22
 
+#define BKL_PWM_WRAP	999		//Backlight duty in 1/1000
+#define BKL_PWM_DIV		6		//150 MHz / 6 / 1000 = 25 kHz, above hearing
+
 #define SPI_PORT		spi1
 #define SPI_BAUDRATE	50 * 1000 * 1000 // 50MHz
 #define  MAX_BMP_FILES  25 
+
+/**
+ * SPI traffic counters, read them before and after a drawing call to see
+ * what it cost on the bus
+**/
+typedef struct {
+	UDOUBLE Bytes;		//Bytes clocked out on SPI_PORT
+	UDOUBLE Transfers;	//Calls into the SPI driver
+	UDOUBLE Wait_Us;	//Time the CPU spent waiting for queued LCD transfers
+} DEV_SPI_STATS;
+extern DEV_SPI_STATS sDev_SPI_Stats;
 /*------------------------------------------------------------------------------------------------------*/
 
 void DEV_Digital_Write(UWORD Pin, UBYTE Value);
 UBYTE DEV_Digital_Read(UWORD Pin);
 void DEV_GPIO_Mode(UWORD Pin, UWORD Mode);
 void DEV_GPIO_Init(void);
+void DEV_PWM_Init(void);
+void DEV_Set_PWM(UWORD Duty);
 
 uint8_t System_Init(void);
 void System_Exit(void);
 uint8_t SPI4W_Write_Byte(uint8_t value);
 uint8_t SPI4W_Read_Byte(uint8_t value);
+void SPI4W_Write_nByte(const uint8_t *pData, uint32_t Len);
+void SPI4W_Transfer_nByte(const uint8_t *pTx, uint8_t *pRx, uint32_t Len);
 
 void Driver_Delay_ms(uint32_t xms);
 void Driver_Delay_us(uint32_t xus);
@@ -0,0 +1,175 @@
+#include "fastmath.h"
+#include "pico/stdlib.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+constexpr int TABLE_SIZE = 1 << FM_SIN_TABLE_BITS;
+constexpr int QUARTER = TABLE_SIZE / 4;
+constexpr double PI = 3.14159265358979323846;
+
+// Taylor series, folded into [-pi/2, pi/2] where twelve terms are exact in double
+constexpr double seriesSin(double x) {
+    if (x > PI) {
+        x -= 2 * PI;
+    }
+    if (x > PI / 2) {
+        x = PI - x;
+    } else if (x < -PI / 2) {
+        x = -PI - x;
+    }
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 12; n++) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+// sin() at every step of the table, over one full turn; cosine is a quarter further on
+constexpr std::array<float, TABLE_SIZE> makeSinTable() {
+    std::array<float, TABLE_SIZE> table{};
+    for (int i = 0; i < TABLE_SIZE; i++) {
+        table[i] = static_cast<float>(seriesSin(2 * PI * i / TABLE_SIZE));
+    }
+    return table;
+}
+
+constexpr std::array<float, TABLE_SIZE> SIN_TABLE = makeSinTable();
+
+constexpr float STEPS_PER_RAD = TABLE_SIZE / (2 * PI);
+
+// One step in two parts, the first short enough that k times it is exact in
+// float for |k| < 2^16, so the remainder keeps the precision of the angle
+constexpr float STEP_HI = static_cast<int32_t>(2 * PI / TABLE_SIZE * 65536) / 65536.0f;
+constexpr float STEP_LO = static_cast<float>(2 * PI / TABLE_SIZE - STEP_HI);
+
+}  // namespace
+
+// Nearest table entry k and the remainder d, at most half a step, then
+// sin(k + d) = sin k cos d + cos k sin d with the first terms of the
+// series for cos d and sin d. Full accuracy up to 1000 rad either side.
+void FM_SinCos(float Angle, float* pSin, float* pCos) {
+    float t = Angle * STEPS_PER_RAD;
+    int32_t k = static_cast<int32_t>(t + (t >= 0 ? 0.5f : -0.5f));
+    float d = (Angle - k * STEP_HI) - k * STEP_LO;
+    float d2 = d * d;
+    float sinD = d - d * d2 * (1.0f / 6.0f);
+    float cosD = 1.0f - d2 * 0.5f;
+
+    float sinK = SIN_TABLE[k & (TABLE_SIZE - 1)];
+    float cosK = SIN_TABLE[(k + QUARTER) & (TABLE_SIZE - 1)];
+    *pSin = sinK * cosD + cosK * sinD;
+    *pCos = cosK * cosD - sinK * sinD;
+}
+
+float FM_Sin(float Angle) {
+    float s, c;
+    FM_SinCos(Angle, &s, &c);
+    return s;
+}
+
+float FM_Cos(float Angle) {
+    float s, c;
+    FM_SinCos(Angle, &s, &c);
+    return c;
+}
+
+// atan() on [0, 1] from Abramowitz and Stegun 4.4.49 (error 2e-8), then
+// unfolded into the octant and quadrant of (X, Y)
+float FM_Atan2(float Y, float X) {
+    float ax = std::fabs(X);
+    float ay = std::fabs(Y);
+    if (ax == 0 && ay == 0) {
+        return 0;
+    }
+
+    float z = ay > ax ? ax / ay : ay / ax;
+    float z2 = z * z;
+    float a = z * (1.0f + z2 * (-0.3333314528f + z2 * (0.1999355085f + z2 * (-0.1420889944f +
+              z2 * (0.1065626393f + z2 * (-0.0752896400f + z2 * (0.0429096138f +
+              z2 * (-0.0161657367f + z2 * 0.0028662257f))))))));
+
+    if (ay > ax) {
+        a = FM_PI / 2 - a;
+    }
+    if (X < 0) {
+        a = FM_PI - a;
+    }
+    return Y < 0 ? -a : a;
+}
+
+// Degrees into [0, 360), for any sign and number of turns
+float FM_Wrap360(float Degrees) {
+    float r = Degrees - 360.0f * std::floor(Degrees * (1.0f / 360.0f));
+    return r >= 360.0f ? r - 360.0f : r;
+}
+
+namespace {
+
+constexpr int BENCH_CALLS = 2000;
+volatile float g_sink;
+
+// Microseconds per call of fn over angles spread across two turns
+template <typename Fn>
+float timeCalls(Fn fn) {
+    float sum = 0;
+    uint64_t start = time_us_64();
+    for (int i = 0; i < BENCH_CALLS; i++) {
+        sum += fn(i * 0.00629f - 6.29f);
+    }
+    uint64_t us = time_us_64() - start;
+    g_sink = sum;
+    return static_cast<float>(us) / BENCH_CALLS;
+}
+
+}  // namespace
+
+/******************************************************************************
+function:	Check the approximations against libm and time both
+note:
+	Prints the largest error over a sweep of angles, and directions at
+	radii from 1e-4 to 1e4 for atan2, then the time per call of each
+	function next to the libm one it replaces.
+******************************************************************************/
+void FM_Benchmark(void) {
+    double sinErr = 0, cosErr = 0, atanErr = 0;
+    for (int i = -20000; i <= 20000; i++) {
+        float a = i * (2 * FM_PI / 10000);  // Two turns either side of zero
+        float s, c;
+        FM_SinCos(a, &s, &c);
+        sinErr = std::fmax(sinErr, std::fabs(s - std::sin(static_cast<double>(a))));
+        cosErr = std::fmax(cosErr, std::fabs(c - std::cos(static_cast<double>(a))));
+    }
+    for (float r = 1e-4f; r < 1e4f; r *= 10) {
+        for (int i = 0; i < 3600; i++) {
+            float x = r * std::cos(i * 0.1 * PI / 180);
+            float y = r * std::sin(i * 0.1 * PI / 180);
+            atanErr = std::fmax(atanErr, std::fabs(FM_Atan2(y, x) - std::atan2(static_cast<double>(y), x)));
+        }
+    }
+    printf("FM_Benchmark: max error sin %.1e, cos %.1e, atan2 %.1e rad\r\n", sinErr, cosErr, atanErr);
+
+    float loop = timeCalls([](float a) { return a; });
+    struct {
+        const char* name;
+        float us;
+    } rows[] = {
+        {"sin", timeCalls([](float a) { return static_cast<float>(std::sin(static_cast<double>(a))); })},
+        {"sinf", timeCalls([](float a) { return std::sin(a); })},
+        {"FM_Sin", timeCalls([](float a) { return FM_Sin(a); })},
+        {"FM_SinCos", timeCalls([](float a) { float s, c; FM_SinCos(a, &s, &c); return s + c; })},
+        {"atan2", timeCalls([](float a) { return static_cast<float>(std::atan2(static_cast<double>(a), 1.5)); })},
+        {"atan2f", timeCalls([](float a) { return std::atan2(a, 1.5f); })},
+        {"FM_Atan2", timeCalls([](float a) { return FM_Atan2(a, 1.5f); })},
+        {"fmod", timeCalls([](float a) { return static_cast<float>(std::fmod(a * 100 + 360.0, 360.0)); })},
+        {"FM_Wrap360", timeCalls([](float a) { return FM_Wrap360(a * 100); })},
+    };
+    for (const auto& row : rows) {
+        printf("FM_Benchmark: %-10s %7.3f us per call\r\n", row.name, row.us - loop);
+    }
+}
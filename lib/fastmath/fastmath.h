@@ -0,0 +1,48 @@
+/*****************************************************************************
+* | File      	:	fastmath.h
+* | Function    :	Table driven sine/cosine and a polynomial atan2 in float
+* | Info        :
+*   The Cortex-M33 has a single precision FPU but no double one, so every
+*   sin(), cos(), atan2() and fmod() on a double runs in software. These
+*   replace them on the per-fix and per-frame paths, callable from C and C++.
+*
+*   Error bounds, absolute, against libm in double:
+*     FM_Sin, FM_Cos, FM_SinCos : 1.2e-7 for |angle| up to 1000 rad, the
+*                                 float rounding of the result; the series
+*                                 itself is good to 1e-9
+*     FM_Atan2                  : 3e-7 rad (2e-5 degrees), one float step
+*                                 at pi; the polynomial is good to 2e-8
+*   FM_Benchmark() measures them, and the time per call, on the target.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+* | Info        :   Basic version
+*
+******************************************************************************/
+#ifndef __FASTMATH_H
+#define __FASTMATH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FM_SIN_TABLE_BITS	8		//Table entries per turn, as a power of two
+#define FASTMATH_BENCHMARK	0		//Print accuracy and timing once at start up
+
+#define FM_PI		3.14159265358979323846f
+#define FM_DEG2RAD	(FM_PI / 180.0f)
+#define FM_RAD2DEG	(180.0f / FM_PI)
+
+float FM_Sin(float Angle);
+float FM_Cos(float Angle);
+void FM_SinCos(float Angle, float *pSin, float *pCos);
+float FM_Atan2(float Y, float X);
+float FM_Wrap360(float Degrees);
+
+void FM_Benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -29,7 +29,7 @@ DSTATUS disk_initialize (
 		 	if(res)//STM32 SPIbug,sdʧܵʱִ,ܵSPIд쳣
 			{
 				SD_SPI_SpeedLow();
-				SD_SPI_ReadWriteByte(0xff);//ṩ8ʱ
+				SD_DisSelect();//ṩ8ʱ
 				SD_SPI_SpeedHigh();
 			}
   			break;
@@ -67,7 +67,7 @@ DRESULT disk_read (
 		 	if(res)//STM32 SPIbug,sdʧܵʱִ,ܵSPIд쳣
 			{
 				SD_SPI_SpeedLow();
-				SD_SPI_ReadWriteByte(0xff);//ṩ8ʱ
+				SD_DisSelect();//ṩ8ʱ
 				SD_SPI_SpeedHigh();
 			}
 			break;
@@ -123,10 +123,9 @@ DRESULT disk_ioctl (
 	    switch(ctrl)
 	    {
 		    case CTRL_SYNC:
-				DEV_Digital_Write(SD_CS_PIN,0);
-		        if(SD_WaitReady()==0)res = RES_OK; 
+		        if(SD_Select()==0)res = RES_OK; 
 		        else res = RES_ERROR;	  
-				DEV_Digital_Write(SD_CS_PIN,1);
+				SD_DisSelect();
 		        break;	 
 		    case GET_SECTOR_SIZE:
 		        *(WORD*)buff = 512;
@@ -57,6 +57,8 @@
 /** @defgroup STORAGE_Private_Defines
 * @{
 */
+#define BMP_CHUNK_SECTORS   16          /* Sectors per multi-block read of bitmap data */
+#define BMP_ROW_MAX         (480 * 4)   /* Longest bitmap row, a 32 bit row across the screen */
 /**
 * @}
 */
@@ -72,19 +74,18 @@
 * @{
 */
 
-#define RGB24TORGB16(R,G,B) ((R>>3)<<11)|((G>>2)<<5)|(B>>3)
+#define RGB24TORGB16(R,G,B) (((R>>3)<<11)|((G>>2)<<5)|(B>>3))
 #define PIXEL(__M)  ((((__M) + 31 ) >> 5) << 2)//对于24位真彩色 每一行的像素宽度必须是4的倍数  否则补0补齐
 
 extern LCD_DIS sLCD_DIS;
 
 uint8_t aBuffer[1440];/* 480 * 3 = 1440 */
+uint8_t aBmpChunk[BMP_CHUNK_SECTORS * _MAX_SS + BMP_ROW_MAX];/* Sectors read at once, and the rest of a row */
 FILINFO MyFileInfo;
 DIR MyDirectory;
 FIL MyFile;
 UINT BytesWritten;
 UINT BytesRead;
-uint16_t pic[76800];
-extern uint8_t id;
 /**
 * @}
 */
@@ -105,130 +106,94 @@ extern uint8_t id;
 
 
 /**
-* @brief  Open a file and copy its content to a buffer
-* @param  DirName: the Directory name to open
-* @param  FileName: the file name to open
-* @param  BufferAddress: A pointer to a buffer to copy the file to
-* @param  FileLen: the File length
-* @retval err: Error status (0=> success, 1=> fail)
+* @brief  Draw a 24 or 32 bit bitmap file on the LCD
+* @param  Xpoz: Column of the left edge of the bitmap
+* @param  Ypoz: Row of the top edge of the bitmap
+* @param  BmpName: the file name to open
+* @retval err: Error status (0=> drawn, 1=> file not readable, 2=> not a supported bitmap)
+* @note   Any size of bitmap is drawn, cut off at the edges of the screen.
+*         The pixel data is read in whole sectors, BMP_CHUNK_SECTORS at a
+*         time, which FatFs passes to the card as one multi-block read
+*         straight into aBmpChunk. Each row is converted into an LCD line
+*         buffer and blitted with one window, the DMA sends it while the
+*         next row is converted. Goes to the framebuffer when it is active.
 */
-
-uint32_t Storage_OpenReadFile(uint8_t Xpoz, uint16_t Ypoz, const char* BmpName)
+uint32_t Storage_OpenReadFile(uint16_t Xpoz, uint16_t Ypoz, const char* BmpName)
 {
-    uint16_t i, j, k, h;
-    
-    uint32_t index = 0, size = 0, width = 0, height = 0;
-    uint32_t bmpaddress, bit_pixel = 0;
-    FIL file1; 
-
-    f_open(&file1, BmpName, FA_READ);	
-    f_read(&file1, aBuffer, 30, &BytesRead);
-
-	bmpaddress = (uint32_t)aBuffer;
-
-	/* Read bitmap size */
-	size = *(uint16_t *) (bmpaddress + 2);
-	size |= (*(uint16_t *) (bmpaddress + 4)) << 16;
-//	printf("file size =  %d \r\n",size);
-	/* Get bitmap data address offset */
-	index = *(uint16_t *) (bmpaddress + 10);
-	index |= (*(uint16_t *) (bmpaddress + 12)) << 16;
-	// printf("file index =  %d \r\n",index);
-	/* Read bitmap width */
-	width = *(uint16_t *) (bmpaddress + 18);
-	width |= (*(uint16_t *) (bmpaddress + 20)) << 16;
-	// printf("file width =  %d \r\n",width);
-	/* Read bitmap height */
-	height = *(uint16_t *) (bmpaddress + 22);
-	height |= (*(uint16_t *) (bmpaddress + 24)) << 16;
-	// printf("file height =  %d \r\n",height);
-	/* Read bit/pixel */
-	bit_pixel = *(uint16_t *) (bmpaddress + 28);  
-//	printf("bit_pixel = %d \r\n",bit_pixel);
-	f_close (&file1);
-
-    if (24 != bit_pixel) {
-        return 0;
+    uint8_t header[54];
+    uint32_t index, width, height, bit_pixel, bytes_pixel, stride, columns, i, j;
+    uint32_t skip, have = 0;
+    uint8_t *pData = aBmpChunk;
+    bool top_down;
+    FIL file1;
+
+    if (f_open(&file1, BmpName, FA_READ) != FR_OK) {
+        return 1;
+    }
+    if (f_read(&file1, header, sizeof(header), &BytesRead) != FR_OK || BytesRead != sizeof(header)) {
+        f_close(&file1);
+        return 1;
     }
 
-	if (width != sLCD_DIS.LCD_Dis_Column || height != sLCD_DIS.LCD_Dis_Page) {
-		// printf("width != sLCD_DIS.LCD_Dis_Column \r\n");
-		// printf("file width =  %d \r\n",width);
-		// printf("file height =  %d \r\n",height);
-		// printf("sLCD_DIS.LCD_Dis_Column =  %d \r\n",sLCD_DIS.LCD_Dis_Column);
-		// printf("sLCD_DIS.LCD_Dis_Page =  %d \r\n",sLCD_DIS.LCD_Dis_Page);
-		return 1;
-	}
-	
-    /* Synchronize f_read right in front of the image data */
-    f_open(&file1, (TCHAR const*)BmpName, FA_READ);
-    f_read(&file1, aBuffer, index, &BytesRead);
-    
-    if(LCD_2_8 == id){
-		if(sLCD_DIS.LCD_Dis_Page > sLCD_DIS.LCD_Dis_Column)
-		{
-			for (i = 0; i < height; i ++) {
-			  f_read(&file1, aBuffer, PIXEL(width * bit_pixel) >> 1, (UINT *)&BytesRead);
-			  f_read(&file1, aBuffer + (PIXEL(width * bit_pixel) >> 1), PIXEL(width * bit_pixel) >> 1, (UINT *)&BytesRead);
-			  for (j = 0; j < width; j ++) {
-				  k = j * 3; 
-				  pic[i*width+j] = (uint16_t)(((aBuffer[k + 2] >> 3) << 11 ) | ((aBuffer[k + 1] >> 2) << 5) | (aBuffer[k] >> 3));
-			  }
-			}
-		}
-		else
-		{
-			for (i = 0; i < height ; i ++) {
-			  f_read(&file1, aBuffer, PIXEL(width * bit_pixel) >> 1, (UINT *)&BytesRead);
-			  f_read(&file1, aBuffer + (PIXEL(width * bit_pixel) >> 1), PIXEL(width * bit_pixel) >> 1, (UINT *)&BytesRead);
-			  for (j = 0; j < width; j ++) {
-				  k = j * 3; 
-				  pic[i*width+j] = (uint16_t)(((aBuffer[k + 2] >> 3) << 11 ) | ((aBuffer[k + 1] >> 2) << 5) | (aBuffer[k] >> 3));
-			  }
-			}	
-		}	
-		/* LCD_SetCursor if dont write here ,it will display innormal*/
-		LCD_SetCursor(0, 0);
-		DEV_Digital_Write(LCD_DC_PIN, 1);
-		DEV_Digital_Write(LCD_CS_PIN, 0);
-		spi_set_baudrate(SPI_PORT,30*1000*1000);
-		for(index=0;index<76800;index++){
-			  SPI4W_Write_Byte((pic[index] >> 8) & 0xFF);
-			  SPI4W_Write_Byte(pic[index] & 0xFF);
-		}
-		DEV_Digital_Write(LCD_CS_PIN, 1);
-    }else{
-		LCD_SetCursor(0, 0);
-		spi_set_baudrate(SPI_PORT,30*1000*1000);
-		if(sLCD_DIS.LCD_Dis_Page > sLCD_DIS.LCD_Dis_Column)
-		{
-			for(i = 0; i < height; i ++){
-				f_read(&file1, aBuffer, PIXEL(width * bit_pixel) >> 1, (UINT *)&BytesRead);
-				f_read(&file1, aBuffer+(PIXEL(width * bit_pixel) >> 1), PIXEL(width * bit_pixel) >> 1, (UINT *)&BytesRead);
-				for (j = 0; j < width; j ++) {
-					k = j * 3;
-					pic[j] = (uint16_t)(((aBuffer[k+2]>>3)<<11)|((aBuffer[k+1]>>2)<<5)|(aBuffer[k]>>3));
-					LCD_WriteData(pic[j]);
-				}
-			}
-		}
-		else
-		{
-			for(i = 0; i < height; i ++){
-				f_read(&file1, aBuffer, PIXEL(width * bit_pixel) >> 1, (UINT *)&BytesRead);
-				f_read(&file1, aBuffer+(PIXEL(width * bit_pixel) >> 1), PIXEL(width * bit_pixel) >> 1, (UINT *)&BytesRead);
-				for (j = 0; j < width; j ++) {
-					k = j * 3;
-					pic[j] = (uint16_t)(((aBuffer[k+2]>>3)<<11)|((aBuffer[k+1]>>2)<<5)|(aBuffer[k]>>3));
-					LCD_WriteData(pic[j]);
-				}
-			}
-		}
+    /* Bitmap data offset, size and bits per pixel; a negative height is a top-down bitmap.
+       32 bit pixels are taken as BGRA, the alpha byte is ignored */
+    index = LD_DWORD(&header[10]);
+    width = LD_DWORD(&header[18]);
+    height = LD_DWORD(&header[22]);
+    bit_pixel = LD_WORD(&header[28]);
+    top_down = (int32_t)height < 0;
+    if (top_down) {
+        height = -(int32_t)height;
     }
+    bytes_pixel = bit_pixel / 8;
+    stride = PIXEL(width * bit_pixel);
+
+    if (header[0] != 'B' || header[1] != 'M' || (bit_pixel != 24 && bit_pixel != 32) ||
+        (LD_DWORD(&header[30]) != 0 && !(bit_pixel == 32 && LD_DWORD(&header[30]) == 3)) ||
+        width == 0 || width > BMP_ROW_MAX || stride > BMP_ROW_MAX) {
+        f_close(&file1);
+        return 2;
+    }
+
+    columns = 0;
+    if (Xpoz < sLCD_DIS.LCD_Dis_Column) {
+        columns = MIN(width, (uint32_t)(sLCD_DIS.LCD_Dis_Column - Xpoz));
+    }
+
+    /* Start at the sector the pixels begin in, every read after that is whole sectors */
+    skip = index % _MAX_SS;
+    f_lseek(&file1, index - skip);
+
+    for (i = 0; i < height; i++) {
+        if (have < stride) {
+            /* The part of a row left from the last chunk moves to the front */
+            memmove(aBmpChunk, pData, have);
+            if (f_read(&file1, aBmpChunk + have, BMP_CHUNK_SECTORS * _MAX_SS, &BytesRead) != FR_OK ||
+                have + BytesRead < skip + stride) {
+                break;
+            }
+            pData = aBmpChunk + skip;
+            have += BytesRead - skip;
+            skip = 0;
+        }
+
+        uint32_t y = Ypoz + (top_down ? i : height - 1 - i);
+        if (columns && y < sLCD_DIS.LCD_Dis_Page) {
+            COLOR *pLine = LCD_GetLineBuf();
+            const uint8_t *pPixel = pData;
+            for (j = 0; j < columns; j++) {
+                pLine[j] = RGB24TORGB16(pPixel[2], pPixel[1], pPixel[0]);
+                pPixel += bytes_pixel;
+            }
+            LCD_SetWindow(Xpoz, y, Xpoz + columns, y + 1);
+            LCD_WritePixels(pLine, columns);
+        }
+        pData += stride;
+        have -= stride;
+    }
+
     f_close(&file1);
-    spi_set_baudrate(SPI_PORT,3000*1000);
-	Driver_Delay_ms(1500);
-    return 1;
+    return 0;
 }
 
 
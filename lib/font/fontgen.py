@@ -93,12 +93,109 @@ def render_char_data(
 
     return bitmap, width, height
 
+def bitmap_to_spans(
+    bitmap: list,
+    width: int,
+    height: int
+    ):
+    """
+    Convert a 1bpp glyph bitmap into horizontal spans.
+
+    Each row becomes a list of (start, end) pairs, end exclusive, covering
+    the runs of set pixels in that row. The renderer fills these runs
+    directly instead of testing every bit.
+
+    Args:
+        bitmap (list): Row-padded 1bpp bytes as returned by render_char_data.
+        width (int): The width of the character in pixels.
+        height (int): The height of the character in pixels.
+
+    Returns:
+        list: One list of (start, end) tuples per row.
+    """
+    bytes_per_row = (width + 7) // 8
+    rows = []
+
+    for y in range(height):
+        row = bitmap[y * bytes_per_row:(y + 1) * bytes_per_row]
+        spans = []
+        start = None
+        for x in range(width + 1):
+            on = x < width and row[x // 8] & (0x80 >> (x % 8))
+            if on and start is None:
+                start = x
+            elif not on and start is not None:
+                spans.append((start, x))
+                start = None
+        rows.append(spans)
+
+    return rows
+
+
+def write_span_tables(
+    c_file,
+    font_size: int,
+    characters: str,
+    font: ImageFont,
+    width: int
+    ):
+    """
+    Write the span encoded glyph tables of a font.
+
+    For every glyph each row is stored as a span count followed by
+    start/end byte pairs. Glyphs are located through an offset table and
+    the string of characters the font contains.
+
+    Returns:
+        int: Number of bytes in the span data.
+    """
+    data_size = 0
+    offsets = []
+
+    c_file.write(f"static const uint8_t Font{font_size}_Span_Data[] = {{\n")
+    for c in characters:
+        char_data, width, height = render_char_data(c, font, width)
+        offsets.append(data_size)
+        c_file.write(f"  /* '{c}' */\n")
+        for spans in bitmap_to_spans(char_data, width, height):
+            row = [len(spans)] + [v for span in spans for v in span]
+            c_file.write("  " + ", ".join(str(v) for v in row) + ",\n")
+            data_size += len(row)
+    c_file.write("};\n\n")
+
+    if data_size > 0xFFFF:
+        raise ValueError(f"Span data of Font{font_size} does not fit 16-bit offsets")
+
+    c_file.write(f"static const uint16_t Font{font_size}_Span_Offset[] = {{\n")
+    for i in range(0, len(offsets), 12):
+        c_file.write("  " + ", ".join(str(o) for o in offsets[i:i+12]) + ",\n")
+    c_file.write("};\n\n")
+
+    chars = characters.replace("\\", "\\\\").replace('"', '\\"')
+    c_file.write(f"static const sFONT_SPANS Font{font_size}_Spans = {{\n")
+    c_file.write(f"  \"{chars}\", /* Characters */\n")
+    c_file.write(f"  Font{font_size}_Span_Offset,\n")
+    c_file.write(f"  Font{font_size}_Span_Data,\n")
+    c_file.write("};\n\n")
+
+    return data_size
+
+
 def generate_font_c(
     font_size: int,
     characters: str,
     font_path: str,
-    output_path: str
+    output_path: str,
+    spans: bool = False
     ):
+    """
+    Generate the C table of a font.
+
+    With spans the glyphs of the characters are written as span tables
+    (see write_span_tables) and the bitmap table is left out. The cell
+    size is always taken from the full character set, so a subset font
+    lays text out exactly like the full one.
+    """
     if not Path(font_path).exists():
         raise FileNotFoundError(f"Font file not found: {font_path}")
 
@@ -109,12 +206,31 @@ def generate_font_c(
     font = ImageFont.truetype(font_path, font_size)
     
     # Compute max character width & height
-    width, height = compute_font_bounds(font, characters)
+    width, height = compute_font_bounds(font, "".join(DEFAULT_CHARS) if spans else characters)
 
     # Sort out the output path
     output_prefix = f"font{font_size}"
     c_filename = Path(output_path) / f"{output_prefix}.c"
 
+    if spans:
+        with open(c_filename, "w") as c_file:
+            c_file.write('#include "fonts.h"\n')
+            c_file.write('#include <stddef.h>\n\n')
+            data_size = write_span_tables(c_file, font_size, characters, font, width)
+
+            c_file.write(f"sFONT Font{font_size} = {{\n")
+            c_file.write("  NULL, /* No bitmap table */\n")
+            c_file.write(f"  {width}, /* Width */\n")
+            c_file.write(f"  {height}, /* Height */\n")
+            c_file.write(f"  &Font{font_size}_Spans,\n")
+            c_file.write("};\n")
+
+        bitmap_size = len(DEFAULT_CHARS) * height * ((width + 7) // 8)
+        span_size = data_size + 2 * len(characters) + len(characters) + 1
+        print(f"Generated {c_filename}: {span_size} bytes of spans for {len(characters)} characters "
+              f"(full bitmap table: {bitmap_size} bytes)")
+        return
+
     # Generate and write the C file
     with open(c_filename, "w") as c_file:
         c_file.write('#include "fonts.h"\n\n')
@@ -237,6 +353,12 @@ DEFAULT_CHARS = [
     "~", # 94
 ]
 
+# Characters the large readouts need: digits, sign, decimal point, a few units
+SPAN_SUBSET = " +-.:%0123456789ACGKMNOSTkt"
+
+# Sizes only used for the big readouts are generated as span subsets
+SPAN_SIZES = [96, 120, 144]
+
 if __name__ == "__main__":
     
     default_chars = "".join(DEFAULT_CHARS)
@@ -263,6 +385,18 @@ if __name__ == "__main__":
         type=str,
         help="Characters to include in the font"
     )
+    parser.add_argument(
+        "--spans",
+        action="store_true",
+        help="Emit span encoded glyphs instead of a 1bpp bitmap table"
+    )
+    parser.add_argument(
+        "--subset",
+        metavar="subset",
+        default=None,
+        type=str,
+        help="Only include these characters (span fonts default to SPAN_SUBSET)"
+    )
     parser.add_argument(
         "-o", "--output_path",
         metavar="output_path",
@@ -272,9 +406,14 @@ if __name__ == "__main__":
 
     args = parser.parse_args()
 
-    # generate_font_c(args.font_size, args.characters, args.font_path, args.output_path)
-    
-    # Generate font data for all sizes
-    sizes = [36, 48, 72, 96, 120, 144]
-    for size in sizes:
-        generate_font_c(size, args.characters, args.font_path, args.output_path)
+    if args.font_size:
+        spans = args.spans
+        characters = args.subset or (SPAN_SUBSET if spans else args.characters)
+        generate_font_c(args.font_size, characters, args.font_path, args.output_path, spans)
+    else:
+        # Generate font data for all sizes
+        sizes = [36, 48, 72, 96, 120, 144]
+        for size in sizes:
+            spans = args.spans or size in SPAN_SIZES
+            characters = args.subset or (SPAN_SUBSET if spans else args.characters)
+            generate_font_c(size, characters, args.font_path, args.output_path, spans)
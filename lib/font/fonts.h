@@ -54,11 +54,23 @@
 /* Includes ------------------------------------------------------------------*/
 #include <stdint.h>
 
+/* Span encoded glyphs, see fontgen.py --spans.
+   For every row of a glyph Data holds a span count followed by that many
+   start/end pairs (end exclusive). Offset[i] is where the rows of Chars[i]
+   begin. Characters that are not in Chars are drawn blank. */
+typedef struct _tFontSpans
+{
+  const char *Chars;
+  const uint16_t *Offset;
+  const uint8_t *Data;
+} sFONT_SPANS;
+
 typedef struct _tFont
 {    
   const uint8_t *table;
   uint16_t Width;
   uint16_t Height;
+  const sFONT_SPANS *Spans;  /* Set instead of table for span fonts */
   
 } sFONT;
 
@@ -1,25 +1,68 @@
 #include <stdio.h>
 #include <string.h>
-#include <time.h>
+#include <math.h>
+#include "pico/time.h"
 #include "gps_logger.h"
-#include "gps_datetime.h"  // Correct path to gps_datetime.h
 
 // Include SD card functions with C linkage
 extern "C" {
     #include "MMC_SD.h"  // For SD card initialization
 }
 
-// Forward declare the SPI function we need
-extern "C" unsigned char SPI4W_Write_Byte(unsigned char value);
+extern "C" {
+    #include "DEV_Bus.h"
+}
 
-// Function to send dummy bytes to stabilize SD card
+// Function to send dummy bytes to stabilize SD card, chip select high
 void send_dummy_bytes(int count) {
+    DEV_Bus_Acquire(DEV_BUS_SD);
     for (int i = 0; i < count; i++) {
         SPI4W_Write_Byte(0xFF);
     }
+    DEV_Bus_Release(DEV_BUS_SD);
+}
+
+// Fixed point for the record, see SclogRecord. Positions in double, the
+// float product would be rounded to 4 units
+static int32_t toE6(float degrees) {
+    return static_cast<int32_t>(lrint(degrees * 1e6));
+}
+
+static uint16_t toCenti(float value) {
+    if (value <= 0.0f) {
+        return 0;
+    }
+    return value >= 655.35f ? 65535 : static_cast<uint16_t>(value * 100.0f + 0.5f);
+}
+
+static constexpr int32_t COURSE_TURN = 36000;
+
+static uint16_t toCourse(float degrees) {
+    int32_t centi = static_cast<int32_t>(lrintf(degrees * 100.0f)) % COURSE_TURN;
+    return static_cast<uint16_t>(centi < 0 ? centi + COURSE_TURN : centi);
+}
+
+// Prediction of each value logData codes, in header order after the time
+static const uint8_t kPredict[GPSLogger::VALUES] = {
+    SCLOG_PREDICT_LINEAR, SCLOG_PREDICT_LINEAR, SCLOG_PREDICT_DELTA, SCLOG_PREDICT_ANGLE,
+    SCLOG_PREDICT_LINEAR, SCLOG_PREDICT_LINEAR, SCLOG_PREDICT_DELTA, SCLOG_PREDICT_ANGLE,
+};
+
+// Every residual in 3-bit nibbles, 32 bits take 11
+static constexpr int MAX_RECORD_NIBBLES = (1 + GPSLogger::VALUES) * 11;
+
+static void setField(SclogField& field, const char* name, const char* unit, uint8_t type,
+                     size_t offset, float scale, uint8_t predict) {
+    memset(&field, 0, sizeof(field));
+    strncpy(field.name, name, sizeof(field.name));
+    strncpy(field.unit, unit, sizeof(field.unit));
+    field.type = type;
+    field.offset = static_cast<uint8_t>(offset);
+    field.predict = predict;
+    field.scale = scale;
 }
 
-bool GPSLogger::init(const char* filename) {
+bool GPSLogger::init(const char* filename, uint32_t start_time) {
     FRESULT res;
     static FATFS fs;
     
@@ -50,7 +93,7 @@ bool GPSLogger::init(const char* filename) {
         // Try initialization
         sd_init_result = SD_Initialize();
         if (sd_init_result == 0) {
-            printf("SD card initialized successfully\n");
+            printf("SD card initialized successfully, clock %u kHz\n", (unsigned)(sSD_Stats.Clock_Hz / 1000));
             sd_initialized = true;
             break;
         }
@@ -143,8 +186,16 @@ bool GPSLogger::init(const char* filename) {
     
     printf("Creating log file: %s\n", fatfs_path);
     
-    // Try to open the file for writing (create if it doesn't exist)
-    res = f_open(&file, fatfs_path, FA_WRITE | FA_CREATE_ALWAYS);
+    // Create the file; a log of the same name is kept, after a power cut it
+    // is the one to recover, and the next free letter goes before the extension
+    res = m_writer.create(fatfs_path);
+    const char* extension = strrchr(base_filename, '.');
+    int stem = extension ? static_cast<int>(extension - base_filename) : static_cast<int>(strlen(base_filename));
+    for (char suffix = 'a'; res == FR_EXIST && suffix <= 'z'; suffix++) {
+        snprintf(fatfs_path, sizeof(fatfs_path), "0:%.*s%c%s", stem, base_filename, suffix,
+                 extension ? extension : "");
+        res = m_writer.create(fatfs_path);
+    }
     if (res != FR_OK) {
         printf("Error: Failed to open log file %s (error code: %d)\n", fatfs_path, res);
         
@@ -214,21 +265,37 @@ bool GPSLogger::init(const char* filename) {
         return false;
     }
     
-    // Write CSV header
-    const char* header = "timestamp,date_time,"
-                         "raw_lat,raw_lon,raw_speed,raw_course,"
-                         "filtered_lat,filtered_lon,filtered_speed,filtered_course\n";
-    
-    UINT bytesWritten;
-    res = f_write(&file, header, strlen(header), &bytesWritten);
-    if (res != FR_OK || bytesWritten != strlen(header)) {
-        printf("Error: Failed to write header to log file (error code: %d)\n", res);
-        f_close(&file);
+    // Header sector: what a fix record holds, so the converter needs no copy of
+    // SclogRecord
+    alignas(4) uint8_t sector[SCLOG_SECTOR] = {};
+    SclogHeader* header = reinterpret_cast<SclogHeader*>(sector);
+    header->version = SCLOG_VERSION;
+    header->record_size = sizeof(SclogRecord);
+    header->records_per_sector = 0;
+    header->start_time = start_time;
+    SclogField* field = header->fields;
+    setField(*field++, "timestamp", "s", SCLOG_TYPE_U32, offsetof(SclogRecord, timestamp), 1.0f, SCLOG_PREDICT_NONE);
+    setField(*field++, "ms", "ms", SCLOG_TYPE_U16, offsetof(SclogRecord, ms), 1.0f, SCLOG_PREDICT_NONE);
+    setField(*field++, "raw_lat", "deg", SCLOG_TYPE_I32, offsetof(SclogRecord, raw_lat), 1e-6f, kPredict[0]);
+    setField(*field++, "raw_lon", "deg", SCLOG_TYPE_I32, offsetof(SclogRecord, raw_lon), 1e-6f, kPredict[1]);
+    setField(*field++, "raw_speed", "kt", SCLOG_TYPE_U16, offsetof(SclogRecord, raw_speed), 0.01f, kPredict[2]);
+    setField(*field++, "raw_course", "deg", SCLOG_TYPE_U16, offsetof(SclogRecord, raw_course), 0.01f, kPredict[3]);
+    setField(*field++, "filtered_lat", "deg", SCLOG_TYPE_I32, offsetof(SclogRecord, filtered_lat), 1e-6f, kPredict[4]);
+    setField(*field++, "filtered_lon", "deg", SCLOG_TYPE_I32, offsetof(SclogRecord, filtered_lon), 1e-6f, kPredict[5]);
+    setField(*field++, "filtered_speed", "kt", SCLOG_TYPE_U16, offsetof(SclogRecord, filtered_speed), 0.01f, kPredict[6]);
+    setField(*field++, "filtered_course", "deg", SCLOG_TYPE_U16, offsetof(SclogRecord, filtered_course), 0.01f, kPredict[7]);
+    header->field_count = static_cast<uint16_t>(field - header->fields);
+
+    if (!m_writer.start(sector, start_time)) {
         return false;
     }
-    
-    // Flush the file to ensure header is written
-    f_sync(&file);
+
+    m_startTime = start_time;
+    m_clockMs = -static_cast<int64_t>(to_ms_since_boot(get_absolute_time()));
+    m_count = 0;
+    m_nibbles = 0;
+    m_lastTimestamp = start_time;
+    m_stats = {};
     
     // Set initialization flag
     initialized = true;
@@ -242,46 +309,158 @@ bool GPSLogger::logData(const GPSFix& raw_data, const GPSFix& filtered_data) {
         printf("Error: GPS logger not initialized\n");
         return false;
     }
-    
-    // Format date and time from timestamp
-    char date_str[20];
-    char time_str[20];
-    char datetime_str[40];
-    
-    // Convert epoch timestamp to date and time strings
-    date_from_epoch(raw_data.timestamp, date_str, sizeof(date_str));
-    time_from_epoch(raw_data.timestamp, time_str, sizeof(time_str));
-    
-    // Combine date and time strings
-    snprintf(datetime_str, sizeof(datetime_str), "%s %s", date_str, time_str);
-    
-    // Format CSV line with both raw and filtered data
-    snprintf(csv_buffer, sizeof(csv_buffer), 
-             "%u,%s,"
-             "%.6f,%.6f,%.2f,%.2f,"
-             "%.6f,%.6f,%.2f,%.2f\n",
-             raw_data.timestamp, datetime_str,
-             raw_data.lat, raw_data.lon, raw_data.speed, raw_data.course,
-             filtered_data.lat, filtered_data.lon, filtered_data.speed, filtered_data.course);
-    
-    // Write CSV line to file
-    UINT bytesWritten;
-    FRESULT res = f_write(&file, csv_buffer, strlen(csv_buffer), &bytesWritten);
-    if (res != FR_OK || bytesWritten != strlen(csv_buffer)) {
-        printf("Error: Failed to write data to log file (error code: %d)\n", res);
-        return false;
+
+    int32_t values[VALUES] = {
+        toE6(raw_data.lat), toE6(raw_data.lon), toCenti(raw_data.speed), toCourse(raw_data.course),
+        toE6(filtered_data.lat), toE6(filtered_data.lon), toCenti(filtered_data.speed), toCourse(filtered_data.course),
+    };
+    int64_t time = static_cast<int64_t>(raw_data.timestamp) * 1000 + raw_data.ms;
+
+    // Ties the boot clock to the GPS one, for the records of other streams
+    int64_t session_ms = time - static_cast<int64_t>(m_startTime) * 1000;
+    m_clockMs = session_ms - to_ms_since_boot(get_absolute_time());
+    uint32_t time_ms = session_ms < 0 ? 0 : static_cast<uint32_t>(session_ms);
+
+    uint8_t code[MAX_RECORD_NIBBLES];
+    uint8_t* chunk = m_writer.chunk(SCLOG_STREAM_FIXES);
+    int nibbles = chunk ? encodeRecord(time, values, code) : -1;
+    if (nibbles < 0 || m_nibbles + nibbles > static_cast<int>(SCLOG_CODE_NIBBLES)) {
+        // The record starts the next chunk, the filling one joins the queue
+        chunk = m_writer.nextChunk(SCLOG_STREAM_FIXES, time_ms);
+        if (!chunk) {
+            return false;
+        }
+
+        SclogRecord keyframe;
+        keyframe.timestamp = raw_data.timestamp;
+        keyframe.ms = raw_data.ms;
+        keyframe.reserved = 0;
+        keyframe.raw_lat = values[0];
+        keyframe.raw_lon = values[1];
+        keyframe.raw_speed = static_cast<uint16_t>(values[2]);
+        keyframe.raw_course = static_cast<uint16_t>(values[3]);
+        keyframe.filtered_lat = values[4];
+        keyframe.filtered_lon = values[5];
+        keyframe.filtered_speed = static_cast<uint16_t>(values[6]);
+        keyframe.filtered_course = static_cast<uint16_t>(values[7]);
+
+        memcpy(chunk + sizeof(SclogDataHead), &keyframe, sizeof(keyframe));
+        m_count = 0;
+        m_nibbles = 0;
+        m_stats.nibbles += 2 * sizeof(SclogRecord);
+    } else {
+        uint8_t* code_start = chunk + SCLOG_CODE_OFFSET;
+        for (int i = 0; i < nibbles; i++, m_nibbles++) {
+            code_start[m_nibbles >> 1] |= (m_nibbles & 1) ? code[i] << 4 : code[i];
+        }
+        m_stats.nibbles += nibbles;
     }
-    
-    // Flush the file every write to ensure data is saved even if power is lost
-    f_sync(&file);
-    
+
+    m_count++;
+    m_writer.added(SCLOG_STREAM_FIXES, time_ms, static_cast<uint16_t>(sizeof(SclogRecord) + (m_nibbles + 1) / 2));
+    m_time[1] = m_time[0];
+    m_time[0] = time;
+    memcpy(m_values[1], m_values[0], sizeof(m_values[0]));
+    memcpy(m_values[0], values, sizeof(m_values[0]));
+    m_lastTimestamp = raw_data.timestamp;
+    m_stats.records++;
     return true;
 }
 
+// Boot time on the session clock, as of the last fix
+uint32_t GPSLogger::sessionMs(uint32_t boot_ms) const {
+    int64_t ms = boot_ms + m_clockMs;
+    return ms < 0 ? 0 : static_cast<uint32_t>(ms);
+}
+
+bool GPSLogger::logText(uint8_t stream, uint8_t type, const char* text, size_t length, uint32_t time_ms) {
+    uint8_t record[sizeof(SclogText) + UINT8_MAX];
+    SclogText head;
+    head.time_ms = time_ms;
+    head.type = type;
+    head.length = static_cast<uint8_t>(length > UINT8_MAX ? UINT8_MAX : length);
+    memcpy(record, &head, sizeof(head));
+    memcpy(record + sizeof(head), text, head.length);
+    return m_writer.append(stream, time_ms, record, static_cast<uint16_t>(sizeof(head) + head.length));
+}
+
+bool GPSLogger::logNmea(const char* sentence, uint32_t boot_ms) {
+    if (!initialized) {
+        return false;
+    }
+    m_stats.sentences++;
+    return logText(SCLOG_STREAM_NMEA, 0, sentence, strcspn(sentence, "\r\n"), sessionMs(boot_ms));
+}
+
+bool GPSLogger::logEvent(uint8_t type, const char* text) {
+    if (!initialized) {
+        return false;
+    }
+    m_stats.events++;
+    return logText(SCLOG_STREAM_EVENTS, type, text, strlen(text),
+                   sessionMs(to_ms_since_boot(get_absolute_time())));
+}
+
+bool GPSLogger::logBattery(float percent, float current_mA) {
+    if (!initialized) {
+        return false;
+    }
+    SclogBattery reading;
+    reading.time_ms = sessionMs(to_ms_since_boot(get_absolute_time()));
+    reading.percent = static_cast<int16_t>(lrintf(percent * 10.0f));
+    reading.current = static_cast<int16_t>(lrintf(current_mA));
+    m_stats.readings++;
+    return m_writer.append(SCLOG_STREAM_BATTERY, reading.time_ms, &reading, sizeof(reading));
+}
+
+// A record's residuals against the filling sector's, see log_format.h, as
+// nibbles one to a byte. -1 when a residual needs more than 32 bits, after a
+// jump in time, and the record a keyframe.
+int GPSLogger::encodeRecord(int64_t time, const int32_t* values, uint8_t* code) const {
+    bool linear = m_count >= 2;
+    int64_t residuals[1 + VALUES];
+    residuals[0] = time - (linear ? 2 * m_time[0] - m_time[1] : m_time[0]);
+    for (int i = 0; i < VALUES; i++) {
+        int64_t last = m_values[0][i];
+        int64_t residual;
+        if (kPredict[i] == SCLOG_PREDICT_LINEAR) {
+            residual = values[i] - (linear ? 2 * last - m_values[1][i] : last);
+        } else {
+            residual = values[i] - last;
+            if (kPredict[i] == SCLOG_PREDICT_ANGLE) {
+                if (residual >= COURSE_TURN / 2) {
+                    residual -= COURSE_TURN;
+                } else if (residual < -COURSE_TURN / 2) {
+                    residual += COURSE_TURN;
+                }
+            }
+        }
+        residuals[i + 1] = residual;
+    }
+
+    int nibbles = 0;
+    for (int64_t residual : residuals) {
+        if (residual < INT32_MIN || residual > INT32_MAX) {
+            return -1;
+        }
+        uint32_t value = sclog_zigzag(static_cast<int32_t>(residual));
+        while (value > 7) {
+            code[nibbles++] = static_cast<uint8_t>((value & 7) | 8);
+            value >>= 3;
+        }
+        code[nibbles++] = static_cast<uint8_t>(value);
+    }
+    return nibbles;
+}
+
 void GPSLogger::close() {
     if (initialized) {
-        f_close(&file);
+        alignas(4) uint8_t sector[SCLOG_SECTOR] = {};
+        SclogTrailer* trailer = reinterpret_cast<SclogTrailer*>(sector);
+        trailer->records = m_stats.records;
+        trailer->end_time = m_lastTimestamp;
+        m_writer.close(sector);
         initialized = false;
         printf("GPS logger closed\n");
     }
-}
\ No newline at end of file
+}
@@ -2,34 +2,111 @@
 
 #include "gps_data.h"
 #include "ff.h"  // Correct path to ff.h
+#include "log_writer.h"
 
 /**
- * @brief GPS Logger class for logging GPS data to CSV files
+ * @brief GPS Logger class for logging GPS data to binary session logs
+ *
+ * A session log holds streams side by side, each in chunks of its own:
+ * every fix, coded against the ones before it; the NMEA sentences they came
+ * from; battery readings; and events such as tacks and mark changes, see
+ * log_format.h. The log* calls only add a record to the stream's chunk in
+ * RAM. The streams share one LogWriter, which service(), from the main loop,
+ * lets write the full chunks to the card one sector per call. Records are
+ * timed on the GPS clock, the boot clock is tied to it at every fix.
  */
 class GPSLogger {
 public:
     /**
      * @brief Initialize the GPS logger with SD card and file system
      * 
-     * @param filename Name of the CSV file to create (required)
+     * @param filename Name of the log file to create (required). When it
+     *                 exists a letter goes before the extension, the old
+     *                 log is kept
+     * @param start_time UTC seconds since the epoch, identifies the session
      * @return true if initialization was successful, false otherwise
      */
-    bool init(const char* filename);
+    bool init(const char* filename, uint32_t start_time);
 
     /**
-     * @brief Log GPS data to the CSV file
+     * @brief Queue GPS data for the log file
      * 
      * @param raw_data Raw GPS data
      * @param filtered_data Filtered GPS data
-     * @return true if logging was successful, false otherwise
+     * @return true if the record was queued, false when the logger is not
+     *         initialized or the queue is full because the card fell behind
      */
     bool logData(const GPSFix& raw_data, const GPSFix& filtered_data);
 
     /**
-     * @brief Close the GPS logger
+     * @brief Queue an NMEA sentence as the receiver sent it
+     *
+     * @param sentence From '$', the line end is left out
+     * @param boot_ms When it came in, ms since boot
+     */
+    bool logNmea(const char* sentence, uint32_t boot_ms);
+
+    /**
+     * @brief Queue a battery reading, as the INA219 gave it
+     *
+     * @param percent Below 0 while charging
+     * @param current_mA Below 0 while discharging
+     */
+    bool logBattery(float percent, float current_mA);
+
+    /**
+     * @brief Queue an event, timed now
+     *
+     * @param type SCLOG_EVENT_*
+     * @param text What happened, up to 255 characters
+     */
+    bool logEvent(uint8_t type, const char* text);
+
+    /**
+     * @brief Write the oldest queued chunk, or a filling one when a sync
+     *        is due; at most one sector per call. Call from the main loop
+     */
+    void service() { m_writer.service(); }
+
+    /**
+     * @brief Put the filling chunks on the card at the next service calls
+     */
+    void requestSync() { m_writer.requestSync(); }
+
+    /**
+     * @brief While the battery is low every record is synced, it may give
+     *        out at any time
+     */
+    void setLowBattery(bool low) { m_writer.setLowBattery(low); }
+
+    /**
+     * @brief Most seconds of records a power cut may lose
+     */
+    void setSyncSeconds(uint32_t seconds) { m_writer.setSyncSeconds(seconds); }
+
+    /**
+     * @brief Write what is queued and the trailer, give the unused
+     *        preallocation back, and close the GPS logger
      */
     void close();
 
+    /**
+     * @brief Records per stream, for the status report; the writer has the
+     *        cost of getting them to the card
+     */
+    struct Stats {
+        uint32_t records;       // Fixes
+        uint32_t nibbles;       // Coded fixes, keyframes too
+        uint32_t sentences;     // NMEA
+        uint32_t readings;      // Battery
+        uint32_t events;
+    };
+    const Stats& getStats() const { return m_stats; }
+    const LogWriter::Stats& getWriterStats() const { return m_writer.getStats(); }
+    void resetMaxUs() { m_writer.resetMaxUs(); }
+
+    static constexpr int VALUES = 8;                    // Coded after the time, see logData
+
     /**
      * @brief Check if the logger is initialized
      * 
@@ -38,7 +115,21 @@ public:
     bool isInitialized() const { return initialized; }
 
 private:
-    FIL file;              // File object
+    LogWriter m_writer;    // The file, the queue and the card
     bool initialized;      // Flag to indicate if the logger is initialized
-    char csv_buffer[256];  // Buffer for CSV data
-};
\ No newline at end of file
+    uint32_t m_startTime = 0;
+    int64_t m_clockMs = 0;          // Session ms less boot ms, from the last fix
+    uint16_t m_count = 0;           // Fixes in the filling chunk
+    uint16_t m_nibbles = 0;         // Coded after its keyframe
+    uint32_t m_lastTimestamp = 0;
+
+    // The filling chunk's last fix and the one before, what the next one is
+    // predicted from; times in ms since the epoch
+    int64_t m_time[2] = {};
+    int32_t m_values[2][VALUES] = {};
+    Stats m_stats = {};
+
+    uint32_t sessionMs(uint32_t boot_ms) const;
+    bool logText(uint8_t stream, uint8_t type, const char* text, size_t length, uint32_t time_ms);
+    int encodeRecord(int64_t time, const int32_t* values, uint8_t* code) const;
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Binary session log, .scl. The file is a run of 512-byte sectors, each one
+// written whole and checked on its own, so a power cut costs at most the
+// sector that was being written:
+//
+//   header   sequence 0: session, fix record layout, field names, units, scales
+//   index    sequence 1 and every SCLOG_INDEX_SPAN after: the stream and the
+//            start time of each of the SCLOG_INDEX_ENTRIES sectors after it
+//   data     the others: a chunk of one stream's records, SclogDataHead says
+//            which stream, how many records, how many bytes and what time
+//   trailer  after the last sector, only when the log was closed
+//
+// Every sector starts with SclogSectorHead and ends with the CRC-32 (the
+// zlib one) of the bytes before it. All values are little-endian. Streams
+// take turns in the file as their chunks fill, each has one chunk filling at
+// a time and it is rewritten in place as records arrive. The index lists a
+// chunk when it is started, a reader after one stream reads the indexes and
+// then that stream's chunks, in sequence order, and nothing else; where an
+// index is missing, the heads of the chunks tell the same. Times in the
+// chunks are milliseconds since the header's start_time.
+// The file is preallocated: past the last sector of the session it holds
+// whatever the card had there, sectors of older sessions among it.
+// tools/log_convert turns a log into CSV, GPX and NMEA.
+//
+// Every fix is logged, so a fixes chunk codes its records against each
+// other and decodes on its own. After SclogDataHead comes the first record
+// whole, an SclogRecord, then the others as 4-bit nibbles, low nibble of a
+// byte first:
+//  - a record is the residual of its time, milliseconds since the epoch,
+//    then one residual per field that has a prediction, in header order
+//  - a residual is the value less its prediction from the records before it
+//    in the chunk, see SCLOG_PREDICT_*; the time is predicted LINEAR
+//  - residuals are zigzag coded, sclog_zigzag, and written 3 bits a nibble,
+//    low bits first, with the top bit set in every nibble but the last
+// A fix under way takes about 8 bytes, a chunk holds some 55 of them.
+// The other streams are records one after the other: NMEA sentences and
+// events an SclogText each, battery readings an SclogBattery.
+
+#define SCLOG_SECTOR            512
+#define SCLOG_VERSION           3
+#define SCLOG_MAGIC_HEADER      0x48474C53u     // "SLGH"
+#define SCLOG_MAGIC_INDEX       0x49474C53u     // "SLGI"
+#define SCLOG_MAGIC_DATA        0x44474C53u     // "SLGD"
+#define SCLOG_MAGIC_TRAILER     0x54474C53u     // "SLGT"
+
+// Streams, what a data chunk holds
+#define SCLOG_STREAM_FIXES      0   // Coded SclogRecords
+#define SCLOG_STREAM_NMEA       1   // SclogText, the sentences as the receiver sent them
+#define SCLOG_STREAM_BATTERY    2   // SclogBattery
+#define SCLOG_STREAM_EVENTS     3   // SclogText, type SCLOG_EVENT_*
+#define SCLOG_STREAMS           4
+
+// Event types
+#define SCLOG_EVENT_TACK        1   // Text: the heading after it
+#define SCLOG_EVENT_MARK        2   // Text: the new target mark
+#define SCLOG_EVENT_BUTTON      3   // Text: "short" or "long"
+
+// Field types in the header
+#define SCLOG_TYPE_U16          1
+#define SCLOG_TYPE_I32          2
+#define SCLOG_TYPE_U32          3
+
+// How a field is predicted from the records before it in the sector
+#define SCLOG_PREDICT_NONE      0   // Not coded, timestamp and ms make the time
+#define SCLOG_PREDICT_DELTA     1   // The last value
+#define SCLOG_PREDICT_LINEAR    2   // Carried on from the last two, the last one
+                                    // for the record after the keyframe
+#define SCLOG_PREDICT_ANGLE     3   // The last value, the residual wrapped to half
+                                    // a turn either way, a turn being 360 / scale
+
+struct __attribute__((packed)) SclogSectorHead {
+    uint32_t magic;
+    uint32_t session;       // Start time, tells this log's sectors from stale ones
+    uint32_t sequence;
+};
+
+struct __attribute__((packed)) SclogField {
+    char name[16];          // Column name, NUL padded
+    char unit[8];
+    uint8_t type;           // SCLOG_TYPE_*
+    uint8_t offset;         // In the record
+    uint8_t predict;        // SCLOG_PREDICT_*
+    uint8_t reserved;
+    float scale;            // Value = stored * scale
+};
+
+#define SCLOG_MAX_FIELDS        12
+
+struct __attribute__((packed)) SclogHeader {
+    SclogSectorHead head;
+    uint16_t version;
+    uint16_t record_size;   // The keyframe
+    uint16_t records_per_sector;  // 0, it varies
+    uint16_t field_count;
+    uint32_t start_time;    // UTC seconds since the epoch
+    SclogField fields[SCLOG_MAX_FIELDS];
+};
+
+// One fix, raw and filtered, as a keyframe. Positions in 1e-6 degrees, as
+// fine as a float of degrees goes; speeds in 0.01 kt, courses in 0.01 degrees.
+struct __attribute__((packed)) SclogRecord {
+    uint32_t timestamp;     // UTC seconds since the epoch
+    uint16_t ms;
+    uint16_t reserved;
+    int32_t raw_lat;
+    int32_t raw_lon;
+    uint16_t raw_speed;
+    uint16_t raw_course;
+    int32_t filtered_lat;
+    int32_t filtered_lon;
+    uint16_t filtered_speed;
+    uint16_t filtered_course;
+};
+
+struct __attribute__((packed)) SclogDataHead {
+    SclogSectorHead head;
+    uint16_t count;         // Records in this chunk, a keyframe too
+    uint8_t stream;         // SCLOG_STREAM_*
+    uint8_t reserved;
+    uint16_t length;        // Bytes of records after this head
+    uint16_t reserved2;
+    uint32_t first_ms;      // Time of the first record and the last
+    uint32_t last_ms;
+};
+
+struct __attribute__((packed)) SclogIndexEntry {
+    uint8_t stream;         // SCLOG_STREAM_*
+    uint8_t reserved[3];
+    uint32_t first_ms;      // Time of the chunk's first record
+};
+
+struct __attribute__((packed)) SclogIndexHead {
+    SclogSectorHead head;
+    uint16_t count;         // Chunks listed so far, in sequence order after this sector
+    uint16_t reserved;
+};
+
+// A line of text: an NMEA sentence without its line end, or an event
+struct __attribute__((packed)) SclogText {
+    uint32_t time_ms;
+    uint8_t type;           // SCLOG_EVENT_*, 0 for NMEA
+    uint8_t length;         // Characters that follow, no NUL
+};
+
+struct __attribute__((packed)) SclogBattery {
+    uint32_t time_ms;
+    int16_t percent;        // 0.1 %, below 0 while charging
+    int16_t current;        // mA, below 0 while discharging
+};
+
+struct __attribute__((packed)) SclogTrailer {
+    SclogSectorHead head;
+    uint32_t records;       // Fixes
+    uint32_t data_sectors;  // Between the header and the trailer, indexes too
+    uint32_t end_time;      // Timestamp of the last fix
+};
+
+#define SCLOG_CRC_OFFSET        (SCLOG_SECTOR - sizeof(uint32_t))
+#define SCLOG_CODE_OFFSET       (sizeof(SclogDataHead) + sizeof(SclogRecord))
+#define SCLOG_CODE_NIBBLES      ((SCLOG_CRC_OFFSET - SCLOG_CODE_OFFSET) * 2)
+#define SCLOG_CHUNK_BYTES       (SCLOG_CRC_OFFSET - sizeof(SclogDataHead))
+#define SCLOG_INDEX_ENTRIES     ((SCLOG_CRC_OFFSET - sizeof(SclogIndexHead)) / sizeof(SclogIndexEntry))
+#define SCLOG_INDEX_SPAN        (SCLOG_INDEX_ENTRIES + 1)   // An index and the chunks it lists
+
+static_assert(sizeof(SclogHeader) <= SCLOG_CRC_OFFSET, "header does not fit a sector");
+
+// CRC-32, reflected 0xEDB88320, a nibble at a time: 64 bytes of table for
+// one sector every few seconds
+static inline uint32_t sclog_crc32(const void* data, size_t len) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t crc = 0xFFFFFFFFu;
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// 0, -1, 1, -2 ... as 0, 1, 2, 3 ..., small either way stays small
+static inline uint32_t sclog_zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
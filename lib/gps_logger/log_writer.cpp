@@ -0,0 +1,325 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/time.h"
+#include "log_writer.h"
+
+extern "C" {
+    #include "MMC_SD.h"
+}
+
+static_assert(LogWriter::QUEUE_SECTORS <= 16, "m_free has a bit per sector");
+
+FRESULT LogWriter::create(const char* path) {
+    FRESULT res = f_open(&m_file, path, FA_WRITE | FA_CREATE_NEW);
+    if (res == FR_OK) {
+        strncpy(m_path, path, sizeof(m_path) - 1);
+        m_path[sizeof(m_path) - 1] = '\0';
+    }
+    return res;
+}
+
+bool LogWriter::start(uint8_t* header, uint32_t session) {
+    m_session = session;
+    m_sequence = 0;
+    m_capacity = 0;
+    m_stats = {};
+    m_free = static_cast<uint16_t>((1u << QUEUE_SECTORS) - 1);
+    memset(m_filling, -1, sizeof(m_filling));
+    m_readyFirst = 0;
+    m_readyCount = 0;
+
+    // The whole file up front: the FAT and the directory entry are written
+    // once here, appends go to clusters the file already has
+    SclogSectorHead head = {SCLOG_MAGIC_HEADER, m_session, m_sequence++};
+    memcpy(header, &head, sizeof(head));
+    if (!growFile(PREALLOC_SECTORS) || !writeSector(header)) {
+        f_close(&m_file);
+        return false;
+    }
+
+    m_syncRequested = false;
+    m_failed = false;
+    m_open = true;
+    return true;
+}
+
+uint8_t* LogWriter::chunk(uint8_t stream) {
+    return m_filling[stream] < 0 ? NULL : m_queue[m_filling[stream]];
+}
+
+// A free sector of the queue, its place in the file the next one
+int LogWriter::takeSector(uint32_t magic) {
+    int sector = __builtin_ctz(m_free);
+    m_free &= static_cast<uint16_t>(~(1u << sector));
+    memset(m_queue[sector], 0, SCLOG_SECTOR);
+    SclogSectorHead head = {magic, m_session, m_sequence++};
+    memcpy(m_queue[sector], &head, sizeof(head));
+    m_count[sector] = 0;
+    m_synced[sector] = 0;
+    return sector;
+}
+
+// The filling sector of a stream or the index joins the queue for service()
+void LogWriter::seal(int owner) {
+    int sector = m_filling[owner];
+    if (sector < 0) {
+        return;
+    }
+    m_filling[owner] = -1;
+    m_ready[(m_readyFirst + m_readyCount) % QUEUE_SECTORS] = static_cast<uint8_t>(sector);
+    m_readyCount++;
+    m_stats.queued = static_cast<uint16_t>(m_readyCount);
+}
+
+// One more record or index entry in a filling sector
+void LogWriter::record(int sector) {
+    m_count[sector]++;
+    if (m_count[sector] == m_synced[sector] + 1) {
+        m_pendingMs[sector] = to_ms_since_boot(get_absolute_time());
+    }
+}
+
+uint8_t* LogWriter::nextChunk(uint8_t stream, uint32_t time_ms) {
+    // An index goes first every SCLOG_INDEX_SPAN sectors. Both have to fit
+    // or neither is taken, the filling chunk then stays with the stream
+    bool index_due = m_sequence % SCLOG_INDEX_SPAN == 1;
+    if (__builtin_popcount(m_free) < (index_due ? 2 : 1)) {
+        m_stats.dropped++;
+        return NULL;
+    }
+    seal(stream);
+    if (index_due) {
+        m_filling[INDEX] = static_cast<int8_t>(takeSector(SCLOG_MAGIC_INDEX));
+    }
+
+    int sector = takeSector(SCLOG_MAGIC_DATA);
+    m_filling[stream] = static_cast<int8_t>(sector);
+    SclogDataHead* head = reinterpret_cast<SclogDataHead*>(m_queue[sector]);
+    head->stream = stream;
+    head->first_ms = time_ms;
+    head->last_ms = time_ms;
+    m_stats.chunks[stream]++;
+
+    // The index lists it now, it is written with the index whether or not
+    // the chunk makes it to the card
+    int index = m_filling[INDEX];
+    SclogIndexEntry* entry = reinterpret_cast<SclogIndexEntry*>(m_queue[index] + sizeof(SclogIndexHead)) +
+                             m_count[index];
+    entry->stream = stream;
+    entry->first_ms = time_ms;
+    record(index);
+    reinterpret_cast<SclogIndexHead*>(m_queue[index])->count = m_count[index];
+    if (m_count[index] == SCLOG_INDEX_ENTRIES) {
+        seal(INDEX);
+    }
+    return m_queue[sector];
+}
+
+void LogWriter::added(uint8_t stream, uint32_t time_ms, uint16_t length) {
+    int sector = m_filling[stream];
+    record(sector);
+    SclogDataHead* head = reinterpret_cast<SclogDataHead*>(m_queue[sector]);
+    head->count = m_count[sector];
+    head->length = length;
+    head->last_ms = time_ms;
+}
+
+bool LogWriter::append(uint8_t stream, uint32_t time_ms, const void* record, uint16_t size) {
+    uint8_t* sector = chunk(stream);
+    uint16_t length = sector ? reinterpret_cast<SclogDataHead*>(sector)->length : 0;
+    if (!sector || length + size > SCLOG_CHUNK_BYTES) {
+        sector = nextChunk(stream, time_ms);
+        if (!sector) {
+            return false;
+        }
+        length = 0;
+    }
+    memcpy(sector + sizeof(SclogDataHead) + length, record, size);
+    added(stream, time_ms, static_cast<uint16_t>(length + size));
+    return true;
+}
+
+void LogWriter::service() {
+    if (!m_open) {
+        return;
+    }
+
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    if (m_failed && now_ms - m_failedMs < RETRY_MS) {
+        return;
+    }
+
+    // Full chunks first, oldest first; a chunk that fails stays queued.
+    // Then the filling chunk that has waited longest, rewritten in place
+    int sector = -1;
+    bool filling = m_readyCount == 0;
+    if (!filling) {
+        sector = m_ready[m_readyFirst];
+    } else {
+        for (int owner = 0; owner <= INDEX; owner++) {
+            int s = m_filling[owner];
+            if (s >= 0 && m_count[s] > m_synced[s] &&
+                (sector < 0 || static_cast<int32_t>(m_pendingMs[s] - m_pendingMs[sector]) < 0)) {
+                sector = s;
+            }
+        }
+        if (sector < 0) {
+            m_syncRequested = false;  // Everything is on the card
+            return;
+        }
+        if (!m_syncRequested && !m_lowBattery && now_ms - m_pendingMs[sector] < m_syncSeconds * 1000) {
+            return;
+        }
+    }
+
+    // A card still programming the last sector would hold the write up in
+    // SD_WaitReady, for as long as SD_BUSY_TIMEOUT_MS; try the next pass
+    if (!SD_IsReady()) {
+        m_stats.busy++;
+        return;
+    }
+    uint64_t start_us = time_us_64();
+
+    if (m_failed && !reopenFile()) {
+        m_failedMs = now_ms;
+        m_stats.errors++;
+        return;
+    }
+
+    bool ok = writeSector(m_queue[sector]);
+    if (ok && filling) {
+        m_synced[sector] = m_count[sector];
+        m_stats.syncs++;
+    } else if (ok) {
+        m_readyFirst = (m_readyFirst + 1) % QUEUE_SECTORS;
+        m_readyCount--;
+        m_free |= static_cast<uint16_t>(1u << sector);
+        m_stats.queued = static_cast<uint16_t>(m_readyCount);
+    }
+
+    m_failed = !ok;
+    if (!ok) {
+        m_failedMs = now_ms;
+        m_stats.errors++;
+    }
+    m_stats.lastUs = static_cast<uint32_t>(time_us_64() - start_us);
+    if (m_stats.lastUs > m_stats.maxUs) {
+        m_stats.maxUs = m_stats.lastUs;
+    }
+}
+
+// Stretch the file by a number of sectors. The FAT and the directory entry
+// are written here and only here while logging.
+bool LogWriter::growFile(uint32_t sectors) {
+    DWORD old_size = m_file.fsize;
+    m_file.cltbl = NULL;  // A fast seek cannot go past the end
+    FRESULT res = f_lseek(&m_file, old_size + sectors * SCLOG_SECTOR);
+    if (res == FR_OK && m_file.fsize == old_size) {
+        res = FR_DENIED;  // Card full
+    }
+    if (res == FR_OK) {
+        res = f_sync(&m_file);
+    }
+    if (res != FR_OK) {
+        printf("Error: Failed to preallocate the log file (error code: %d)\n", res);
+        return false;
+    }
+    if (!mapFile()) {
+        return false;
+    }
+    printf("Log file preallocated to %u kB in %u fragments\n",
+           (unsigned)(m_file.fsize / 1024), m_stats.fragments);
+    return true;
+}
+
+// FatFs keeps a file that failed a write failing, open it again; the
+// clusters and the size are still the file's
+bool LogWriter::reopenFile() {
+    FRESULT res = f_open(&m_file, m_path, FA_WRITE | FA_OPEN_EXISTING);
+    if (res != FR_OK || !mapFile()) {
+        printf("Error: Failed to reopen log file %s (error code: %d)\n", m_path, res);
+        return false;
+    }
+    return true;
+}
+
+// Map the file's clusters for fast seeks, then seeks and writes inside the
+// file do not read the FAT either. FatFs allocates from the last cluster it
+// handed out, on a card that is not too full that is one run; more
+// fragments than the map holds and seeks follow the FAT.
+bool LogWriter::mapFile() {
+    m_capacity = m_file.fsize / SCLOG_SECTOR;
+    m_linkMap[0] = sizeof(m_linkMap) / sizeof(m_linkMap[0]);
+    m_file.cltbl = m_linkMap;
+    FRESULT res = f_lseek(&m_file, CREATE_LINKMAP);
+    m_stats.fragments = static_cast<uint16_t>((m_linkMap[0] - 2) / 2);
+    if (res == FR_NOT_ENOUGH_CORE) {
+        m_file.cltbl = NULL;
+    } else if (res != FR_OK) {
+        return false;
+    }
+    return true;
+}
+
+// Seal a sector with its CRC and put it at the place its head gives. The
+// file already has the clusters and the size, the sector is all that
+// changes on the card and no sync is needed for it to stay in the file.
+bool LogWriter::writeSector(uint8_t* sector) {
+    uint32_t sequence = reinterpret_cast<SclogSectorHead*>(sector)->sequence;
+    if (sequence >= m_capacity && !growFile(PREALLOC_SECTORS)) {
+        return false;
+    }
+
+    uint32_t crc = sclog_crc32(sector, SCLOG_CRC_OFFSET);
+    memcpy(sector + SCLOG_CRC_OFFSET, &crc, sizeof(crc));
+
+    UINT bytesWritten = 0;
+    FRESULT res = f_lseek(&m_file, sequence * SCLOG_SECTOR);
+    if (res == FR_OK) {
+        res = f_write(&m_file, sector, SCLOG_SECTOR, &bytesWritten);
+    }
+    if (res == FR_OK && bytesWritten != SCLOG_SECTOR) {
+        res = FR_DENIED;
+    }
+    if (res != FR_OK) {
+        printf("Error: Failed to write log sector %u (error code: %d)\n", sequence, res);
+        return false;
+    }
+    m_stats.sectorWrites++;
+    return true;
+}
+
+void LogWriter::close(uint8_t* trailer) {
+    if (!m_open) {
+        return;
+    }
+    if (m_failed) {
+        reopenFile();
+    }
+
+    // What is queued, then what is filling
+    while (m_readyCount > 0 && writeSector(m_queue[m_ready[m_readyFirst]])) {
+        m_free |= static_cast<uint16_t>(1u << m_ready[m_readyFirst]);
+        m_readyFirst = (m_readyFirst + 1) % QUEUE_SECTORS;
+        m_readyCount--;
+    }
+    for (int owner = 0; owner <= INDEX; owner++) {
+        int sector = m_filling[owner];
+        if (sector >= 0 && m_count[sector] > m_synced[sector]) {
+            writeSector(m_queue[sector]);
+        }
+    }
+
+    // Tells the converter the log ended on purpose
+    SclogSectorHead head = {SCLOG_MAGIC_TRAILER, m_session, m_sequence};
+    memcpy(trailer, &head, sizeof(head));
+    reinterpret_cast<SclogTrailer*>(trailer)->data_sectors = m_sequence - 1;
+    writeSector(trailer);
+
+    // The rest of the preallocation goes back to the card
+    if (f_lseek(&m_file, (m_sequence + 1) * SCLOG_SECTOR) == FR_OK) {
+        f_truncate(&m_file);
+    }
+    f_close(&m_file);
+    m_open = false;
+}
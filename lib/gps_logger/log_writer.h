@@ -0,0 +1,152 @@
+#pragma once
+
+#include "ff.h"
+#include "log_format.h"
+
+/**
+ * @brief The buffered SD writer behind a session log, shared by its streams
+ *
+ * Each stream fills a chunk, one 512-byte sector, in RAM; a full chunk joins
+ * a queue that service(), from the main loop, writes to the card one sector
+ * per call. A chunk gets its place in the file when it is started, and the
+ * index sector before it lists it there, see log_format.h. The file is
+ * preallocated and written through a fast-seek cluster map, so appends never
+ * touch the FAT or the directory entry. Chunks still filling go to the card
+ * every setSyncSeconds() at most, after requestSync(), and with every record
+ * while the battery is low: that bounds what a power cut loses. A card
+ * still busy with the last sector is not waited for, service() writes on a
+ * later pass.
+ */
+class LogWriter {
+public:
+    /**
+     * @brief Create the log file, FA_CREATE_NEW
+     *
+     * @param path FatFs path, kept to open the file again after a failed write
+     * @return FR_EXIST when the file is there, the caller picks another name
+     */
+    FRESULT create(const char* path);
+
+    /**
+     * @brief Preallocate the file and write the header, sequence 0
+     *
+     * @param header Header sector, its head is filled in here
+     * @param session Start time, tells this log's sectors from stale ones
+     * @return false on a card error, the file is closed
+     */
+    bool start(uint8_t* header, uint32_t session);
+
+    /**
+     * @brief The stream's filling chunk, NULL before its first record
+     */
+    uint8_t* chunk(uint8_t stream);
+
+    /**
+     * @brief Queue the stream's filling chunk and start its next one
+     *
+     * @param time_ms Of the record that starts it
+     * @return The new chunk, its head filled in, or NULL when every sector
+     *         is waiting for the card and the record has to be dropped
+     */
+    uint8_t* nextChunk(uint8_t stream, uint32_t time_ms);
+
+    /**
+     * @brief A record went into the stream's chunk
+     *
+     * @param length Bytes of records in the chunk now
+     */
+    void added(uint8_t stream, uint32_t time_ms, uint16_t length);
+
+    /**
+     * @brief Add a record of whole bytes to the stream, in the next chunk
+     *        when it does not fit the filling one
+     *
+     * @return false when it was dropped, see nextChunk
+     */
+    bool append(uint8_t stream, uint32_t time_ms, const void* record, uint16_t size);
+
+    /**
+     * @brief Write the oldest queued chunk, or a filling one when a sync is
+     *        due; at most one sector per call, none while the card is busy.
+     *        Call from the main loop
+     */
+    void service();
+
+    void requestSync() { m_syncRequested = true; }
+    void setLowBattery(bool low) { m_lowBattery = low; }
+    void setSyncSeconds(uint32_t seconds) { m_syncSeconds = seconds; }
+
+    /**
+     * @brief Write what is queued and filling, then the trailer, give the
+     *        unused preallocation back and close the file
+     *
+     * @param trailer Trailer sector, its head and data_sectors are filled in here
+     */
+    void close(uint8_t* trailer);
+
+    bool isOpen() const { return m_open; }
+
+    /**
+     * @brief Writing cost, for the status report
+     */
+    struct Stats {
+        uint32_t chunks[SCLOG_STREAMS];  // Started, per stream
+        uint32_t dropped;       // Records with no chunk, the card fell behind
+        uint32_t sectorWrites;
+        uint32_t syncs;         // Of filling chunks
+        uint32_t errors;        // Failed writes, retried after RETRY_MS
+        uint32_t busy;          // Passes the card was still programming, left for the next
+        uint32_t lastUs;        // Last service call that wrote
+        uint32_t maxUs;
+        uint16_t queued;        // Full chunks waiting for the card
+        uint16_t fragments;     // Of the preallocated file, 1 when contiguous
+    };
+    const Stats& getStats() const { return m_stats; }
+    void resetMaxUs() { m_stats.maxUs = 0; }
+
+    static constexpr uint32_t SYNC_SECONDS = 30;        // Default loss window
+    static constexpr int QUEUE_SECTORS = 16;            // A filling chunk per stream and the index, the rest queued
+    static constexpr uint32_t PREALLOC_SECTORS = 32768; // 16 MiB, and again when used up
+    static constexpr uint32_t RETRY_MS = 1000;          // After a failed write
+
+private:
+    FIL m_file;
+    char m_path[24];        // 8.3 name, to open it again after a failed write
+    bool m_open = false;
+
+    // Sectors of the queue: free, filling for a stream or the index, or
+    // ready in m_ready from m_readyFirst
+    alignas(4) uint8_t m_queue[QUEUE_SECTORS][SCLOG_SECTOR];
+    static constexpr int INDEX = SCLOG_STREAMS;     // The filling index, after the streams
+    int8_t m_filling[SCLOG_STREAMS + 1];
+    uint8_t m_ready[QUEUE_SECTORS];
+    int m_readyFirst = 0;
+    int m_readyCount = 0;
+    uint16_t m_free = 0;                    // One bit per sector
+    uint16_t m_count[QUEUE_SECTORS] = {};   // Records or index entries
+    uint16_t m_synced[QUEUE_SECTORS] = {};  // Of those, on the card
+    uint32_t m_pendingMs[QUEUE_SECTORS] = {};  // When the oldest not on the card came
+    uint32_t m_session = 0;
+    uint32_t m_sequence = 0;                // Next place in the file
+
+    uint32_t m_syncSeconds = SYNC_SECONDS;
+    bool m_syncRequested = false;
+    bool m_lowBattery = false;
+    bool m_failed = false;                  // The last write, retried RETRY_MS after it
+    uint32_t m_failedMs = 0;
+    Stats m_stats = {};
+
+    // File size in sectors, and the cluster map for fast seeks: the used
+    // length, then a length and first cluster per fragment
+    uint32_t m_capacity = 0;
+    static constexpr int LINK_MAP_FRAGMENTS = 16;
+    DWORD m_linkMap[2 + 2 * LINK_MAP_FRAGMENTS];
+
+    int takeSector(uint32_t magic);
+    void seal(int owner);
+    void record(int sector);
+    bool growFile(uint32_t sectors);
+    bool mapFile();
+    bool reopenFile();
+    bool writeSector(uint8_t* sector);
+};
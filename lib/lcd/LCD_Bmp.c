@@ -46,10 +46,12 @@ void SD_Init(void){
 }
 
 /********************************************************************************
-function:	Display the BMP picture in the SD card
-parameter: 
-		Bmp_ScanDir :   Displays the LCD scanning mode of the BMP picture
+function:	Display the BMP pictures in the SD card, one after the other
+parameter:
 		Lcd_ScanDir :   LCD normal display scan
+note:
+	The bitmaps are drawn row by row at their place in the normal scan,
+	bottom-up files included, so the scan direction is left alone
 ********************************************************************************/
 void LCD_Show_bmp(LCD_SCAN_DIR Lcd_ScanDir){
 	uint32_t bmplen = 0x00;
@@ -58,29 +60,9 @@ void LCD_Show_bmp(LCD_SCAN_DIR Lcd_ScanDir){
     uint32_t bmpcounter = 0x00;
     DIR directory;
     FRESULT res;
-	LCD_SCAN_DIR Bmp_ScanDir = Lcd_ScanDir;
-	// L2R_U2D  = 0,	//0°
-    // D2U_L2R  ,      //90°
-    // R2L_D2U  ,      //180°
-    // U2D_R2L  ,      //270°  
-	if (Lcd_ScanDir == L2R_U2D)
-	{
-		Bmp_ScanDir = R2L_D2U;
-	}
-	else if (Lcd_ScanDir == R2L_D2U)
-	{
-		Bmp_ScanDir = L2R_U2D;
-	}
-	else if (Lcd_ScanDir == D2U_L2R)
-	{
-		Bmp_ScanDir = U2D_R2L;
-	}
-	else
-	{
-		Bmp_ScanDir = D2U_L2R;
-	}
-	
+
     /* Open directory */
+	LCD_SetGramScanWay(Lcd_ScanDir);
 	LCD_Clear(LCD_BACKGROUND);
     res = f_opendir(&directory, "/");
     if((res != FR_OK)){
@@ -108,19 +90,18 @@ void LCD_Show_bmp(LCD_SCAN_DIR Lcd_ScanDir){
         checkstatus = Storage_CheckBitmapFile((const char*)str, &bmplen);
         
         if(checkstatus == 0){
-			//Display the scan of the picture
-			BMP_SetGramScanWay(Bmp_ScanDir);
 			/* Open the image and display the picture */
-			Storage_OpenReadFile(0, 0, (const char*)str);
+			uint64_t start = time_us_64();
+			checkstatus = Storage_OpenReadFile(0, 0, (const char*)str);
+			LCD_WaitIdle();
+			printf("%s: %s in %u ms\r\n", (const char*)str,
+				   checkstatus == 0 ? "shown" : checkstatus == 1 ? "file not readable" : "not a 24/32 bit bitmap",
+				   (uint32_t)((time_us_64() - start) / 1000));
         }else if (checkstatus == 1){
 			/* Display message: SD card does not exist */
-			//Restore the default scan
-			LCD_SetGramScanWay(Lcd_ScanDir);
 			GUI_DisString_EN(0, 64, "SD_CARD_NOT_FOUND", &Font24,LCD_BACKGROUND,BLUE);
         }else {
 			/* Display message: File not supported */
-			//Restore the default scan
-			LCD_SetGramScanWay(Lcd_ScanDir);
             GUI_DisString_EN(0, 80, "SD_CARD_FILE_NOT_SUPPORTED", &Font24,LCD_BACKGROUND,BLUE);
         }
 
@@ -129,9 +110,9 @@ void LCD_Show_bmp(LCD_SCAN_DIR Lcd_ScanDir){
 			bmpcounter = 1;
 			break;
         }
-
+		//Leave each picture up for a while before the next one
+		Driver_Delay_ms(1500);
 	}
 	// LCD_Clear(LCD_BACKGROUND);
-	//Restore the default scan
 	DEV_Digital_Write(SD_CS_PIN,1);	
 }
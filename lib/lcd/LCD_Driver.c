@@ -14,9 +14,65 @@
 
 /**************************Intermediate driver layer**************************/
 #include "LCD_Driver.h"
+#include "LCD_Framebuffer.h"
+#include "DEV_Bus.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
 
 LCD_DIS sLCD_DIS;
 uint8_t id;
+
+/*******************************************************************************
+	DMA transport
+	Window commands and pixel payloads are queued as jobs. The DMA IRQ
+	starts the next job when the previous one has left the SPI FIFO, so
+	the CPU can prepare the next region while the current one goes out.
+	Pixels go out as 16-bit SPI frames, commands as 8-bit frames.
+	The LCD takes the bus when a job is queued on an empty queue and gives
+	it back from the IRQ once the queue has drained, with the port back in
+	8-bit mode and CS high, which is what the SD card and touch drivers
+	expect. Whatever they were waiting for goes out between two runs of
+	the queue, never in the middle of a window and its pixels.
+	The queue is guarded by a hardware spin lock rather than by masking
+	interrupts, the render pipeline feeds it and takes its IRQ on the
+	other core.
+*******************************************************************************/
+#define LCD_QUEUE_LEN		16		//Jobs in flight, must be a power of two
+#define LCD_LINE_BUF_NUM	2		//Double buffered line buffers, per core
+#define LCD_LINE_CORES		2		//The pipeline consumer draws on the other core
+
+typedef enum {
+	LCD_JOB_WINDOW = 0,				//Set the window and start a memory write
+	LCD_JOB_PIXELS,					//Stream a pixel buffer
+	LCD_JOB_FILL,					//Repeat one color
+	LCD_JOB_REG,					//A command byte, in Color
+	LCD_JOB_DATA,					//A parameter, in Color
+} LCD_JOB_TYPE;
+
+typedef struct {
+	LCD_JOB_TYPE Type;
+	POINT Xstart, Ystart, Xend, Yend;
+	const COLOR *pPixel;
+	COLOR Color;					//DMA reads the fill color from here
+	uint32_t Num;					//Number of pixels
+	int8_t Line_Buf;				//Line buffer released when done, -1 if none
+} LCD_JOB;
+
+static LCD_JOB LCD_Queue[LCD_QUEUE_LEN];
+static volatile uint32_t LCD_Queue_Head;	//Written by the producer
+static volatile uint32_t LCD_Queue_Tail;	//Written by the IRQ
+static volatile bool LCD_Dma_Busy;
+static int LCD_Dma_Chan = -1;
+static uint LCD_Dma_Irq_Index;				//0 for DMA_IRQ_0, 1 for DMA_IRQ_1
+static spin_lock_t *LCD_Queue_Lock;
+static volatile bool LCD_Bus_Held;			//The queue holds the bus
+
+//Each core takes its own pair, so the one drawing never gets a buffer the
+//other is filling or the DMA is still sending
+static COLOR LCD_Line_Buf[LCD_LINE_CORES * LCD_LINE_BUF_NUM][LCD_X_MAXPIXEL];
+static volatile bool LCD_Line_Busy[LCD_LINE_CORES * LCD_LINE_BUF_NUM];
+static uint8_t LCD_Line_Next[LCD_LINE_CORES];
 /*******************************************************************************
 function:
 	Hardware reset
@@ -31,53 +87,445 @@ static void LCD_Reset(void)
     Driver_Delay_ms(500);
 }
 
-static void LCD_SetBackLight(uint16_t value)
+/*******************************************************************************
+function:
+		Backlight brightness
+parameter:
+	Level :   Perceived brightness, 0 (off) to 1000
+note:
+	The eye is close to logarithmic, so the duty follows the CIE 1931
+	lightness curve: half brightness is under a fifth of the power
+*******************************************************************************/
+static const uint16_t LCD_BKL_Curve[11] = {
+    0, 11, 30, 63, 113, 184, 281, 407, 566, 761, 1000
+};
+static uint16_t LCD_BKL_Duty = 1000;
+
+void LCD_SetBackLight(uint16_t Level)
+{
+    uint16_t Step, Frac;
+
+    if(Level > 1000)
+        Level = 1000;
+    Step = Level / 100;
+    Frac = Level % 100;
+    LCD_BKL_Duty = LCD_BKL_Curve[Step];
+    if(Frac)
+        LCD_BKL_Duty += (LCD_BKL_Curve[Step + 1] - LCD_BKL_Curve[Step]) * Frac / 100;
+    DEV_Set_PWM(LCD_BKL_Duty);
+}
+
+uint16_t LCD_GetBackLightDuty(void)
 {
-//	PWM_SetValue(value);
+    return LCD_BKL_Duty;
 }
 /*******************************************************************************
 function:
-		Write register address and data
+		Send one command and its parameters from the transport
+parameter:
+	Reg    :   Command
+	pParam :   Parameters as 16-bit frames
+	Num    :   Number of parameters
+note:
+	Talks to the SPI block directly, the queue already holds the bus
 *******************************************************************************/
-void LCD_WriteReg(uint8_t Reg)
+static void LCD_Send_Reg(uint8_t Reg, const uint16_t *pParam, uint8_t Num)
 {
-    DEV_Digital_Write(LCD_DC_PIN,0);
-    DEV_Digital_Write(LCD_CS_PIN,0);
-    SPI4W_Write_Byte(Reg);
-	DEV_Digital_Write(LCD_CS_PIN,1);
+	gpio_put(LCD_DC_PIN,0);
+	gpio_put(LCD_CS_PIN,0);
+	spi_write_blocking(SPI_PORT, &Reg, 1);
+	if(Num) {
+		gpio_put(LCD_DC_PIN,1);
+		spi_set_format(SPI_PORT, 16, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+		spi_write16_blocking(SPI_PORT, pParam, Num);
+		spi_set_format(SPI_PORT, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+	}
+	gpio_put(LCD_CS_PIN,1);
 }
 
-void LCD_WriteData(uint16_t Data)
+/*******************************************************************************
+function:
+		Set the window of a job and start the memory write
+note:
+	The 3.5 inch panel takes every parameter byte as a 16-bit word,
+	the 2.8 inch panel takes the bytes as they are
+*******************************************************************************/
+static void LCD_Send_Window(const LCD_JOB *pJob)
 {
+	uint16_t Param[4];
+	uint8_t Num;
+
 	if(LCD_2_8 == id){
-		DEV_Digital_Write(LCD_DC_PIN,1);
-		DEV_Digital_Write(LCD_CS_PIN,0);
-		SPI4W_Write_Byte((uint8_t)Data);
-		DEV_Digital_Write(LCD_CS_PIN,1);
+		Param[0] = pJob->Xstart;
+		Param[1] = pJob->Xend - 1;
+		Num = 2;
 	}else{
-		DEV_Digital_Write(LCD_DC_PIN,1);
-		DEV_Digital_Write(LCD_CS_PIN,0);
-		SPI4W_Write_Byte(Data >> 8);
-		SPI4W_Write_Byte(Data & 0XFF);
-		DEV_Digital_Write(LCD_CS_PIN,1);
+		Param[0] = pJob->Xstart >> 8;
+		Param[1] = pJob->Xstart & 0xff;
+		Param[2] = (pJob->Xend - 1) >> 8;
+		Param[3] = (pJob->Xend - 1) & 0xff;
+		Num = 4;
 	}
-    
+	LCD_Send_Reg(0x2A, Param, Num);
+
+	if(LCD_2_8 == id){
+		Param[0] = pJob->Ystart;
+		Param[1] = pJob->Yend - 1;
+	}else{
+		Param[0] = pJob->Ystart >> 8;
+		Param[1] = pJob->Ystart & 0xff;
+		Param[2] = (pJob->Yend - 1) >> 8;
+		Param[3] = (pJob->Yend - 1) & 0xff;
+	}
+	LCD_Send_Reg(0x2B, Param, Num);
+
+	LCD_Send_Reg(0x2C, NULL, 0);
+}
+
+/*******************************************************************************
+function:
+		Send a job the CPU clocks out itself: a window, a command or a
+		parameter
+note:
+	The 2.8 inch panel takes a parameter as one byte, the 3.5 inch panel
+	as a 16-bit word
+*******************************************************************************/
+static void LCD_Send_Job(const LCD_JOB *pJob)
+{
+	uint8_t Byte;
+
+	switch(pJob->Type) {
+	case LCD_JOB_WINDOW:
+		LCD_Send_Window(pJob);
+		break;
+	case LCD_JOB_REG:
+		LCD_Send_Reg((uint8_t)pJob->Color, NULL, 0);
+		break;
+	default:
+		gpio_put(LCD_DC_PIN,1);
+		gpio_put(LCD_CS_PIN,0);
+		if(LCD_2_8 == id){
+			Byte = (uint8_t)pJob->Color;
+			spi_write_blocking(SPI_PORT, &Byte, 1);
+		}else{
+			spi_set_format(SPI_PORT, 16, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+			spi_write16_blocking(SPI_PORT, &pJob->Color, 1);
+			spi_set_format(SPI_PORT, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+		}
+		gpio_put(LCD_CS_PIN,1);
+		break;
+	}
+}
+
+/*******************************************************************************
+function:
+		Start queued jobs until one is handed to the DMA
+note:
+	Called with the queue lock held. Gives the bus back once there is
+	nothing left to send.
+*******************************************************************************/
+static void LCD_Queue_Kick(void)
+{
+	while(!LCD_Dma_Busy && LCD_Queue_Tail != LCD_Queue_Head) {
+		LCD_JOB *pJob = &LCD_Queue[LCD_Queue_Tail & (LCD_QUEUE_LEN - 1)];
+
+		if(pJob->Type != LCD_JOB_PIXELS && pJob->Type != LCD_JOB_FILL) {
+			LCD_Send_Job(pJob);
+			LCD_Queue_Tail++;
+			continue;
+		}
+
+		dma_channel_config Config = dma_channel_get_default_config(LCD_Dma_Chan);
+		channel_config_set_transfer_data_size(&Config, DMA_SIZE_16);
+		channel_config_set_dreq(&Config, spi_get_dreq(SPI_PORT, true));
+		channel_config_set_read_increment(&Config, pJob->Type == LCD_JOB_PIXELS);
+		channel_config_set_write_increment(&Config, false);
+
+		gpio_put(LCD_DC_PIN,1);
+		gpio_put(LCD_CS_PIN,0);
+		spi_set_format(SPI_PORT, 16, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+		LCD_Dma_Busy = true;
+		dma_channel_configure(LCD_Dma_Chan, &Config, &spi_get_hw(SPI_PORT)->dr,
+							  pJob->Type == LCD_JOB_PIXELS ? pJob->pPixel : &pJob->Color,
+							  pJob->Num, true);
+	}
+
+	if(LCD_Bus_Held && !LCD_Dma_Busy && LCD_Queue_Tail == LCD_Queue_Head) {
+		LCD_Bus_Held = false;
+		DEV_Bus_Release(DEV_BUS_LCD);
+	}
+}
+
+/*******************************************************************************
+function:
+		DMA completion, finish the running job and start the next one
+*******************************************************************************/
+static void LCD_Dma_Handler(void)
+{
+	uint32_t Irq = spin_lock_blocking(LCD_Queue_Lock);
+	if(!dma_irqn_get_channel_status(LCD_Dma_Irq_Index, LCD_Dma_Chan)) {
+		spin_unlock(LCD_Queue_Lock, Irq);
+		return;
+	}
+	dma_irqn_acknowledge_channel(LCD_Dma_Irq_Index, LCD_Dma_Chan);
+
+	//The DMA is done once the FIFO has the last frame, wait for it to shift out
+	while(spi_is_busy(SPI_PORT))
+		tight_loop_contents();
+	//Nothing was read back, throw away what piled up in the RX FIFO
+	while(spi_is_readable(SPI_PORT))
+		(void)spi_get_hw(SPI_PORT)->dr;
+	spi_get_hw(SPI_PORT)->icr = SPI_SSPICR_RORIC_BITS;
+
+	spi_set_format(SPI_PORT, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+	gpio_put(LCD_CS_PIN,1);
+
+	LCD_JOB *pJob = &LCD_Queue[LCD_Queue_Tail & (LCD_QUEUE_LEN - 1)];
+	if(pJob->Line_Buf >= 0)
+		LCD_Line_Busy[pJob->Line_Buf] = false;
+	LCD_Queue_Tail++;
+	LCD_Dma_Busy = false;
+
+	LCD_Queue_Kick();
+	spin_unlock(LCD_Queue_Lock, Irq);
+}
+
+/*******************************************************************************
+function:
+		Add a job to the queue and start it if the DMA is free
+note:
+	Waits for the bus when the queue does not hold it yet
+*******************************************************************************/
+static void LCD_Queue_Push(const LCD_JOB *pJob)
+{
+	if(LCD_Dma_Chan < 0) {
+		//No DMA yet (before LCD_Init), fall back to the blocking writes
+		LCD_JOB Job = *pJob;
+		DEV_Bus_Acquire(DEV_BUS_LCD);
+		if(Job.Type != LCD_JOB_PIXELS && Job.Type != LCD_JOB_FILL) {
+			LCD_Send_Job(&Job);
+			DEV_Bus_Release(DEV_BUS_LCD);
+			return;
+		}
+		gpio_put(LCD_DC_PIN,1);
+		gpio_put(LCD_CS_PIN,0);
+		spi_set_format(SPI_PORT, 16, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+		if(Job.Type == LCD_JOB_PIXELS) {
+			spi_write16_blocking(SPI_PORT, Job.pPixel, Job.Num);
+		} else {
+			while(Job.Num--)
+				spi_write16_blocking(SPI_PORT, &Job.Color, 1);
+		}
+		spi_set_format(SPI_PORT, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+		gpio_put(LCD_CS_PIN,1);
+		DEV_Bus_Release(DEV_BUS_LCD);
+		if(Job.Line_Buf >= 0)
+			LCD_Line_Busy[Job.Line_Buf] = false;
+		return;
+	}
+
+	//The slot is checked and filled with the lock held, both cores push.
+	//Waits for the bus or a free slot go without it, the IRQ needs it
+	//meanwhile, and the other core may have pushed when it is back
+	uint32_t Irq = spin_lock_blocking(LCD_Queue_Lock);
+	for(;;) {
+		if(!LCD_Bus_Held) {
+			spin_unlock(LCD_Queue_Lock, Irq);
+			DEV_Bus_Acquire(DEV_BUS_LCD);
+			Irq = spin_lock_blocking(LCD_Queue_Lock);
+			if(LCD_Bus_Held)
+				DEV_Bus_Release(DEV_BUS_LCD);	//The other core's push took it first
+			LCD_Bus_Held = true;
+		}
+		if(LCD_Queue_Head - LCD_Queue_Tail < LCD_QUEUE_LEN)
+			break;
+		spin_unlock(LCD_Queue_Lock, Irq);
+		uint64_t Start = time_us_64();
+		while(LCD_Queue_Head - LCD_Queue_Tail >= LCD_QUEUE_LEN)
+			tight_loop_contents();
+		sDev_SPI_Stats.Wait_Us += time_us_64() - Start;
+		Irq = spin_lock_blocking(LCD_Queue_Lock);
+	}
+	LCD_Queue[LCD_Queue_Head & (LCD_QUEUE_LEN - 1)] = *pJob;
+	LCD_Queue_Head++;
+	LCD_Queue_Kick();
+	spin_unlock(LCD_Queue_Lock, Irq);
+}
+
+/*******************************************************************************
+function:
+		Set up the DMA channel of the transport
+*******************************************************************************/
+static void LCD_Dma_Init(void)
+{
+	if(LCD_Dma_Chan >= 0)
+		return;
+	LCD_Queue_Lock = spin_lock_init(spin_lock_claim_unused(true));
+	LCD_Dma_Chan = dma_claim_unused_channel(true);
+	dma_channel_set_irq0_enabled(LCD_Dma_Chan, true);
+	irq_add_shared_handler(DMA_IRQ_0, LCD_Dma_Handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+	irq_set_enabled(DMA_IRQ_0, true);
+}
+
+/*******************************************************************************
+function:
+		Take the DMA IRQ of the transport to the calling core
+note:
+	Core 0 set it up on DMA_IRQ_0, any other core gets DMA_IRQ_1. Jobs
+	already in flight finish on the new core.
+*******************************************************************************/
+void LCD_ClaimTransport(void)
+{
+	uint Index = get_core_num() ? 1 : 0;
+
+	LCD_Dma_Init();
+	if(Index == LCD_Dma_Irq_Index)
+		return;
+
+	uint Irq_Num = Index ? DMA_IRQ_1 : DMA_IRQ_0;
+	irq_add_shared_handler(Irq_Num, LCD_Dma_Handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+	irq_set_enabled(Irq_Num, true);
+
+	uint32_t Irq = spin_lock_blocking(LCD_Queue_Lock);
+	dma_irqn_set_channel_enabled(LCD_Dma_Irq_Index, LCD_Dma_Chan, false);
+	dma_irqn_set_channel_enabled(Index, LCD_Dma_Chan, true);
+	LCD_Dma_Irq_Index = Index;
+	spin_unlock(LCD_Queue_Lock, Irq);
+}
+
+/*******************************************************************************
+function:
+		Wait until everything queued has been sent
+note:
+	Waits for the render pipeline to drain first
+*******************************************************************************/
+void LCD_WaitIdle(void)
+{
+	FB_Pipeline_Wait();
+	if(LCD_Queue_Tail == LCD_Queue_Head)
+		return;
+	uint64_t Start = time_us_64();
+	while(LCD_Queue_Tail != LCD_Queue_Head)
+		tight_loop_contents();
+	sDev_SPI_Stats.Wait_Us += time_us_64() - Start;
+}
+
+/*******************************************************************************
+function:
+		Get a free line buffer
+note:
+	Fill it and hand it to LCD_WritePixels, it comes back free once the
+	DMA has sent it, or right away when it went to the framebuffer. With
+	two buffers one line is computed while the previous one is on the wire.
+	The buffers are the calling core's, both cores can draw at once.
+*******************************************************************************/
+COLOR *LCD_GetLineBuf(void)
+{
+	uint Core = get_core_num();
+	uint8_t Buf = Core * LCD_LINE_BUF_NUM + LCD_Line_Next[Core];
+	LCD_Line_Next[Core] = (LCD_Line_Next[Core] + 1) % LCD_LINE_BUF_NUM;
+
+	if(LCD_Line_Busy[Buf]) {
+		uint64_t Start = time_us_64();
+		while(LCD_Line_Busy[Buf])
+			tight_loop_contents();
+		sDev_SPI_Stats.Wait_Us += time_us_64() - Start;
+	}
+	return LCD_Line_Buf[Buf];
+}
+
+/*******************************************************************************
+function:
+		Write a run of pixels into the current window
+parameter:
+	pPixel   :   RGB565 pixels
+	PixelNum :   Number of pixels
+note:
+	Queued, pPixel is read by the DMA after this returns. Use a buffer from
+	LCD_GetLineBuf, or leave the memory alone until LCD_WaitIdle.
+	Goes to the framebuffer instead while it is active.
+*******************************************************************************/
+void LCD_WritePixels(const COLOR *pPixel, uint32_t PixelNum)
+{
+	LCD_JOB Job;
+	uint8_t i;
+
+	if(PixelNum == 0)
+		return;
+	if(FB_Active()) {
+		FB_WritePixels(pPixel, PixelNum);
+		return;
+	}
+	Job.Type = LCD_JOB_PIXELS;
+	Job.pPixel = pPixel;
+	Job.Num = PixelNum;
+	Job.Line_Buf = -1;
+	for(i = 0; i < LCD_LINE_CORES * LCD_LINE_BUF_NUM; i++) {
+		if(pPixel == LCD_Line_Buf[i]) {
+			LCD_Line_Busy[i] = true;
+			Job.Line_Buf = i;
+		}
+	}
+	sDev_SPI_Stats.Bytes += PixelNum * 2;
+	sDev_SPI_Stats.Transfers++;
+	LCD_Queue_Push(&Job);
 }
 
 /*******************************************************************************
 function:
 		Write register data
+note:
+	Queued, the DMA sends the same color over and over
 *******************************************************************************/
 static void LCD_Write_AllData(uint16_t Data, uint32_t DataLen)
 {
-    uint32_t i;
-    DEV_Digital_Write(LCD_DC_PIN,1);
-    DEV_Digital_Write(LCD_CS_PIN,0);
-    for(i = 0; i < DataLen; i++) {
-        SPI4W_Write_Byte(Data >> 8);
-        SPI4W_Write_Byte(Data & 0XFF);
-    }
-	DEV_Digital_Write(LCD_CS_PIN,1);
+	LCD_JOB Job;
+
+	if(DataLen == 0)
+		return;
+	if(FB_Active()) {
+		FB_Fill(Data, DataLen);
+		return;
+	}
+	Job.Type = LCD_JOB_FILL;
+	Job.Color = Data;
+	Job.Num = DataLen;
+	Job.Line_Buf = -1;
+	sDev_SPI_Stats.Bytes += DataLen * 2;
+	sDev_SPI_Stats.Transfers++;
+	LCD_Queue_Push(&Job);
+}
+
+/*******************************************************************************
+function:
+		Write register address and data
+note:
+	Queued behind what is already queued, so the bus is the queue's and a
+	burst from the other core never runs under it. Blocking, it is on the
+	panel when this returns.
+*******************************************************************************/
+static void LCD_Write_Byte_Job(LCD_JOB_TYPE Type, uint16_t Value)
+{
+	LCD_JOB Job;
+
+	Job.Type = Type;
+	Job.Color = Value;
+	Job.Num = 0;
+	Job.Line_Buf = -1;
+	sDev_SPI_Stats.Bytes += (Type == LCD_JOB_DATA && LCD_2_8 != id) ? 2 : 1;
+	sDev_SPI_Stats.Transfers++;
+	LCD_Queue_Push(&Job);
+	LCD_WaitIdle();
+}
+
+void LCD_WriteReg(uint8_t Reg)
+{
+	LCD_Write_Byte_Job(LCD_JOB_REG, Reg);
+}
+
+void LCD_WriteData(uint16_t Data)
+{
+	LCD_Write_Byte_Job(LCD_JOB_DATA, Data);
 }
 
 /*******************************************************************************
@@ -412,10 +860,10 @@ void LCD_Init(LCD_SCAN_DIR LCD_ScanDir, uint16_t LCD_BLval)
     LCD_Reset();//Hardware reset
 
     LCD_InitReg();//Set the initialization register
+
+    LCD_Dma_Init();//Queue window and pixel writes for the DMA
 	
-	if(LCD_BLval > 1000)
-		LCD_BLval = 1000;
-	//LCD_SetBackLight(LCD_BLval);
+	LCD_SetBackLight(LCD_BLval);
 	
 	LCD_SetGramScanWay(LCD_ScanDir);//Set the display scan and color transfer modes
 	Driver_Delay_ms(200);
@@ -431,22 +879,21 @@ parameter:
 ********************************************************************************/
 void LCD_SetWindow(POINT Xstart, POINT Ystart,	POINT Xend, POINT Yend)
 {	
+	LCD_JOB Job;
 
-	//set the X coordinates
-	LCD_WriteReg(0x2A);
-	LCD_WriteData(Xstart >> 8);	 		//Set the horizontal starting point to the high octet
-	LCD_WriteData(Xstart & 0xff);	 	//Set the horizontal starting point to the low octet
-	LCD_WriteData((Xend - 1) >> 8);		//Set the horizontal end to the high octet
-	LCD_WriteData((Xend - 1) & 0xff);	//Set the horizontal end to the low octet
-
-	//set the Y coordinates
-	LCD_WriteReg(0x2B);
-	LCD_WriteData(Ystart >> 8);
-	LCD_WriteData(Ystart & 0xff );
-	LCD_WriteData((Yend - 1) >> 8);
-	LCD_WriteData((Yend - 1) & 0xff);
-
-    LCD_WriteReg(0x2C);
+	if(FB_Active()) {
+		FB_SetWindow(Xstart, Ystart, Xend, Yend);
+		return;
+	}
+	Job.Type = LCD_JOB_WINDOW;
+	Job.Xstart = Xstart;
+	Job.Ystart = Ystart;
+	Job.Xend = Xend;
+	Job.Yend = Yend;
+	Job.Line_Buf = -1;
+	sDev_SPI_Stats.Bytes += (LCD_2_8 == id) ? 3 + 8 : 3 + 16;
+	sDev_SPI_Stats.Transfers += 3;
+	LCD_Queue_Push(&Job);
 }
 
 /********************************************************************************
@@ -516,10 +963,13 @@ uint8_t LCD_Read_Id(void)
 	uint8_t reg = 0xDC;
 	uint8_t tx_val = 0x00;
 	uint8_t rx_val;
+	LCD_WaitIdle();
+	DEV_Bus_Acquire(DEV_BUS_LCD);
     DEV_Digital_Write(LCD_CS_PIN, 0);
     DEV_Digital_Write(LCD_DC_PIN, 0);
 	SPI4W_Write_Byte(reg);
 	spi_write_read_blocking(spi1,&tx_val,&rx_val,1);
     DEV_Digital_Write(LCD_CS_PIN, 1);
+	DEV_Bus_Release(DEV_BUS_LCD);
 	return rx_val;
 }
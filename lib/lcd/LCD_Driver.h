@@ -71,11 +71,17 @@ function:
 			Macro definition variable name
 ********************************************************************************/
 void LCD_Init(LCD_SCAN_DIR LCD_ScanDir, uint16_t LCD_BLval);
+void LCD_SetBackLight(uint16_t Level);
+uint16_t LCD_GetBackLightDuty(void);
 void LCD_SetGramScanWay(LCD_SCAN_DIR Scan_dir);
 void BMP_SetGramScanWay(LCD_SCAN_DIR Scan_dir);
 
 void LCD_WriteReg(uint8_t Reg);
 void LCD_WriteData(uint16_t Data);
+COLOR *LCD_GetLineBuf(void);
+void LCD_WritePixels(const COLOR *pPixel, uint32_t PixelNum);
+void LCD_WaitIdle(void);
+void LCD_ClaimTransport(void);
 
 void LCD_SetWindow(POINT Xstart, POINT Ystart, POINT Xend, POINT Yend);
 void LCD_SetCursor(POINT Xpoint, POINT Ypoint);
@@ -0,0 +1,540 @@
+/*****************************************************************************
+* | File      	:	LCD_Framebuffer.c
+* | Function    :	Off-screen 8bpp palette framebuffer with dirty tiles
+* | Info        :
+*   Every pixel is an index into a palette of up to 256 RGB565 colors,
+*   a 480x320 screen takes 150 KB. Writing a pixel that already has the
+*   color does not mark its tile, so redrawing the same content is free.
+*   FB_Flush merges dirty tiles into rectangles and streams them through
+*   the LCD transport, expanding indices to RGB565 one line at a time.
+*   With the render pipeline running, that streaming moves to the other
+*   core and FB_Flush only copies the dirty indices over.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+* | Info        :   Basic version
+*
+******************************************************************************/
+#include "LCD_Framebuffer.h"
+#include "hardware/sync.h"
+#include "pico/util/queue.h"
+#include <string.h>
+
+extern LCD_DIS sLCD_DIS;
+
+#define FB_TILES_MAX	(((LCD_X_MAXPIXEL + FB_TILE_SIZE - 1) / FB_TILE_SIZE) * \
+						 ((LCD_Y_MAXPIXEL + FB_TILE_SIZE - 1) / FB_TILE_SIZE))
+
+FB_STATS sFB_Stats;
+
+static uint8_t FB_Pixel[LCD_X_MAXPIXEL * LCD_Y_MAXPIXEL];
+static uint8_t FB_Dirty[FB_TILES_MAX];
+static COLOR FB_Palette[FB_PALETTE_SIZE];
+static uint16_t FB_Palette_Num;
+
+static POINT FB_Width, FB_Height;
+static POINT FB_Tiles_X, FB_Tiles_Y;
+static bool FB_On, FB_Flushing;
+
+//Current window, end exclusive, and the write position inside it
+static POINT FB_Win_Xs, FB_Win_Ys, FB_Win_Xe, FB_Win_Ye;
+static POINT FB_Cur_X, FB_Cur_Y;
+
+//The last two colors looked up, text alternates between foreground and background
+static COLOR FB_Cache_Color[2];
+static uint8_t FB_Cache_Index[2];
+static bool FB_Cache_Valid[2];
+static uint8_t FB_Cache_Next;
+
+/*******************************************************************************
+	Render pipeline
+	The drawing core is the producer: FB_Flush copies the palette indices
+	of each dirty rectangle into a staging ring and queues them as bands
+	of rows, then goes back to drawing the next frame. The consumer, the
+	core in FB_Pipeline_Run, expands the bands to RGB565 and feeds the LCD
+	transport, whose DMA IRQ it takes over. Both the ring and the band
+	queue are bounded, a producer that gets too far ahead waits for room.
+	Palette entries are only ever added between two FB_Init, and FB_Init
+	drains the pipeline, so the consumer can read the palette as it is.
+*******************************************************************************/
+typedef struct {
+	POINT Xstart, Ystart, Xend, Yend;	//Empty for the band that closes a flush
+	uint32_t End;						//Ring position after the band
+	uint64_t Start_Us;					//When the flush started
+} FB_BAND;
+
+static uint8_t FB_Stage[FB_STAGE_SIZE];
+static uint32_t FB_Stage_Head;				//Written by the producer
+static volatile uint32_t FB_Stage_Tail;		//Written by the consumer
+static queue_t FB_Bands;
+static volatile bool FB_Pipe_On;
+static uint FB_Pipe_Core;
+static uint32_t FB_Pipe_Sent;				//Flushes handed over
+static volatile uint32_t FB_Pipe_Done;		//Flushes the consumer has sent
+
+/******************************************************************************
+function:	Palette index of a color
+note:
+	New colors are added to the palette, once it is full the closest
+	existing color is used
+******************************************************************************/
+static uint8_t FB_Index(COLOR Color)
+{
+    uint16_t i;
+    uint8_t Index = 0;
+
+    for(i = 0; i < 2; i++) {
+        if(FB_Cache_Valid[i] && FB_Cache_Color[i] == Color)
+            return FB_Cache_Index[i];
+    }
+
+    for(i = 0; i < FB_Palette_Num; i++) {
+        if(FB_Palette[i] == Color)
+            break;
+    }
+
+    if(i < FB_Palette_Num) {
+        Index = i;
+    } else if(FB_Palette_Num < FB_PALETTE_SIZE) {
+        Index = FB_Palette_Num;
+        FB_Palette[FB_Palette_Num++] = Color;
+    } else {
+        uint32_t Best = UINT32_MAX;
+        for(i = 0; i < FB_Palette_Num; i++) {
+            int32_t Dr = (int32_t)(Color >> 11) - (FB_Palette[i] >> 11);
+            int32_t Dg = (int32_t)((Color >> 5) & 0x3f) - ((FB_Palette[i] >> 5) & 0x3f);
+            int32_t Db = (int32_t)(Color & 0x1f) - (FB_Palette[i] & 0x1f);
+            uint32_t Dist = 4 * Dr * Dr + Dg * Dg + 4 * Db * Db;
+            if(Dist < Best) {
+                Best = Dist;
+                Index = i;
+            }
+        }
+    }
+
+    FB_Cache_Color[FB_Cache_Next] = Color;
+    FB_Cache_Index[FB_Cache_Next] = Index;
+    FB_Cache_Valid[FB_Cache_Next] = true;
+    FB_Cache_Next ^= 1;
+    return Index;
+}
+
+/******************************************************************************
+function:	Start the framebuffer
+parameter:
+	Color :   The color the panel shows right now, usually what it was
+	          just cleared to
+note:
+	Nothing is dirty afterwards, the framebuffer is assumed to match the
+	panel. Drawing goes to RAM from here on until FB_Enable(false).
+******************************************************************************/
+void FB_Init(COLOR Color)
+{
+    LCD_WaitIdle();
+
+    FB_Width = sLCD_DIS.LCD_Dis_Column;
+    FB_Height = sLCD_DIS.LCD_Dis_Page;
+    FB_Tiles_X = (FB_Width + FB_TILE_SIZE - 1) / FB_TILE_SIZE;
+    FB_Tiles_Y = (FB_Height + FB_TILE_SIZE - 1) / FB_TILE_SIZE;
+
+    FB_Palette_Num = 0;
+    memset(FB_Cache_Valid, 0, sizeof(FB_Cache_Valid));
+    memset(FB_Pixel, FB_Index(Color), (uint32_t)FB_Width * FB_Height);
+    memset(FB_Dirty, 0, sizeof(FB_Dirty));
+    FB_Win_Xs = FB_Win_Ys = 0;
+    FB_Win_Xe = FB_Width;
+    FB_Win_Ye = FB_Height;
+    FB_Cur_X = FB_Cur_Y = 0;
+
+    FB_On = true;
+}
+
+/******************************************************************************
+function:	Turn drawing into the framebuffer on or off
+note:
+	Turning it off flushes first. While it is off the panel and the
+	framebuffer drift apart, call FB_Init again before turning it back on
+	if anything was drawn directly.
+******************************************************************************/
+void FB_Enable(bool Enable)
+{
+    if(!Enable) {
+        FB_Flush();
+        FB_Pipeline_Wait();
+    }
+    FB_On = Enable;
+}
+
+/******************************************************************************
+function:	Whether LCD drawing should go to the framebuffer
+******************************************************************************/
+bool FB_Active(void)
+{
+    //The consumer draws the flushes themselves
+    if(FB_Pipe_On && get_core_num() == FB_Pipe_Core)
+        return false;
+    return FB_On && !FB_Flushing;
+}
+
+/******************************************************************************
+function:	Set the window the next pixels go into
+note:
+	Same rules as LCD_SetWindow: the end is exclusive, and an empty window
+	still takes one column or row like the controller does
+******************************************************************************/
+void FB_SetWindow(POINT Xstart, POINT Ystart, POINT Xend, POINT Yend)
+{
+    FB_Win_Xs = Xstart;
+    FB_Win_Ys = Ystart;
+    FB_Win_Xe = Xend > Xstart ? Xend : Xstart + 1;
+    FB_Win_Ye = Yend > Ystart ? Yend : Ystart + 1;
+    FB_Cur_X = Xstart;
+    FB_Cur_Y = Ystart;
+}
+
+/******************************************************************************
+function:	Write one palette index over a run of the current window row
+parameter:
+	Index :   Palette index
+	Num   :   Pixels, no more than are left in the row
+******************************************************************************/
+static void FB_Put_Run(uint8_t Index, uint32_t Num)
+{
+    POINT X = FB_Cur_X, Xend = FB_Cur_X + Num;
+
+    if(FB_Cur_Y < FB_Height) {
+        if(Xend > FB_Width)
+            Xend = FB_Width;
+        uint8_t *pPixel = &FB_Pixel[(uint32_t)FB_Cur_Y * FB_Width];
+        uint8_t *pDirty = &FB_Dirty[(FB_Cur_Y / FB_TILE_SIZE) * FB_Tiles_X];
+        for(; X < Xend; X++) {
+            if(pPixel[X] != Index) {
+                pPixel[X] = Index;
+                pDirty[X / FB_TILE_SIZE] = 1;
+            }
+        }
+    }
+
+    FB_Cur_X += Num;
+    if(FB_Cur_X >= FB_Win_Xe) {
+        FB_Cur_X = FB_Win_Xs;
+        if(++FB_Cur_Y >= FB_Win_Ye)
+            FB_Cur_Y = FB_Win_Ys;
+    }
+}
+
+/******************************************************************************
+function:	Write pixels at the current position
+parameter:
+	pPixel   :   RGB565 pixels
+	PixelNum :   Number of pixels
+******************************************************************************/
+void FB_WritePixels(const COLOR *pPixel, uint32_t PixelNum)
+{
+    while(PixelNum--)
+        FB_Put_Run(FB_Index(*pPixel++), 1);
+}
+
+/******************************************************************************
+function:	Repeat one color from the current position
+parameter:
+	Color    :   RGB565 color
+	PixelNum :   Number of pixels
+******************************************************************************/
+void FB_Fill(COLOR Color, uint32_t PixelNum)
+{
+    uint8_t Index = FB_Index(Color);
+
+    while(PixelNum) {
+        uint32_t Num = FB_Win_Xe - FB_Cur_X;
+        if(Num > PixelNum)
+            Num = PixelNum;
+        FB_Put_Run(Index, Num);
+        PixelNum -= Num;
+    }
+}
+
+/******************************************************************************
+function:	Read back pixels of one row
+parameter:
+	Xpoint   :   X coordinate of the first pixel
+	Ypoint   :   Y coordinate of the row
+	pPixel   :   Receives the RGB565 pixels
+	PixelNum :   Number of pixels, no more than are left in the row
+note:
+	Colors that did not fit the palette come back as their closest match
+******************************************************************************/
+void FB_ReadPixels(POINT Xpoint, POINT Ypoint, COLOR *pPixel, uint32_t PixelNum)
+{
+    const uint8_t *pIndex = &FB_Pixel[(uint32_t)Ypoint * FB_Width + Xpoint];
+
+    while(PixelNum--)
+        *pPixel++ = FB_Palette[*pIndex++];
+}
+
+/******************************************************************************
+function:	Compress a rectangle into runs of one color
+parameter:
+	Xstart, Ystart :   Top left corner
+	Xend, Yend     :   Bottom right corner, exclusive
+	pSpan          :   Receives the runs, NULL to only count them
+	SpanMax        :   Room in pSpan
+return:
+	Number of runs, 0 when they did not fit
+note:
+	The rectangle is read row by row and a run carries on into the next
+	row, so blank areas take next to nothing. Runs keep the color rather
+	than the palette index, they stay valid across FB_Init.
+******************************************************************************/
+uint32_t FB_SaveSpans(POINT Xstart, POINT Ystart, POINT Xend, POINT Yend,
+                      FB_SPAN *pSpan, uint32_t SpanMax)
+{
+    uint32_t Num = 0, Length = 0;
+    uint8_t Index = FB_Pixel[(uint32_t)Ystart * FB_Width + Xstart];
+    POINT X, Y;
+
+    for(Y = Ystart; Y < Yend; Y++) {
+        const uint8_t *pIndex = &FB_Pixel[(uint32_t)Y * FB_Width];
+        for(X = Xstart; X < Xend; X++) {
+            if(pIndex[X] == Index && Length < UINT16_MAX) {
+                Length++;
+                continue;
+            }
+            if(pSpan) {
+                if(Num == SpanMax)
+                    return 0;
+                pSpan[Num].Length = Length;
+                pSpan[Num].Color = FB_Palette[Index];
+            }
+            Num++;
+            Index = pIndex[X];
+            Length = 1;
+        }
+    }
+
+    if(pSpan) {
+        if(Num == SpanMax)
+            return 0;
+        pSpan[Num].Length = Length;
+        pSpan[Num].Color = FB_Palette[Index];
+    }
+    return Num + 1;
+}
+
+/******************************************************************************
+function:	Put back a rectangle saved by FB_SaveSpans
+parameter:
+	Xstart .. Yend :   The rectangle it was saved from
+	pSpan          :   The runs
+	SpanNum        :   Number of runs
+note:
+	Every pixel of the rectangle is written once, only those that change
+	mark their tiles
+******************************************************************************/
+void FB_RestoreSpans(POINT Xstart, POINT Ystart, POINT Xend, POINT Yend,
+                     const FB_SPAN *pSpan, uint32_t SpanNum)
+{
+    FB_SetWindow(Xstart, Ystart, Xend, Yend);
+    while(SpanNum--) {
+        FB_Fill(pSpan->Color, pSpan->Length);
+        pSpan++;
+    }
+}
+
+/******************************************************************************
+function:	Send a rectangle of palette indices to the panel
+parameter:
+	pIndex :   Index of the top left pixel
+	Stride :   Indices from one row to the next
+******************************************************************************/
+static void FB_Send(const uint8_t *pIndex, uint32_t Stride,
+                    POINT Xstart, POINT Ystart, POINT Xend, POINT Yend)
+{
+    POINT X, Y;
+
+    LCD_SetWindow(Xstart, Ystart, Xend, Yend);
+    for(Y = Ystart; Y < Yend; Y++) {
+        COLOR *pLine = LCD_GetLineBuf();
+        for(X = 0; X < Xend - Xstart; X++)
+            pLine[X] = FB_Palette[pIndex[X]];
+        LCD_WritePixels(pLine, Xend - Xstart);
+        pIndex += Stride;
+    }
+}
+
+/******************************************************************************
+function:	Queue a band for the consumer
+******************************************************************************/
+static void FB_Pipe_Push(const FB_BAND *pBand)
+{
+    if(!queue_try_add(&FB_Bands, pBand)) {
+        uint64_t Start = time_us_64();
+        queue_add_blocking(&FB_Bands, pBand);
+        sFB_Stats.Stall_Us += time_us_64() - Start;
+    }
+}
+
+/******************************************************************************
+function:	Copy a rectangle of the framebuffer into the ring and queue it
+note:
+	A band never wraps around the end of the ring, what is left at the end
+	is skipped when the next band does not fit there
+******************************************************************************/
+static void FB_Stage_Rect(POINT Xstart, POINT Ystart, POINT Xend, POINT Yend)
+{
+    uint32_t Width = Xend - Xstart;
+    POINT Rows = FB_BAND_BYTES / Width;
+    FB_BAND Band;
+    POINT Y;
+
+    Band.Xstart = Xstart;
+    Band.Xend = Xend;
+    Band.Start_Us = 0;
+    for(Band.Ystart = Ystart; Band.Ystart < Yend; Band.Ystart = Band.Yend) {
+        Band.Yend = MIN(Band.Ystart + Rows, Yend);
+        uint32_t Size = Width * (Band.Yend - Band.Ystart);
+
+        if(FB_Stage_Head % FB_STAGE_SIZE + Size > FB_STAGE_SIZE)
+            FB_Stage_Head += FB_STAGE_SIZE - FB_Stage_Head % FB_STAGE_SIZE;
+        if(FB_Stage_Head + Size - FB_Stage_Tail > FB_STAGE_SIZE) {
+            uint64_t Start = time_us_64();
+            while(FB_Stage_Head + Size - FB_Stage_Tail > FB_STAGE_SIZE)
+                tight_loop_contents();
+            sFB_Stats.Stall_Us += time_us_64() - Start;
+        }
+
+        uint8_t *pStage = &FB_Stage[FB_Stage_Head % FB_STAGE_SIZE];
+        for(Y = Band.Ystart; Y < Band.Yend; Y++) {
+            memcpy(pStage, &FB_Pixel[(uint32_t)Y * FB_Width + Xstart], Width);
+            pStage += Width;
+        }
+        FB_Stage_Head += Size;
+        Band.End = FB_Stage_Head;
+        FB_Pipe_Push(&Band);
+    }
+}
+
+/******************************************************************************
+function:	Send everything that changed since the last flush
+note:
+	A run of dirty tiles in one tile row is grown downwards for as long as
+	the rows below are dirty over the same columns, then sent as a single
+	window
+******************************************************************************/
+void FB_Flush(void)
+{
+    POINT Tx, Ty, Tx_End, Ty_End, i;
+    uint32_t Windows = sFB_Stats.Windows;
+
+    if(!FB_On)
+        return;
+
+    //A flush goes one way or the other as a whole
+    bool Pipe = FB_Pipe_On;
+    uint64_t Start = time_us_64();
+    FB_Flushing = true;
+    for(Ty = 0; Ty < FB_Tiles_Y; Ty++) {
+        uint8_t *pRow = &FB_Dirty[Ty * FB_Tiles_X];
+        for(Tx = 0; Tx < FB_Tiles_X; Tx++) {
+            if(!pRow[Tx])
+                continue;
+
+            Tx_End = Tx;
+            while(Tx_End < FB_Tiles_X && pRow[Tx_End])
+                Tx_End++;
+
+            Ty_End = Ty + 1;
+            while(Ty_End < FB_Tiles_Y) {
+                uint8_t *pBelow = &FB_Dirty[Ty_End * FB_Tiles_X];
+                for(i = Tx; i < Tx_End && pBelow[i]; i++);
+                if(i < Tx_End)
+                    break;
+                memset(&pBelow[Tx], 0, Tx_End - Tx);
+                Ty_End++;
+            }
+            memset(&pRow[Tx], 0, Tx_End - Tx);
+            sFB_Stats.Tiles += (uint32_t)(Tx_End - Tx) * (Ty_End - Ty);
+
+            POINT Xstart = Tx * FB_TILE_SIZE, Ystart = Ty * FB_TILE_SIZE;
+            POINT Xend = MIN(Tx_End * FB_TILE_SIZE, FB_Width), Yend = MIN(Ty_End * FB_TILE_SIZE, FB_Height);
+            if(Pipe)
+                FB_Stage_Rect(Xstart, Ystart, Xend, Yend);
+            else
+                FB_Send(&FB_Pixel[(uint32_t)Ystart * FB_Width + Xstart], FB_Width, Xstart, Ystart, Xend, Yend);
+            sFB_Stats.Windows++;
+            sFB_Stats.Pixels += (uint32_t)(Xend - Xstart) * (Yend - Ystart);
+            Tx = Tx_End - 1;
+        }
+    }
+    FB_Flushing = false;
+    sFB_Stats.Flushes++;
+
+    if(sFB_Stats.Windows == Windows)
+        return;
+    if(Pipe) {
+        //The band that closes the flush, the consumer times it when it gets there
+        FB_BAND Band = {0, 0, 0, 0, FB_Stage_Head, Start};
+        FB_Pipe_Sent++;
+        FB_Pipe_Push(&Band);
+    } else {
+        //All of it is queued on the transport, only the last lines are still going out
+        sFB_Stats.Latency_Us = time_us_64() - Start;
+        sFB_Stats.Latency_Max_Us = MAX(sFB_Stats.Latency_Max_Us, sFB_Stats.Latency_Us);
+    }
+    sFB_Stats.Hold_Us = time_us_64() - Start;
+}
+
+/******************************************************************************
+function:	Wait until the consumer has sent every flush handed to it
+note:
+	Returns right away on the consumer itself and when the pipeline is not
+	running. LCD_WaitIdle calls it, so whatever waits for the LCD to be
+	idle also waits for the pipeline.
+******************************************************************************/
+void FB_Pipeline_Wait(void)
+{
+    if(!FB_Pipe_On || get_core_num() == FB_Pipe_Core || FB_Pipe_Done == FB_Pipe_Sent)
+        return;
+    uint64_t Start = time_us_64();
+    while(FB_Pipe_Done != FB_Pipe_Sent)
+        tight_loop_contents();
+    sFB_Stats.Stall_Us += time_us_64() - Start;
+}
+
+/******************************************************************************
+function:	Be the consumer of the render pipeline
+note:
+	Call it on the core that is not drawing, it takes the LCD transport
+	over and never returns. With FB_PIPELINE off it returns right away and
+	flushes keep going out from the drawing core.
+******************************************************************************/
+void FB_Pipeline_Run(void)
+{
+#if FB_PIPELINE
+    FB_BAND Band;
+
+    queue_init(&FB_Bands, sizeof(FB_BAND), FB_BANDS_MAX);
+    LCD_ClaimTransport();
+    FB_Pipe_Core = get_core_num();
+    __dmb();
+    FB_Pipe_On = true;
+
+    for(;;) {
+        queue_remove_blocking(&FB_Bands, &Band);
+        if(Band.Xend > Band.Xstart) {
+            uint32_t Width = Band.Xend - Band.Xstart;
+            uint32_t Offset = (Band.End - Width * (Band.Yend - Band.Ystart)) % FB_STAGE_SIZE;
+            FB_Send(&FB_Stage[Offset], Width, Band.Xstart, Band.Ystart, Band.Xend, Band.Yend);
+            //Expanded into the line buffers, the ring space is free again
+            __dmb();
+            FB_Stage_Tail = Band.End;
+            continue;
+        }
+
+        LCD_WaitIdle();
+        sFB_Stats.Latency_Us = time_us_64() - Band.Start_Us;
+        sFB_Stats.Latency_Max_Us = MAX(sFB_Stats.Latency_Max_Us, sFB_Stats.Latency_Us);
+        FB_Pipe_Done++;
+    }
+#endif
+}
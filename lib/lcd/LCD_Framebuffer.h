@@ -0,0 +1,79 @@
+/*****************************************************************************
+* | File      	:	LCD_Framebuffer.h
+* | Function    :	Off-screen 8bpp palette framebuffer with dirty tiles
+* | Info        :
+*   While the framebuffer is on, LCD_SetWindow, LCD_WritePixels and the
+*   area fills draw into RAM instead of the panel. FB_Flush sends the
+*   tiles that changed since the last flush. LCD_WriteReg/LCD_WriteData
+*   (BMP display, init) still go straight to the panel. FB_ReadPixels
+*   reads back what was drawn, which the panel itself cannot do.
+*   FB_SaveSpans keeps a rectangle as color runs, FB_RestoreSpans puts it
+*   back in one pass.
+*   With FB_Pipeline_Run on the other core, FB_Flush only hands the dirty
+*   rectangles over and that core streams them to the panel.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+* | Info        :   Basic version
+*
+******************************************************************************/
+#ifndef __LCD_FRAMEBUFFER_H
+#define __LCD_FRAMEBUFFER_H
+
+#include "LCD_Driver.h"
+
+#define FB_TILE_SIZE	16		//Dirty tracking granularity in pixels
+#define FB_PALETTE_SIZE	256
+
+#ifndef FB_PIPELINE
+#define FB_PIPELINE		1		//0 keeps flushing on the drawing core, for comparison
+#endif
+#define FB_STAGE_SIZE	(32 * 1024)	//Palette indices in flight between the cores, a power of two
+#define FB_BAND_BYTES	4096		//Rectangles are handed over in bands of about this size
+#define FB_BANDS_MAX	32			//Bands in flight
+
+/********************************************************************************
+function:
+			Flush statistics
+********************************************************************************/
+typedef struct {
+	UDOUBLE Flushes;
+	UDOUBLE Tiles;		//Dirty tiles sent
+	UDOUBLE Windows;	//Windows the tiles were merged into
+	UDOUBLE Pixels;		//Pixels sent
+	UDOUBLE Hold_Us;	//How long the last flush kept the drawing core
+	UDOUBLE Latency_Us;	//From the start of the last flush until it was sent
+	UDOUBLE Latency_Max_Us;
+	UDOUBLE Stall_Us;	//Time the drawing core waited on the pipeline
+} FB_STATS;
+extern FB_STATS sFB_Stats;
+
+/********************************************************************************
+function:
+			A run of one color, see FB_SaveSpans
+********************************************************************************/
+typedef struct {
+	uint16_t Length;
+	COLOR Color;
+} FB_SPAN;
+
+void FB_Init(COLOR Color);
+void FB_Enable(bool Enable);
+bool FB_Active(void);
+void FB_Flush(void);
+void FB_ReadPixels(POINT Xpoint, POINT Ypoint, COLOR *pPixel, uint32_t PixelNum);
+uint32_t FB_SaveSpans(POINT Xstart, POINT Ystart, POINT Xend, POINT Yend,
+                      FB_SPAN *pSpan, uint32_t SpanMax);
+void FB_RestoreSpans(POINT Xstart, POINT Ystart, POINT Xend, POINT Yend,
+                     const FB_SPAN *pSpan, uint32_t SpanNum);
+
+//Render pipeline, FB_Pipeline_Run does not return while FB_PIPELINE is on
+void FB_Pipeline_Run(void);
+void FB_Pipeline_Wait(void);
+
+//Called by LCD_Driver while the framebuffer is active
+void FB_SetWindow(POINT Xstart, POINT Ystart, POINT Xend, POINT Yend);
+void FB_WritePixels(const COLOR *pPixel, uint32_t PixelNum);
+void FB_Fill(COLOR Color, uint32_t PixelNum);
+
+#endif
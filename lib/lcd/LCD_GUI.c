@@ -14,6 +14,7 @@
 *
 ******************************************************************************/
 #include "LCD_GUI.h"
+#include <string.h>
 
 extern LCD_DIS sLCD_DIS;
 extern uint8_t id;
@@ -36,6 +37,51 @@ void GUI_Clear(COLOR Color)
     LCD_Clear(Color);
 }
 
+/******************************************************************************
+function:	Fill a rectangle given in panel pixels, clipped to the screen
+parameter:
+	Xstart, Ystart :   Top left corner, may be off screen
+	Xend, Yend     :   Bottom right corner, end exclusive
+	Color          :   Set color
+note:
+	All shape drawing ends here, a horizontal span or a whole block costs
+	one window instead of one window per pixel
+******************************************************************************/
+static void GUI_FillSpan(int32_t Xstart, int32_t Ystart, int32_t Xend, int32_t Yend, COLOR Color)
+{
+    if(Xstart < 0)
+        Xstart = 0;
+    if(Ystart < 0)
+        Ystart = 0;
+    if(Xend > sLCD_DIS.LCD_Dis_Column)
+        Xend = sLCD_DIS.LCD_Dis_Column;
+    if(Yend > sLCD_DIS.LCD_Dis_Page)
+        Yend = sLCD_DIS.LCD_Dis_Page;
+    if(Xstart < Xend && Ystart < Yend)
+        LCD_SetArealColor(Xstart, Ystart, Xend, Yend, Color);
+}
+
+/******************************************************************************
+function:	Span callback that draws every point of the span
+note:
+	Same pixels GUI_DrawPoint would set for each point
+******************************************************************************/
+typedef struct {
+    COLOR Color;
+    DOT_PIXEL Dot_Pixel;
+} GUI_SPAN_FILL;
+
+static void GUI_FillSpanPoints(int32_t Xstart, int32_t Xend, int32_t Y, void *pArg)
+{
+    const GUI_SPAN_FILL *pFill = (const GUI_SPAN_FILL *)pArg;
+
+    if(pFill->Dot_Pixel == DOT_PIXEL_1X1)
+        GUI_FillSpan(Xstart - 1, Y - 1, Xend, Y, pFill->Color);
+    else
+        GUI_FillSpan(Xstart - pFill->Dot_Pixel, Y - pFill->Dot_Pixel,
+                     Xend + pFill->Dot_Pixel - 1, Y + pFill->Dot_Pixel - 1, pFill->Color);
+}
+
 /******************************************************************************
 function:	Draw Point(Xpoint, Ypoint) Fill the color
 parameter:
@@ -52,22 +98,66 @@ void GUI_DrawPoint(POINT Xpoint, POINT Ypoint, COLOR Color,
         return;
     }
 
-    uint16_t XDir_Num , YDir_Num;
+    //The whole dot is one block
     if(DOT_STYLE == DOT_STYLE_DFT) {
-        for(XDir_Num = 0; XDir_Num < 2 * Dot_Pixel - 1; XDir_Num++) {
-            for(YDir_Num = 0; YDir_Num < 2 * Dot_Pixel - 1; YDir_Num++) {
-                LCD_SetPointlColor(Xpoint + XDir_Num - Dot_Pixel, Ypoint + YDir_Num - Dot_Pixel, Color);
-            }
-        }
+        GUI_FillSpan((int32_t)Xpoint - Dot_Pixel, (int32_t)Ypoint - Dot_Pixel,
+                     (int32_t)Xpoint + Dot_Pixel - 1, (int32_t)Ypoint + Dot_Pixel - 1, Color);
     } else {
-        for(XDir_Num = 0; XDir_Num <  Dot_Pixel; XDir_Num++) {
-            for(YDir_Num = 0; YDir_Num <  Dot_Pixel; YDir_Num++) {
-                LCD_SetPointlColor(Xpoint + XDir_Num - 1, Ypoint + YDir_Num - 1, Color);
-            }
-        }
+        GUI_FillSpan((int32_t)Xpoint - 1, (int32_t)Ypoint - 1,
+                     (int32_t)Xpoint - 1 + Dot_Pixel, (int32_t)Ypoint - 1 + Dot_Pixel, Color);
     }
 }
 
+/******************************************************************************
+function:	Draw a horizontal or vertical line of single pixels
+parameter:
+	Xstart, Ystart :   Starting point, same coordinates as GUI_DrawPoint
+	Len            :   Number of pixels
+	Vertical       :   Runs down instead of right
+	Reverse        :   The line was drawn from the other end, which
+	                   decides where the dotted pattern starts
+note:
+	The line goes out through one window, dotted lines included
+******************************************************************************/
+static void GUI_DrawStraightLine(POINT Xstart, POINT Ystart, uint16_t Len, bool Vertical, bool Reverse,
+                                 COLOR Color, LINE_STYLE Line_Style)
+{
+    int32_t Xs = (int32_t)Xstart - 1, Ys = (int32_t)Ystart - 1;
+    int32_t Limit = Vertical ? sLCD_DIS.LCD_Dis_Page : sLCD_DIS.LCD_Dis_Column;
+    int32_t Start = Vertical ? Ys : Xs, End = Start + Len, Pos;
+
+    if(Line_Style != LINE_DOTTED) {
+        if(Vertical)
+            GUI_FillSpan(Xs, Ys, Xs + 1, Ys + Len, Color);
+        else
+            GUI_FillSpan(Xs, Ys, Xs + Len, Ys + 1, Color);
+        return;
+    }
+
+    //Off screen across the line, or clipped along it
+    if((Vertical ? Xs : Ys) < 0 || (Vertical ? Xs >= sLCD_DIS.LCD_Dis_Column : Ys >= sLCD_DIS.LCD_Dis_Page))
+        return;
+    if(Start < 0)
+        Start = 0;
+    if(End > Limit)
+        End = Limit;
+    if(Start >= End)
+        return;
+
+    //Every third point, counted from where the line started, is background
+    COLOR *pLine = LCD_GetLineBuf();
+    for(Pos = Start; Pos < End; Pos++) {
+        int32_t Index = Reverse ? (Vertical ? Ys : Xs) + Len - 1 - Pos : Pos - (Vertical ? Ys : Xs);
+        pLine[Pos - Start] = (Index + 1) % 3 == 0 ? LCD_BACKGROUND : Color;
+    }
+
+    if(Vertical)
+        LCD_SetWindow(Xs, Start, Xs + 1, End);
+    else
+        LCD_SetWindow(Start, Ys, End, Ys + 1);
+    LCD_WritePixels(pLine, End - Start);
+}
+
 /******************************************************************************
 function:	Draw a line of arbitrary slope
 parameter:
@@ -100,20 +190,54 @@ void GUI_DrawLine(POINT Xstart, POINT Ystart, POINT Xend, POINT Yend,
     int32_t XAddway = Xstart < Xend ? 1 : -1;
     int32_t YAddway = Ystart < Yend ? 1 : -1;
 
+    //Horizontal and vertical single pixel lines go out in one piece
+    if(Dot_Pixel == DOT_PIXEL_1X1 && (dx == 0 || dy == 0)) {
+        if(dy == 0)
+            GUI_DrawStraightLine(MIN(Xstart, Xend), Ystart, dx + 1, false, Xstart > Xend, Color, Line_Style);
+        else
+            GUI_DrawStraightLine(Xstart, MIN(Ystart, Yend), 1 - dy, true, Ystart > Yend, Color, Line_Style);
+        return;
+    }
+
     //Cumulative error
     int32_t Esp = dx + dy;
     int8_t Line_Style_Temp = 0;
 
+    //Single pixels that continue along the major axis in one color are
+    //collected into a run and drawn as one span
+    bool XMajor = dx >= -dy;
+    int32_t Run_Xs = 0, Run_Ys = 0, Run_Xe = 0, Run_Ye = 0;
+    COLOR Run_Color = 0;
+    bool Run = false;
+
     for(;;) {
+        COLOR Point_Color = Color;
         Line_Style_Temp++;
         //Painted dotted line, 2 point is really virtual
         if(Line_Style == LINE_DOTTED && Line_Style_Temp % 3 == 0) {
             //DEBUG("LINE_DOTTED\r\n");
-            GUI_DrawPoint(Xpoint, Ypoint, LCD_BACKGROUND, Dot_Pixel, DOT_STYLE_DFT);
+            Point_Color = LCD_BACKGROUND;
             Line_Style_Temp = 0;
+        }
+
+        if(Dot_Pixel != DOT_PIXEL_1X1) {
+            GUI_DrawPoint(Xpoint, Ypoint, Point_Color, Dot_Pixel, DOT_STYLE_DFT);
+        } else if(Run && Point_Color == Run_Color &&
+                  (XMajor ? (Ypoint == Run_Ys && ((int32_t)Xpoint == Run_Xs - 1 || (int32_t)Xpoint == Run_Xe + 1))
+                          : (Xpoint == Run_Xs && ((int32_t)Ypoint == Run_Ys - 1 || (int32_t)Ypoint == Run_Ye + 1)))) {
+            Run_Xs = MIN(Run_Xs, (int32_t)Xpoint);
+            Run_Xe = MAX(Run_Xe, (int32_t)Xpoint);
+            Run_Ys = MIN(Run_Ys, (int32_t)Ypoint);
+            Run_Ye = MAX(Run_Ye, (int32_t)Ypoint);
         } else {
-            GUI_DrawPoint(Xpoint, Ypoint, Color, Dot_Pixel, DOT_STYLE_DFT);
+            if(Run)
+                GUI_FillSpan(Run_Xs - 1, Run_Ys - 1, Run_Xe, Run_Ye, Run_Color);
+            Run_Xs = Run_Xe = Xpoint;
+            Run_Ys = Run_Ye = Ypoint;
+            Run_Color = Point_Color;
+            Run = true;
         }
+
         if(2 * Esp >= dy) {
             if(Xpoint == Xend) break;
             Esp += dy;
@@ -125,6 +249,9 @@ void GUI_DrawLine(POINT Xstart, POINT Ystart, POINT Xend, POINT Yend,
             Ypoint += YAddway;
         }
     }
+
+    if(Run)
+        GUI_FillSpan(Run_Xs - 1, Run_Ys - 1, Run_Xe, Run_Ye, Run_Color);
 }
 
 /******************************************************************************
@@ -195,34 +322,60 @@ void GUI_DrawTriangle(POINT x0, POINT y0, POINT x1, POINT y1, POINT x2, POINT y2
         return;
     }
 
+    GUI_SPAN_FILL Fill = { Color, Dot_Pixel };
+    GUI_TriangleSpans(x0, y0, x1, y1, x2, y2, GUI_FillSpanPoints, &Fill);
+}
+
+/******************************************************************************
+function:	The spans that make up a filled triangle
+parameter:
+	x0, y0, x1, y1, x2, y2 : Triangle vertex coordinates, either winding
+	Func                   : Called once per row with the points inside
+	pArg                   : Passed on to Func
+******************************************************************************/
+void GUI_TriangleSpans(int x0, int y0, int x1, int y1, int x2, int y2,
+                       GUI_SPAN_FUNC Func, void *pArg)
+{
     // Bounding box
     int minX = MIN(x0, MIN(x1, x2));
     int maxX = MAX(x0, MAX(x1, x2));
     int minY = MIN(y0, MIN(y1, y2));
     int maxY = MAX(y0, MAX(y1, y2));
 
-    // Compute edge functions
-    int dx01 = x1 - x0, dy01 = y1 - y0;
-    int dx12 = x2 - x1, dy12 = y2 - y1;
-    int dx20 = x0 - x2, dy20 = y0 - y2;
+    // Edges as (start point, direction), a point is inside when the edge
+    // function (x - xa) * dy - (y - ya) * dx is >= 0 for all three
+    int ex[3] = { x1, x2, x0 }, ey[3] = { y1, y2, y0 };
+    int edx[3] = { x2 - x1, x0 - x2, x1 - x0 }, edy[3] = { y2 - y1, y0 - y2, y1 - y0 };
+
+    // Either winding, flip the edges of a counter-clockwise triangle
+    if (edx[2] * (y2 - y0) - edy[2] * (x2 - x0) > 0) {
+        for (int i = 0; i < 3; i++) {
+            edx[i] = -edx[i];
+            edy[i] = -edy[i];
+        }
+    }
 
+    // Each edge bounds x from one side on a row, what is left is one span
     for (int y = minY; y <= maxY; y++) {
-        for (int x = minX; x <= maxX; x++) {
-            // Edge functions
-            int w0 = (x - x1) * dy12 - (y - y1) * dx12;
-            int w1 = (x - x2) * dy20 - (y - y2) * dx20;
-            int w2 = (x - x0) * dy01 - (y - y0) * dx01;
-
-            // Check if inside triangle (assuming counter-clockwise winding)
-            if (w0 >= 0 && w1 >= 0 && w2 >= 0) {
-                GUI_DrawPoint(x, y, Color, Dot_Pixel, DOT_STYLE_DFT);
+        int left = minX, right = maxX;
+        for (int i = 0; i < 3 && left <= right; i++) {
+            int k = ex[i] * edy[i] + (y - ey[i]) * edx[i];  // Inside where x * dy >= k
+            if (edy[i] > 0) {
+                int bound = k / edy[i] + (k % edy[i] > 0);  // ceil
+                left = MAX(left, bound);
+            } else if (edy[i] < 0) {
+                int bound = k / edy[i] - (k % edy[i] > 0);  // floor, k / dy with dy < 0
+                right = MIN(right, bound);
+            } else if (k > 0) {
+                right = left - 1;
             }
         }
+        if (left <= right) {
+            Func(left, right, y, pArg);
+        }
     }
 }
 
-
-
 /******************************************************************************
 function:	Use the 8-point method to draw a circle of the
 				specified size at the specified position.
@@ -249,27 +402,9 @@ void GUI_DrawCircle(POINT X_Center, POINT Y_Center, LENGTH Radius,
     //Cumulative error,judge the next point of the logo
     int16_t Esp = 3 - (Radius << 1 );
 
-    int16_t sCountY;
     if(Draw_Fill == DRAW_FULL) {
-        while(XCurrent <= YCurrent ) { //Realistic circles
-            for(sCountY = XCurrent; sCountY <= YCurrent; sCountY ++ ) {
-                GUI_DrawPoint(X_Center + XCurrent, Y_Center + sCountY, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT );//1
-                GUI_DrawPoint(X_Center - XCurrent, Y_Center + sCountY, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT );//2
-                GUI_DrawPoint(X_Center - sCountY, Y_Center + XCurrent, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT );//3
-                GUI_DrawPoint(X_Center - sCountY, Y_Center - XCurrent, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT );//4
-                GUI_DrawPoint(X_Center - XCurrent, Y_Center - sCountY, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT );//5
-                GUI_DrawPoint(X_Center + XCurrent, Y_Center - sCountY, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT );//6
-                GUI_DrawPoint(X_Center + sCountY, Y_Center - XCurrent, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT );//7
-                GUI_DrawPoint(X_Center + sCountY, Y_Center + XCurrent, Color, DOT_PIXEL_DFT, DOT_STYLE_DFT );
-            }
-            if(Esp < 0 )
-                Esp += 4 * XCurrent + 6;
-            else {
-                Esp += 10 + 4 * (XCurrent - YCurrent );
-                YCurrent --;
-            }
-            XCurrent ++;
-        }
+        GUI_SPAN_FILL Fill = { Color, DOT_PIXEL_DFT };
+        GUI_CircleSpans(X_Center, Y_Center, Radius, GUI_FillSpanPoints, &Fill);
     } else { //Draw a hollow circle
         while(XCurrent <= YCurrent ) {
             GUI_DrawPoint(X_Center + XCurrent, Y_Center + YCurrent, Color, Dot_Pixel, DOT_STYLE_DFT );//1
@@ -292,6 +427,168 @@ void GUI_DrawCircle(POINT X_Center, POINT Y_Center, LENGTH Radius,
     }
 }
 
+/******************************************************************************
+function:	The spans that make up a filled circle
+parameter:
+	X_Center  ：Center X coordinate
+	Y_Center  ：Center Y coordinate
+	Radius    ：circle Radius
+	Func      : Called once per row with the points inside
+	pArg      : Passed on to Func
+note:
+	The same points the 8-point method fills, one span per row
+******************************************************************************/
+void GUI_CircleSpans(int X_Center, int Y_Center, LENGTH Radius, GUI_SPAN_FUNC Func, void *pArg)
+{
+    int16_t XCurrent = 0, YCurrent = Radius;
+    int16_t Esp = 3 - (Radius << 1 );
+
+    while(XCurrent <= YCurrent ) {
+        //Rows XCurrent above and below the center reach out to YCurrent
+        Func(X_Center - YCurrent, X_Center + YCurrent, Y_Center + XCurrent, pArg);
+        if(XCurrent > 0)
+            Func(X_Center - YCurrent, X_Center + YCurrent, Y_Center - XCurrent, pArg);
+
+        //Rows YCurrent away reach out to the last XCurrent before YCurrent steps in
+        if(YCurrent > XCurrent && (Esp >= 0 || XCurrent + 1 > YCurrent)) {
+            Func(X_Center - XCurrent, X_Center + XCurrent, Y_Center + YCurrent, pArg);
+            Func(X_Center - XCurrent, X_Center + XCurrent, Y_Center - YCurrent, pArg);
+        }
+
+        if(Esp < 0 )
+            Esp += 4 * XCurrent + 6;
+        else {
+            Esp += 10 + 4 * (XCurrent - YCurrent );
+            YCurrent --;
+        }
+        XCurrent ++;
+    }
+}
+
+/******************************************************************************
+function:	Show a run of characters of a span font
+parameter:
+	Xs, Ys           ：Top left pixel of the run, may be off screen
+	Win_Xs ... Win_Ye：The visible part of the run, end exclusive
+	Other parameters as GUI_DisCharRun
+note:
+	Each glyph keeps a pointer to its next row of spans, rows above the
+	screen are stepped over without drawing
+******************************************************************************/
+#define GUI_SPAN_RUN_MAX	32
+static void GUI_DisSpanRun(int32_t Xs, int32_t Ys, const char *pString, uint16_t Len,
+                           sFONT* Font, int32_t Win_Xs, int32_t Win_Ys, int32_t Win_Xe, int32_t Win_Ye,
+                           COLOR Color_Background, COLOR Color_Foreground)
+{
+    const sFONT_SPANS *Spans = Font->Spans;
+    const uint8_t *pRow[GUI_SPAN_RUN_MAX];
+    uint16_t Num, Span;
+    int32_t Page, X;
+
+    if(Len > GUI_SPAN_RUN_MAX)
+        Len = GUI_SPAN_RUN_MAX;
+    if(Win_Xe > Xs + (int32_t)Len * Font->Width)
+        Win_Xe = Xs + (int32_t)Len * Font->Width;
+
+    for(Num = 0; Num < Len; Num++) {
+        const char *pChar = pString[Num] ? strchr(Spans->Chars, pString[Num]) : NULL;
+        pRow[Num] = pChar ? &Spans->Data[Spans->Offset[pChar - Spans->Chars]] : NULL;
+        for(Page = Ys; pRow[Num] && Page < Win_Ys; Page++)
+            pRow[Num] += 1 + 2 * pRow[Num][0];
+    }
+
+    LCD_SetWindow(Win_Xs, Win_Ys, Win_Xe, Win_Ye);
+
+    for(Page = Win_Ys; Page < Win_Ye; Page++) {
+        COLOR *pLine = LCD_GetLineBuf();
+        for(X = 0; X < Win_Xe - Win_Xs; X++)
+            pLine[X] = Color_Background;
+
+        for(Num = 0; Num < Len; Num++) {
+            const uint8_t *p = pRow[Num];
+            if(!p)
+                continue;
+            int32_t Xchar = Xs + (int32_t)Num * Font->Width - Win_Xs;
+            for(Span = 0; Span < p[0]; Span++) {
+                int32_t Start = Xchar + p[1 + 2 * Span], End = Xchar + p[2 + 2 * Span];
+                if(Start < 0)
+                    Start = 0;
+                if(End > Win_Xe - Win_Xs)
+                    End = Win_Xe - Win_Xs;
+                for(X = Start; X < End; X++)
+                    pLine[X] = Color_Foreground;
+            }
+            pRow[Num] = p + 1 + 2 * p[0];
+        }
+        LCD_WritePixels(pLine, Win_Xe - Win_Xs);
+    }
+}
+
+/******************************************************************************
+function:	Show a run of English characters on one line
+parameter:
+	Xpoint           ：X coordinate of the first character
+	Ypoint           ：Y coordinate of the first character
+	pString          ：The first character of the run
+	Len              ：Number of characters in the run
+	Font             ：A structure pointer that displays a character size
+	Color_Background : Select the background color of the English character
+	Color_Foreground : Select the foreground color of the English character
+note:
+	The whole run is drawn through a single window. Every row of the run is
+	expanded from the 1bpp font table into a line buffer and queued for the
+	DMA, so the next row is expanded while the previous one is sent.
+	Pixels land where GUI_DrawPoint puts them, one up and one left of
+	(Xpoint + Column, Ypoint + Page), and are clipped to the screen.
+	Span fonts fill each row with the background and then the spans of
+	every glyph with the foreground, without looking at single bits.
+******************************************************************************/
+static void GUI_DisCharRun(POINT Xpoint, POINT Ypoint, const char *pString, uint16_t Len,
+                           sFONT* Font, COLOR Color_Background, COLOR Color_Foreground)
+{
+    uint16_t Row_Bytes = Font->Width / 8 + (Font->Width % 8 ? 1 : 0);
+
+    //Visible part of the run, end exclusive
+    int32_t Xs = (int32_t)Xpoint - 1, Ys = (int32_t)Ypoint - 1;
+    int32_t Xe = Xs + (int32_t)Len * Font->Width, Ye = Ys + Font->Height;
+    int32_t Win_Xs = Xs < 0 ? 0 : Xs;
+    int32_t Win_Ys = Ys < 0 ? 0 : Ys;
+    int32_t Win_Xe = Xe > sLCD_DIS.LCD_Dis_Column ? sLCD_DIS.LCD_Dis_Column : Xe;
+    int32_t Win_Ye = Ye > sLCD_DIS.LCD_Dis_Page ? sLCD_DIS.LCD_Dis_Page : Ye;
+    if(Win_Xs >= Win_Xe || Win_Ys >= Win_Ye)
+        return;
+
+    if(Font->Spans) {
+        GUI_DisSpanRun(Xs, Ys, pString, Len, Font, Win_Xs, Win_Ys, Win_Xe, Win_Ye,
+                       Color_Background, Color_Foreground);
+        return;
+    }
+
+    LCD_SetWindow(Win_Xs, Win_Ys, Win_Xe, Win_Ye);
+
+    POINT Page, Column;
+    uint16_t Num;
+    for(Page = Win_Ys - Ys; Page < Win_Ye - Ys; Page++) {
+        COLOR *pLine = LCD_GetLineBuf();
+        COLOR *pBuf = pLine;
+        int32_t Xpos = Xs;
+        for(Num = 0; Num < Len; Num++) {
+            uint32_t Char_Offset = (pString[Num] - ' ') * Font->Height * Row_Bytes;
+            const unsigned char *ptr = &Font->table[Char_Offset + Page * Row_Bytes];
+
+            for(Column = 0; Column < Font->Width; Column++, Xpos++) {
+                if(Xpos < Win_Xs || Xpos >= Win_Xe)
+                    continue;
+                if(ptr[Column / 8] & (0x80 >> (Column % 8)))
+                    *pBuf++ = Color_Foreground;
+                else
+                    *pBuf++ = Color_Background;
+            }
+        }
+        LCD_WritePixels(pLine, Win_Xe - Win_Xs);
+    }
+}
+
 /******************************************************************************
 function:	Show English characters
 parameter:
@@ -305,32 +602,12 @@ parameter:
 void GUI_DisChar(POINT Xpoint, POINT Ypoint, const char Acsii_Char,
                  sFONT* Font, COLOR Color_Background, COLOR Color_Foreground)
 {
-    POINT Page, Column;
-
     if(Xpoint > sLCD_DIS.LCD_Dis_Column || Ypoint > sLCD_DIS.LCD_Dis_Page) {
         //DEBUG("GUI_DisChar Input exceeds the normal display range\r\n");
         return;
     }
 
-    uint32_t Char_Offset = (Acsii_Char - ' ') * Font->Height * (Font->Width / 8 + (Font->Width % 8 ? 1 : 0));
-    const unsigned char *ptr = &Font->table[Char_Offset];
-
-    for(Page = 0; Page < Font->Height; Page ++ ) {
-        for(Column = 0; Column < Font->Width; Column ++ ) {
-
-            if(*ptr & (0x80 >> (Column % 8))) {
-                GUI_DrawPoint(Xpoint + Column, Ypoint + Page, Color_Foreground, DOT_PIXEL_DFT, DOT_STYLE_DFT);
-            } else {
-                GUI_DrawPoint(Xpoint + Column, Ypoint + Page, Color_Background, DOT_PIXEL_DFT, DOT_STYLE_DFT);
-            }
-
-            //One pixel is 8 bits
-            if(Column % 8 == 7)
-                ptr++;
-        }/* Write a line */
-        if(Font->Width % 8 != 0)
-            ptr++;
-    }/* Write all */
+    GUI_DisCharRun(Xpoint, Ypoint, &Acsii_Char, 1, Font, Color_Background, Color_Foreground);
 }
 
 /******************************************************************************
@@ -342,12 +619,17 @@ parameter:
 	Font             ：A structure pointer that displays a character size
 	Color_Background : Select the background color of the English character
 	Color_Foreground : Select the foreground color of the English character
+note:
+	Characters that share a line are drawn as one run
 ******************************************************************************/
 void GUI_DisString_EN(POINT Xstart, POINT Ystart, const char * pString,
                       sFONT* Font, COLOR Color_Background, COLOR Color_Foreground )
 {
     POINT Xpoint = Xstart;
     POINT Ypoint = Ystart;
+    const char *pRun = pString;
+    POINT Xrun = Xpoint, Yrun = Ypoint;
+    uint16_t Run_Len = 0;
 
     if(Xstart > sLCD_DIS.LCD_Dis_Column || Ystart > sLCD_DIS.LCD_Dis_Page) {
         //DEBUG("GUI_DisString_EN Input exceeds the normal display range\r\n");
@@ -366,7 +648,23 @@ void GUI_DisString_EN(POINT Xstart, POINT Ystart, const char * pString,
             Xpoint = Xstart;
             Ypoint = Ystart;
         }
-        GUI_DisChar(Xpoint, Ypoint, * pString, Font, Color_Background, Color_Foreground);
+
+        //A new line starts a new run
+        if(Run_Len > 0 && (Xpoint != Xrun + Run_Len * Font->Width || Ypoint != Yrun)) {
+            GUI_DisCharRun(Xrun, Yrun, pRun, Run_Len, Font, Color_Background, Color_Foreground);
+            Run_Len = 0;
+        }
+        //Span fonts draw at most GUI_SPAN_RUN_MAX characters at once
+        if(Run_Len == GUI_SPAN_RUN_MAX && Font->Spans) {
+            GUI_DisCharRun(Xrun, Yrun, pRun, Run_Len, Font, Color_Background, Color_Foreground);
+            Run_Len = 0;
+        }
+        if(Run_Len == 0) {
+            pRun = pString;
+            Xrun = Xpoint;
+            Yrun = Ypoint;
+        }
+        Run_Len++;
 
         //The next character of the address
         pString ++;
@@ -374,6 +672,9 @@ void GUI_DisString_EN(POINT Xstart, POINT Ystart, const char * pString,
         //The next word of the abscissa increases the font of the broadband
         Xpoint += Font->Width;
     }
+
+    if(Run_Len > 0)
+        GUI_DisCharRun(Xrun, Yrun, pRun, Run_Len, Font, Color_Background, Color_Foreground);
 }
 
 /******************************************************************************
@@ -492,21 +793,25 @@ void GUI_DisGrayMap(POINT Xpoint, POINT Ypoint, const unsigned char *pBmp)
  * note:
  * ******************************************************************************/
 void GUI_DrawRadialTriangle(float angle_deg, int radius, int centerX, int centerY, int color, int direction) {
-    float angle_rad = (angle_deg - 90) * M_PI / 180.0; // Adjust for 0 degrees at top
+    float angle_rad = (angle_deg - 90) * FM_DEG2RAD; // Adjust for 0 degrees at top
+    float s, c;
 
     int outerRadius = (direction == 1) ? radius + 4 : radius - 4; // Tip of arrow (outwards or inwards)
     int baseRadius  = (direction == 1) ? radius + 20 : radius - 20; // Base of arrow (outwards or inwards)
 
     // Tip point
-    int tipX = centerX + outerRadius * cos(angle_rad);
-    int tipY = centerY + outerRadius * sin(angle_rad);
+    FM_SinCos(angle_rad, &s, &c);
+    int tipX = centerX + (int)floorf(outerRadius * c);
+    int tipY = centerY + (int)floorf(outerRadius * s);
 
     // Base of the stubby arrow (wide and short)
     float baseAngleOffset = 0.1;  // Wider = bigger number
-    int baseX1 = centerX + baseRadius * cos(angle_rad + baseAngleOffset);
-    int baseY1 = centerY + baseRadius * sin(angle_rad + baseAngleOffset);
-    int baseX2 = centerX + baseRadius * cos(angle_rad - baseAngleOffset);
-    int baseY2 = centerY + baseRadius * sin(angle_rad - baseAngleOffset);
+    FM_SinCos(angle_rad + baseAngleOffset, &s, &c);
+    int baseX1 = centerX + (int)floorf(baseRadius * c);
+    int baseY1 = centerY + (int)floorf(baseRadius * s);
+    FM_SinCos(angle_rad - baseAngleOffset, &s, &c);
+    int baseX2 = centerX + (int)floorf(baseRadius * c);
+    int baseY2 = centerY + (int)floorf(baseRadius * s);
 
     // Fill in the entire arrow as a triangle
     GUI_DrawTriangle(
@@ -527,11 +832,13 @@ void GUI_DrawRadialTriangle(float angle_deg, int radius, int centerX, int center
  * ******************************************************************************/
 
 void GUI_DrawRadialCircle(float angle_deg, int size, int centerX, int centerY, int radius, int color) {
-    float angle_rad = (angle_deg - 90) * M_PI / 180.0; // Adjust for 0 degrees at top
-    
+    float angle_rad = (angle_deg - 90) * FM_DEG2RAD; // Adjust for 0 degrees at top
+    float s, c;
+
     // Calculate the center of the circle
-    int circleCenterX = centerX + radius * cos(angle_rad);
-    int circleCenterY = centerY + radius * sin(angle_rad);
+    FM_SinCos(angle_rad, &s, &c);
+    int circleCenterX = centerX + (int)floorf(radius * c);
+    int circleCenterY = centerY + (int)floorf(radius * s);
 
     // Draw the circle at the calculated position
     GUI_DrawCircle(circleCenterX, circleCenterY, size, color, DRAW_FULL, DOT_PIXEL_1X1);
@@ -800,3 +1107,37 @@ void GUI_Show(void)
 	}
 }
 
+/******************************************************************************
+function:	Time the radial pointer draws
+note:
+	Draws tack triangles and mark circles all around the dial straight to
+	the panel and prints, per kind, the CPU time, the time until the panel
+	has everything and the SPI traffic. Leaves the screen cleared.
+******************************************************************************/
+void GUI_Benchmark(void)
+{
+    uint16_t Angle, Kind;
+    const char *Name[2] = {"radial triangle", "radial circle"};
+
+    for(Kind = 0; Kind < 2; Kind++) {
+        DEV_SPI_STATS Start_Spi = sDev_SPI_Stats;
+        uint64_t Start = time_us_64();
+
+        for(Angle = 0; Angle < 360; Angle += 10) {
+            if(Kind == 0)
+                GUI_DrawRadialTriangle(Angle, 125, 160, 150, Angle > 180 ? GREEN : RED, 1);
+            else
+                GUI_DrawRadialCircle(Angle, 10, 160, 150, 145, YELLOW);
+        }
+        uint32_t Cpu_Us = time_us_64() - Start;
+        LCD_WaitIdle();
+        uint32_t Total_Us = time_us_64() - Start;
+
+        printf("GUI_Benchmark: 36 x %s: %u us CPU, %u us total, %u SPI bytes in %u transfers\r\n",
+               Name[Kind], Cpu_Us, Total_Us,
+               sDev_SPI_Stats.Bytes - Start_Spi.Bytes, sDev_SPI_Stats.Transfers - Start_Spi.Transfers);
+    }
+
+    GUI_Clear(LCD_BACKGROUND);
+    LCD_WaitIdle();
+}
@@ -21,9 +21,11 @@
 #include "LCD_Driver.h"
 #include "fonts.h"
 #include "math.h"
+#include "fastmath.h"
 
 #define LOW_Speed_Show 0
 #define HIGH_Speed_Show 1
+#define GUI_BENCHMARK 0     //Time the pointer draws once at start up
 /********************************************************************************
 function:
 			dot pixel
@@ -120,6 +122,11 @@ void GUI_DrawTriangle(POINT Xtip, POINT Ytip, POINT Xbase1, POINT Ybase1, POINT
 void GUI_DrawRadialTriangle(float angle_deg, int radius, int centerX, int centerY, int color, int direction);
 void GUI_DrawRadialCircle(float angle_deg, int size, int centerX, int centerY, int radius, int color);
 
+//Shapes as spans, Xstart to Xend inclusive on row Y in GUI_DrawPoint coordinates
+typedef void (*GUI_SPAN_FUNC)(int32_t Xstart, int32_t Xend, int32_t Y, void *pArg);
+void GUI_TriangleSpans(int x0, int y0, int x1, int y1, int x2, int y2, GUI_SPAN_FUNC Func, void *pArg);
+void GUI_CircleSpans(int X_Center, int Y_Center, LENGTH Radius, GUI_SPAN_FUNC Func, void *pArg);
+
 //pic
 void GUI_Disbitmap(POINT Xpoint, POINT Ypoint, const unsigned char *pMap, POINT Width, POINT Height);
 void GUI_DisGrayMap(POINT Xpoint, POINT Ypoint, const unsigned char *pBmp);
@@ -132,6 +139,7 @@ void GUI_Showtime(POINT Xstart, POINT Ystart, POINT Xend, POINT Yend, DEV_TIME *
 
 //show
 void GUI_Show(void);
+void GUI_Benchmark(void);
 
 #endif
 
@@ -0,0 +1,296 @@
+/*****************************************************************************
+* | File      	:	LCD_Segment.c
+* | Function    :	Scalable seven-segment numerals
+* | Info        :
+*   Every segment is a hexagon: horizontal segments narrow by one pixel
+*   per row away from their centre line, vertical ones per column, so the
+*   ends are bevelled and neighbouring segments never touch. A row of a
+*   segment is a single span, which is all the renderer works with.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+* | Info        :   Basic version
+*
+******************************************************************************/
+#include "LCD_Segment.h"
+
+extern LCD_DIS sLCD_DIS;
+
+//Segments of '0' to '9'
+static const uint8_t SEG_Digits[10] = {
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F,
+    SEG_B | SEG_C,
+    SEG_A | SEG_B | SEG_D | SEG_E | SEG_G,
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_G,
+    SEG_B | SEG_C | SEG_F | SEG_G,
+    SEG_A | SEG_C | SEG_D | SEG_F | SEG_G,
+    SEG_A | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G,
+    SEG_A | SEG_B | SEG_C,
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G,
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_F | SEG_G,
+};
+
+/********************************************************************************
+function:
+			Layout of a character cell for one height, all in cell pixels
+********************************************************************************/
+typedef struct {
+    int32_t W, H;		//Digit cell
+    int32_t Half;		//Half the segment thickness, a segment is 2 * Half + 1 thick
+    int32_t Gap;		//Space between the ends of two segments
+    int32_t Space;		//Space after every character
+    int32_t Xl, Xr;		//Centre lines of the vertical segments
+    int32_t Yt, Ym, Yb;	//Centre lines of the horizontal segments
+} SEG_GEOMETRY;
+
+static void SEG_Geometry(uint16_t Height, SEG_GEOMETRY *pGeo)
+{
+    if(Height < SEG_HEIGHT_MIN)
+        Height = SEG_HEIGHT_MIN;
+    if(Height > SEG_HEIGHT_MAX)
+        Height = SEG_HEIGHT_MAX;
+
+    pGeo->H = Height;
+    pGeo->W = Height / 2;
+    pGeo->Half = Height / 16;
+    pGeo->Gap = pGeo->Half / 4 + 1;
+    pGeo->Space = pGeo->Half + 1;
+    pGeo->Xl = pGeo->Half;
+    pGeo->Xr = pGeo->W - 1 - pGeo->Half;
+    pGeo->Yt = pGeo->Half;
+    pGeo->Ym = (pGeo->H - 1) / 2;
+    pGeo->Yb = pGeo->H - 1 - pGeo->Half;
+}
+
+/******************************************************************************
+function:	Segments of a character
+note:
+	Digits, '-', and '.' which only has the decimal point. Anything else
+	is blank.
+******************************************************************************/
+uint8_t SEG_Encode(char Char)
+{
+    if(Char >= '0' && Char <= '9')
+        return SEG_Digits[Char - '0'];
+    if(Char == '-')
+        return SEG_G;
+    if(Char == '.')
+        return SEG_DP;
+    return 0;
+}
+
+/******************************************************************************
+function:	Width of a character cell without the space after it
+******************************************************************************/
+static int32_t SEG_CellWidth(const SEG_GEOMETRY *pGeo, char Char)
+{
+    return Char == '.' ? 2 * pGeo->Half + 1 : pGeo->W;
+}
+
+/******************************************************************************
+function:	Horizontal advance of a character
+******************************************************************************/
+POINT SEG_CharWidth(char Char, uint16_t Height)
+{
+    SEG_GEOMETRY Geo;
+    SEG_Geometry(Height, &Geo);
+    return SEG_CellWidth(&Geo, Char) + Geo.Space;
+}
+
+/******************************************************************************
+function:	Horizontal advance of a string
+******************************************************************************/
+POINT SEG_StringWidth(const char *pString, uint16_t Height)
+{
+    POINT Width = 0;
+    while(*pString != '\0')
+        Width += SEG_CharWidth(*pString++, Height);
+    return Width;
+}
+
+/******************************************************************************
+function:	Bounding box of one segment, end exclusive
+******************************************************************************/
+static void SEG_Box(const SEG_GEOMETRY *pGeo, uint8_t Segment,
+                    int32_t *pXs, int32_t *pYs, int32_t *pXe, int32_t *pYe)
+{
+    int32_t Xc, Yc, Ys, Ye;
+
+    if(Segment == SEG_A || Segment == SEG_G || Segment == SEG_D) {
+        Yc = Segment == SEG_A ? pGeo->Yt : Segment == SEG_G ? pGeo->Ym : pGeo->Yb;
+        *pXs = pGeo->Xl + pGeo->Gap;
+        *pXe = pGeo->Xr - pGeo->Gap + 1;
+        *pYs = Yc - pGeo->Half;
+        *pYe = Yc + pGeo->Half + 1;
+        return;
+    }
+
+    if(Segment == SEG_DP) {
+        *pXs = 0;
+        *pXe = 2 * pGeo->Half + 1;
+        *pYs = pGeo->Yb - pGeo->Half;
+        *pYe = pGeo->Yb + pGeo->Half + 1;
+        return;
+    }
+
+    //Vertical segments, F and B in the upper half, E and C in the lower
+    Xc = (Segment == SEG_B || Segment == SEG_C) ? pGeo->Xr : pGeo->Xl;
+    if(Segment == SEG_F || Segment == SEG_B) {
+        Ys = pGeo->Yt + pGeo->Gap;
+        Ye = pGeo->Ym - pGeo->Gap;
+    } else {
+        Ys = pGeo->Ym + pGeo->Gap;
+        Ye = pGeo->Yb - pGeo->Gap;
+    }
+    *pXs = Xc - pGeo->Half;
+    *pXe = Xc + pGeo->Half + 1;
+    *pYs = Ys;
+    *pYe = Ye + 1;
+}
+
+/******************************************************************************
+function:	The span one segment covers on a cell row
+return:
+	false when the segment is not on that row
+******************************************************************************/
+static bool SEG_Span(const SEG_GEOMETRY *pGeo, uint8_t Segment, int32_t Y,
+                     int32_t *pXs, int32_t *pXe)
+{
+    int32_t Xs, Ys, Xe, Ye, D;
+
+    SEG_Box(pGeo, Segment, &Xs, &Ys, &Xe, &Ye);
+    if(Y < Ys || Y >= Ye)
+        return false;
+
+    if(Segment == SEG_DP) {
+        *pXs = Xs;
+        *pXe = Xe;
+    } else if(Segment == SEG_A || Segment == SEG_G || Segment == SEG_D) {
+        //Bevelled ends, one pixel in per row off the centre line
+        D = Y - (Ys + pGeo->Half);
+        if(D < 0)
+            D = -D;
+        *pXs = Xs + D;
+        *pXe = Xe - D;
+    } else {
+        //Bevelled ends, one pixel narrower per row from the tips
+        D = pGeo->Half;
+        if(Y - Ys < D)
+            D = Y - Ys;
+        if(Ye - 1 - Y < D)
+            D = Ye - 1 - Y;
+        *pXs = Xs + pGeo->Half - D;
+        *pXe = Xs + pGeo->Half + D + 1;
+    }
+    return *pXs < *pXe;
+}
+
+/******************************************************************************
+function:	Draw a rectangle of a character cell
+parameter:
+	Xpoint, Ypoint   : Top left corner of the cell on screen
+	Segments         : Segments that are lit
+	Xs, Ys, Xe, Ye   : The rectangle in cell pixels, end exclusive
+note:
+	Each row is evaluated against every lit segment, so a rectangle that
+	overlaps the box of a neighbouring segment still draws it correctly
+******************************************************************************/
+static void SEG_Fill(POINT Xpoint, POINT Ypoint, const SEG_GEOMETRY *pGeo, uint8_t Segments,
+                     int32_t Xs, int32_t Ys, int32_t Xe, int32_t Ye,
+                     COLOR Color_Background, COLOR Color_Foreground)
+{
+    int32_t X, Y, Span_Xs, Span_Xe;
+    uint8_t Segment;
+
+    //Clip to the screen
+    if(Xe > sLCD_DIS.LCD_Dis_Column - (int32_t)Xpoint)
+        Xe = sLCD_DIS.LCD_Dis_Column - (int32_t)Xpoint;
+    if(Ye > sLCD_DIS.LCD_Dis_Page - (int32_t)Ypoint)
+        Ye = sLCD_DIS.LCD_Dis_Page - (int32_t)Ypoint;
+    if(Xs >= Xe || Ys >= Ye)
+        return;
+
+    LCD_SetWindow(Xpoint + Xs, Ypoint + Ys, Xpoint + Xe, Ypoint + Ye);
+    for(Y = Ys; Y < Ye; Y++) {
+        COLOR *pLine = LCD_GetLineBuf();
+        for(X = 0; X < Xe - Xs; X++)
+            pLine[X] = Color_Background;
+
+        for(Segment = SEG_A; Segment; Segment <<= 1) {
+            if(!(Segments & Segment) || !SEG_Span(pGeo, Segment, Y, &Span_Xs, &Span_Xe))
+                continue;
+            if(Span_Xs < Xs)
+                Span_Xs = Xs;
+            if(Span_Xe > Xe)
+                Span_Xe = Xe;
+            for(X = Span_Xs; X < Span_Xe; X++)
+                pLine[X - Xs] = Color_Foreground;
+        }
+        LCD_WritePixels(pLine, Xe - Xs);
+    }
+}
+
+/******************************************************************************
+function:	Draw one character
+parameter:
+	Xpoint           : X coordinate of the top left corner of the cell
+	Ypoint           : Y coordinate of the top left corner of the cell
+	Height           : Digit height in pixels
+	Char             : Character, see SEG_Encode
+	Redraw           : Segments to redraw, SEG_ALL redraws the whole cell
+	                   including the space after it
+	Color_Background : Background color
+	Color_Foreground : Color of the lit segments
+note:
+	Passing the segments that differ from what the cell shows, e.g.
+	SEG_Encode(Old) ^ SEG_Encode(New), only touches those segments
+******************************************************************************/
+void SEG_DrawChar(POINT Xpoint, POINT Ypoint, uint16_t Height, char Char,
+                  uint8_t Redraw, COLOR Color_Background, COLOR Color_Foreground)
+{
+    SEG_GEOMETRY Geo;
+    uint8_t Segments = SEG_Encode(Char), Segment;
+    int32_t Xs, Ys, Xe, Ye;
+
+    SEG_Geometry(Height, &Geo);
+
+    if(Redraw == SEG_ALL) {
+        SEG_Fill(Xpoint, Ypoint, &Geo, Segments, 0, 0, SEG_CellWidth(&Geo, Char) + Geo.Space, Geo.H,
+                 Color_Background, Color_Foreground);
+        return;
+    }
+
+    //The decimal point has a cell of its own
+    Redraw &= Char == '.' ? SEG_DP : (uint8_t)~SEG_DP;
+    for(Segment = SEG_A; Segment; Segment <<= 1) {
+        if(!(Redraw & Segment))
+            continue;
+        SEG_Box(&Geo, Segment, &Xs, &Ys, &Xe, &Ye);
+        SEG_Fill(Xpoint, Ypoint, &Geo, Segments, Xs, Ys, Xe, Ye,
+                 Color_Background, Color_Foreground);
+    }
+}
+
+/******************************************************************************
+function:	Draw a string of seven-segment characters
+parameter:
+	Xstart           : X coordinate of the top left corner
+	Ystart           : Y coordinate of the top left corner
+	Height           : Digit height in pixels
+	pString          : Characters, see SEG_Encode
+	Color_Background : Background color
+	Color_Foreground : Color of the lit segments
+return:
+	Width drawn
+******************************************************************************/
+POINT SEG_DisString(POINT Xstart, POINT Ystart, uint16_t Height, const char *pString,
+                    COLOR Color_Background, COLOR Color_Foreground)
+{
+    POINT Xpoint = Xstart;
+
+    while(*pString != '\0') {
+        SEG_DrawChar(Xpoint, Ystart, Height, *pString, SEG_ALL, Color_Background, Color_Foreground);
+        Xpoint += SEG_CharWidth(*pString++, Height);
+    }
+    return Xpoint - Xstart;
+}
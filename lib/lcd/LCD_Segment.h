@@ -0,0 +1,51 @@
+/*****************************************************************************
+* | File      	:	LCD_Segment.h
+* | Function    :	Scalable seven-segment numerals
+* | Info        :
+*   Digits are built from bevelled segments computed for the requested
+*   height, so any size from SEG_HEIGHT_MIN to SEG_HEIGHT_MAX costs no
+*   font storage. Coordinates are the top left corner of the character
+*   cell, the same as LCD_SetArealColor.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+* | Info        :   Basic version
+*
+******************************************************************************/
+#ifndef __LCD_SEGMENT_H
+#define __LCD_SEGMENT_H
+
+#include "LCD_Driver.h"
+
+#define SEG_HEIGHT_MIN	20
+#define SEG_HEIGHT_MAX	300
+
+/********************************************************************************
+function:
+			Segment bits
+			 --A--
+			F     B
+			 --G--
+			E     C
+			 --D--  DP
+********************************************************************************/
+#define SEG_A	0x01
+#define SEG_B	0x02
+#define SEG_C	0x04
+#define SEG_D	0x08
+#define SEG_E	0x10
+#define SEG_F	0x20
+#define SEG_G	0x40
+#define SEG_DP	0x80
+#define SEG_ALL	0xff
+
+uint8_t SEG_Encode(char Char);
+POINT SEG_CharWidth(char Char, uint16_t Height);
+POINT SEG_StringWidth(const char *pString, uint16_t Height);
+
+void SEG_DrawChar(POINT Xpoint, POINT Ypoint, uint16_t Height, char Char,
+                  uint8_t Redraw, COLOR Color_Background, COLOR Color_Foreground);
+POINT SEG_DisString(POINT Xstart, POINT Ystart, uint16_t Height, const char *pString,
+                    COLOR Color_Background, COLOR Color_Foreground);
+
+#endif
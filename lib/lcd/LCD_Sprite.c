@@ -0,0 +1,217 @@
+/*****************************************************************************
+* | File      	:	LCD_Sprite.c
+* | Function    :	Save-under sprites built from span lists
+* | Info        :
+*   The pixels under a sprite are read back from the framebuffer, the
+*   panel cannot be read. Without the framebuffer a sprite is assumed to
+*   sit on LCD_BACKGROUND. Sprites that overlap have to be hidden in the
+*   reverse order they were shown in, and a sprite has to be hidden
+*   before anything is drawn underneath it.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+* | Info        :   Basic version
+*
+******************************************************************************/
+#include "LCD_Sprite.h"
+#include "LCD_GUI.h"
+#include "LCD_Framebuffer.h"
+#include <string.h>
+
+extern LCD_DIS sLCD_DIS;
+
+/********************************************************************************
+function:
+			State of a rasterization
+********************************************************************************/
+typedef struct {
+    SPRITE_SHAPE *pShape;
+    SPRITE_SPAN *pSpans;
+    uint16_t Span_Max;
+    bool Overflow;
+} SPRITE_RASTER;
+
+/******************************************************************************
+function:	Span callback that appends to the shape
+******************************************************************************/
+static void Sprite_AddSpan(int32_t Xstart, int32_t Xend, int32_t Y, void *pArg)
+{
+    SPRITE_RASTER *pRaster = (SPRITE_RASTER *)pArg;
+    SPRITE_SHAPE *pShape = pRaster->pShape;
+    int32_t X = Xstart - pShape->X, Row = Y - pShape->Y, Len = Xend - Xstart + 1;
+
+    if(pShape->Span_Num >= pRaster->Span_Max || X > 255 || Row > 255 || Len > 255) {
+        pRaster->Overflow = true;
+        return;
+    }
+    pRaster->pSpans[pShape->Span_Num].Y = Row;
+    pRaster->pSpans[pShape->Span_Num].X = X;
+    pRaster->pSpans[pShape->Span_Num].Len = Len;
+    pShape->Span_Num++;
+    pShape->Pixel_Num += Len;
+}
+
+/******************************************************************************
+function:	Finish a rasterization
+return:
+	Spans used, 0 when the shape does not fit
+******************************************************************************/
+static uint16_t Sprite_Finish(SPRITE_RASTER *pRaster)
+{
+    if(pRaster->Overflow || pRaster->pShape->Pixel_Num > SPRITE_UNDER_MAX) {
+        pRaster->pShape->Span_Num = 0;
+        pRaster->pShape->Pixel_Num = 0;
+    }
+    return pRaster->pShape->Span_Num;
+}
+
+/******************************************************************************
+function:	Rasterize a filled triangle
+parameter:
+	pShape                 : Shape to build
+	pSpans                 : Where its spans go
+	Span_Max               : Room in pSpans
+	x0, y0, x1, y1, x2, y2 : Vertices relative to the anchor
+return:
+	Spans used, 0 when the shape does not fit
+note:
+	Covers the pixels GUI_DrawTriangle fills when the vertices are moved
+	by the anchor
+******************************************************************************/
+uint16_t Sprite_Triangle(SPRITE_SHAPE *pShape, SPRITE_SPAN *pSpans, uint16_t Span_Max,
+                         int x0, int y0, int x1, int y1, int x2, int y2)
+{
+    SPRITE_RASTER Raster = { pShape, pSpans, Span_Max, false };
+
+    pShape->pSpans = pSpans;
+    pShape->Span_Num = 0;
+    pShape->Pixel_Num = 0;
+    pShape->X = MIN(x0, MIN(x1, x2));
+    pShape->Y = MIN(y0, MIN(y1, y2));
+    GUI_TriangleSpans(x0, y0, x1, y1, x2, y2, Sprite_AddSpan, &Raster);
+    return Sprite_Finish(&Raster);
+}
+
+/******************************************************************************
+function:	Rasterize a filled circle around the anchor
+parameter:
+	pShape   : Shape to build
+	pSpans   : Where its spans go
+	Span_Max : Room in pSpans
+	Radius   : circle Radius
+return:
+	Spans used, 0 when the shape does not fit
+note:
+	Covers the pixels GUI_DrawCircle fills when centered on the anchor
+******************************************************************************/
+uint16_t Sprite_Circle(SPRITE_SHAPE *pShape, SPRITE_SPAN *pSpans, uint16_t Span_Max,
+                       LENGTH Radius)
+{
+    SPRITE_RASTER Raster = { pShape, pSpans, Span_Max, false };
+
+    pShape->pSpans = pSpans;
+    pShape->Span_Num = 0;
+    pShape->Pixel_Num = 0;
+    pShape->X = -(int16_t)Radius;
+    pShape->Y = -(int16_t)Radius;
+    GUI_CircleSpans(0, 0, Radius, Sprite_AddSpan, &Raster);
+    return Sprite_Finish(&Raster);
+}
+
+/******************************************************************************
+function:	Where a span of a shown sprite lands on the panel
+parameter:
+	pXs, pXe : Columns, end exclusive, clipped to the screen
+	pY       : Row
+return:
+	false when the span is off screen
+******************************************************************************/
+static bool Sprite_Place(const SPRITE *pSprite, const SPRITE_SPAN *pSpan,
+                         int32_t *pXs, int32_t *pXe, int32_t *pY)
+{
+    //Anchors are in GUI_DrawPoint coordinates, one right and down of the pixel
+    int32_t Xs = pSprite->X + pSprite->pShape->X + pSpan->X - 1;
+    int32_t Xe = Xs + pSpan->Len;
+    int32_t Y = pSprite->Y + pSprite->pShape->Y + pSpan->Y - 1;
+
+    if(Y < 0 || Y >= sLCD_DIS.LCD_Dis_Page)
+        return false;
+    if(Xs < 0)
+        Xs = 0;
+    if(Xe > sLCD_DIS.LCD_Dis_Column)
+        Xe = sLCD_DIS.LCD_Dis_Column;
+    *pXs = Xs;
+    *pXe = Xe;
+    *pY = Y;
+    return Xs < Xe;
+}
+
+/******************************************************************************
+function:	Start a sprite hidden
+******************************************************************************/
+void Sprite_Init(SPRITE *pSprite)
+{
+    pSprite->pShape = NULL;
+}
+
+/******************************************************************************
+function:	Show a sprite
+parameter:
+	pSprite : Sprite, a sprite that is shown already moves
+	pShape  : Shape to show, from Sprite_Triangle or Sprite_Circle
+	X, Y    : Anchor in GUI_DrawPoint coordinates
+	Color   : Fill color
+******************************************************************************/
+void Sprite_Show(SPRITE *pSprite, const SPRITE_SHAPE *pShape, int32_t X, int32_t Y, COLOR Color)
+{
+    const SPRITE_SPAN *pSpan;
+    int32_t Xs, Xe, Row;
+    uint16_t Num, i;
+    COLOR *pUnder = pSprite->Under;
+
+    Sprite_Hide(pSprite);
+    pSprite->pShape = pShape;
+    pSprite->X = X;
+    pSprite->Y = Y;
+
+    for(i = 0, pSpan = pShape->pSpans; i < pShape->Span_Num; i++, pSpan++) {
+        if(!Sprite_Place(pSprite, pSpan, &Xs, &Xe, &Row))
+            continue;
+        Num = Xe - Xs;
+        if(FB_Active()) {
+            FB_ReadPixels(Xs, Row, pUnder, Num);
+        } else {
+            for(uint16_t n = 0; n < Num; n++)
+                pUnder[n] = LCD_BACKGROUND;
+        }
+        pUnder += Num;
+        LCD_SetArealColor(Xs, Row, Xe, Row + 1, Color);
+    }
+}
+
+/******************************************************************************
+function:	Hide a sprite, putting back what it covered
+******************************************************************************/
+void Sprite_Hide(SPRITE *pSprite)
+{
+    const SPRITE_SHAPE *pShape = pSprite->pShape;
+    const SPRITE_SPAN *pSpan;
+    int32_t Xs, Xe, Row;
+    uint16_t Num, i;
+    const COLOR *pUnder = pSprite->Under;
+
+    if(pShape == NULL)
+        return;
+
+    for(i = 0, pSpan = pShape->pSpans; i < pShape->Span_Num; i++, pSpan++) {
+        if(!Sprite_Place(pSprite, pSpan, &Xs, &Xe, &Row))
+            continue;
+        Num = Xe - Xs;
+        COLOR *pLine = LCD_GetLineBuf();
+        memcpy(pLine, pUnder, Num * sizeof(COLOR));
+        LCD_SetWindow(Xs, Row, Xe, Row + 1);
+        LCD_WritePixels(pLine, Num);
+        pUnder += Num;
+    }
+    pSprite->pShape = NULL;
+}
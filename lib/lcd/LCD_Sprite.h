@@ -0,0 +1,62 @@
+/*****************************************************************************
+* | File      	:	LCD_Sprite.h
+* | Function    :	Save-under sprites built from span lists
+* | Info        :
+*   A shape is a list of horizontal spans, rasterized once. Showing a
+*   sprite saves the pixels it covers and fills its spans, hiding it puts
+*   the saved pixels back, so moving one costs the same wherever it goes
+*   and nothing else on screen has to be redrawn.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+* | Info        :   Basic version
+*
+******************************************************************************/
+#ifndef __LCD_SPRITE_H
+#define __LCD_SPRITE_H
+
+#include "LCD_Driver.h"
+
+#define SPRITE_UNDER_MAX	512		//Pixels a sprite can save, and so cover
+
+/********************************************************************************
+function:
+			One row of a shape, relative to the top left of its bounding box
+********************************************************************************/
+typedef struct {
+    uint8_t Y;
+    uint8_t X;
+    uint8_t Len;
+} SPRITE_SPAN;
+
+/********************************************************************************
+function:
+			A rasterized shape
+********************************************************************************/
+typedef struct {
+    const SPRITE_SPAN *pSpans;
+    uint16_t Span_Num;
+    uint16_t Pixel_Num;
+    int16_t X, Y;		//Top left of the bounding box, relative to the shape anchor
+} SPRITE_SHAPE;
+
+/********************************************************************************
+function:
+			A sprite and the pixels under it
+********************************************************************************/
+typedef struct {
+    const SPRITE_SHAPE *pShape;	//Shape shown, NULL while hidden
+    int32_t X, Y;		//Anchor it is shown at
+    COLOR Under[SPRITE_UNDER_MAX];
+} SPRITE;
+
+uint16_t Sprite_Triangle(SPRITE_SHAPE *pShape, SPRITE_SPAN *pSpans, uint16_t Span_Max,
+                         int x0, int y0, int x1, int y1, int x2, int y2);
+uint16_t Sprite_Circle(SPRITE_SHAPE *pShape, SPRITE_SPAN *pSpans, uint16_t Span_Max,
+                       LENGTH Radius);
+
+void Sprite_Init(SPRITE *pSprite);
+void Sprite_Show(SPRITE *pSprite, const SPRITE_SHAPE *pShape, int32_t X, int32_t Y, COLOR Color);
+void Sprite_Hide(SPRITE *pSprite);
+
+#endif
@@ -12,127 +12,176 @@
 *
 ******************************************************************************/
 #include "LCD_Touch.h"
+#include "DEV_Bus.h"
+#include "hardware/flash.h"
+#include "hardware/irq.h"
+#include "pico/flash.h"
+#include <stddef.h>
+#include <string.h>
 
 extern LCD_DIS sLCD_DIS;
 extern uint8_t id;
 static TP_DEV sTP_DEV;
 static TP_DRAW sTP_Draw;
+TP_STATS sTP_Stats;
+
+#define TP_CMD_X		0xD0	//Channel X+, 12 bits, differential, power down between conversions
+#define TP_CMD_Y		0x90	//Channel Y+
+#define TP_BURST_LEN	(4 * TP_SAMPLES + 1)
+
+//Tracking of the touch in progress
+static volatile bool TP_Irq_Pending;	//Set by the pen interrupt, cleared by TP_Service
+static bool TP_Down;					//A touch with a valid position
+static uint32_t TP_Down_Ms;
+static uint64_t TP_Next_Us;				//When the next burst is due
+static int32_t TP_Filt_X, TP_Filt_Y;	//Smoothed ADC readings, 4 fractional bits
+
+//Calibration kept in the last flash sector
+#define TP_CAL_MAGIC			0x4C414354	//"TCAL"
+#define TP_CAL_FLASH_OFFSET		(PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+#define TP_FLASH_TIMEOUT_MS		100
+typedef struct {
+	uint32_t Magic;
+	uint8_t Scan_Dir;
+	uint8_t Lcd_Id;
+	uint16_t Reserved;
+	float fXfac;
+	float fYfac;
+	int16_t iXoff;
+	int16_t iYoff;
+	uint32_t Check;		//FNV-1a of everything before it
+} TP_CAL;
+static bool TP_Cal_Loaded;
+
 /*******************************************************************************
 function:
-		Read the ADC of the channel
-parameter:
-	Channel_Cmd :	0x90: Read channel Y +, select the ADC resolution is 12 bits, set to differential mode
-					0xd0: Read channel x +, select the ADC resolution is 12 bits, set to differential mode
+		Pen interrupt, the sampling itself is left to TP_Service
+note:
+	The pin interrupt stays off while the pen is down, the conversions
+	toggle PENIRQ
 *******************************************************************************/
-static uint16_t TP_Read_ADC(uint8_t CMD)
+static void TP_Irq_Handler(void)
 {
-    uint16_t Data = 0;
-
-    //A cycle of at least 400ns.
-    DEV_Digital_Write(TP_CS_PIN,0);
-
-    SPI4W_Write_Byte(CMD);
-    Driver_Delay_us(200);
+    if (gpio_get_irq_event_mask(TP_IRQ_PIN) & GPIO_IRQ_EDGE_FALL) {
+        gpio_acknowledge_irq(TP_IRQ_PIN, GPIO_IRQ_EDGE_FALL);
+        gpio_set_irq_enabled(TP_IRQ_PIN, GPIO_IRQ_EDGE_FALL, false);
+        TP_Irq_Pending = true;
+        sTP_Stats.Irqs++;
+    }
+}
 
-    //	dont write 0xff, it will block xpt2046  
-    //Data = SPI4W_Read_Byte(0Xff);
-    Data = SPI4W_Read_Byte(0X00);
-    Data <<= 8;//7bit
-    Data |= SPI4W_Read_Byte(0X00);
-    //Data = SPI4W_Read_Byte(0Xff);
-    Data >>= 3;//5bit
-    DEV_Digital_Write(TP_CS_PIN,1);
-    return Data;
+static void TP_Irq_Arm(void)
+{
+    gpio_acknowledge_irq(TP_IRQ_PIN, GPIO_IRQ_EDGE_FALL);
+    gpio_set_irq_enabled(TP_IRQ_PIN, GPIO_IRQ_EDGE_FALL, true);
 }
 
 /*******************************************************************************
 function:
-		Read the 5th channel value and exclude the maximum and minimum returns the average
+		Read both channels in one burst on the shared bus
 parameter:
-	Channel_Cmd :	0x90 :Read channel Y +
-					0xd0 :Read channel x +
+	pXCh_Adc :	TP_SAMPLES readings of channel X+
+	pYCh_Adc :	TP_SAMPLES readings of channel Y+
+note:
+	16 clocks per conversion: the command of the next conversion goes out
+	with the low byte of the one before. The last command leaves the ADC
+	powered down with PENIRQ enabled. The bus runs at TP_SPI_BAUDRATE
+	for the burst, about 120 us.
 *******************************************************************************/
-#define READ_TIMES  5	//Number of readings
-#define LOST_NUM    1	//Discard value
-static uint16_t TP_Read_ADC_Average(uint8_t Channel_Cmd)
+static void TP_Read_Burst(uint16_t *pXCh_Adc, uint16_t *pYCh_Adc)
 {
-    uint8_t i, j;
-    uint16_t Read_Buff[READ_TIMES];
-    uint16_t Read_Sum = 0, Read_Temp = 0;
-    //LCD SPI speed = 3 MHz
-    spi_set_baudrate(SPI_PORT,3000000);
-    //Read and save multiple samples
-    for(i = 0; i < READ_TIMES; i++){
-		Read_Buff[i] = TP_Read_ADC(Channel_Cmd);
-		Driver_Delay_us(200);
-	}
-    //LCD SPI speed = 18 MHz
-    spi_set_baudrate(SPI_PORT,15000000);
-    //Sort from small to large
-    for (i = 0; i < READ_TIMES  -  1; i ++) {
-        for (j = i + 1; j < READ_TIMES; j ++) {
-            if (Read_Buff[i] > Read_Buff[j]) {
-                Read_Temp = Read_Buff[i];
-                Read_Buff[i] = Read_Buff[j];
-                Read_Buff[j] = Read_Temp;
-            }
-        }
+    uint8_t Tx[TP_BURST_LEN], Rx[TP_BURST_LEN];
+    uint64_t Start_Us = time_us_64();
+    uint8_t i;
+
+    memset(Tx, 0, sizeof(Tx));
+    for (i = 0; i < 2 * TP_SAMPLES; i++)
+        Tx[2 * i] = i < TP_SAMPLES ? TP_CMD_X : TP_CMD_Y;
+
+    DEV_Bus_Acquire(DEV_BUS_TP);
+    DEV_Digital_Write(TP_CS_PIN, 0);
+    SPI4W_Transfer_nByte(Tx, Rx, TP_BURST_LEN);
+    DEV_Digital_Write(TP_CS_PIN, 1);
+    DEV_Bus_Release(DEV_BUS_TP);
+
+    //Each reading is 12 bits after a busy bit, left aligned in 16 clocks
+    for (i = 0; i < TP_SAMPLES; i++) {
+        pXCh_Adc[i] = ((Rx[2 * i + 1] << 8) | Rx[2 * i + 2]) >> 3;
+        pYCh_Adc[i] = ((Rx[2 * (i + TP_SAMPLES) + 1] << 8) | Rx[2 * (i + TP_SAMPLES) + 2]) >> 3;
     }
 
-    //Exclude the largest and the smallest
-    for (i = LOST_NUM; i < READ_TIMES - LOST_NUM; i ++)
-        Read_Sum += Read_Buff[i];
+    sTP_Stats.Bursts++;
+    sTP_Stats.Bus_Us += time_us_64() - Start_Us;
+}
 
-    //Averaging
-    Read_Temp = Read_Sum / (READ_TIMES - 2 * LOST_NUM);
+/*******************************************************************************
+function:
+		Median of one channel's readings
+note:
+	Fails when the middle readings spread more than TP_SPREAD_MAX, or at the
+	ends of the range: the pen is lifting or was not down hard enough
+*******************************************************************************/
+static bool TP_Median(uint16_t *pAdc, uint16_t *pMedian)
+{
+    uint16_t Temp;
+    int8_t i, j;
+
+    //Insertion sort, TP_SAMPLES is small
+    for (i = 1; i < TP_SAMPLES; i++) {
+        Temp = pAdc[i];
+        for (j = i - 1; j >= 0 && pAdc[j] > Temp; j--)
+            pAdc[j + 1] = pAdc[j];
+        pAdc[j + 1] = Temp;
+    }
 
-    return Read_Temp;
+    if (pAdc[TP_SAMPLES - 2] - pAdc[1] > TP_SPREAD_MAX)
+        return false;
+    *pMedian = pAdc[TP_SAMPLES / 2];
+    return *pMedian > 0 && *pMedian < 4095;
 }
 
 /*******************************************************************************
 function:
 		Read X channel and Y channel AD value
-parameter:
-	Channel_Cmd :	0x90 :Read channel Y +
-					0xd0 :Read channel x +
 *******************************************************************************/
-static void TP_Read_ADC_XY(uint16_t *pXCh_Adc, uint16_t  *pYCh_Adc )
+static bool TP_Read_ADC_XY(uint16_t *pXCh_Adc, uint16_t *pYCh_Adc)
 {
-    *pXCh_Adc = TP_Read_ADC_Average(0xD0);
-    *pYCh_Adc = TP_Read_ADC_Average(0x90);
+    uint16_t XCh_Adc[TP_SAMPLES], YCh_Adc[TP_SAMPLES];
+
+    TP_Read_Burst(XCh_Adc, YCh_Adc);
+    if (TP_Median(XCh_Adc, pXCh_Adc) && TP_Median(YCh_Adc, pYCh_Adc))
+        return true;
+
+    sTP_Stats.Rejected++;
+    return false;
 }
 
 /*******************************************************************************
 function:
-		2 times to read the touch screen IC, and the two can not exceed the deviation,
-		ERR_RANGE, meet the conditions, then that the correct reading, otherwise the reading error.
-parameter:
-	Channel_Cmd :	pYCh_Adc = 0x90 :Read channel Y +
-					pXCh_Adc = 0xd0 :Read channel x +
+		Converts AD values to screen coordinates, clamped to the screen
 *******************************************************************************/
-#define ERR_RANGE 50	//tolerance scope
-static bool TP_Read_TwiceADC(uint16_t *pXCh_Adc, uint16_t  *pYCh_Adc )
+static void TP_ToScreen(float Xad, float Yad, POINT *pXpoint, POINT *pYpoint)
 {
-    uint16_t XCh_Adc1, YCh_Adc1, XCh_Adc2, YCh_Adc2;
-
-    //Read the ADC values Read the ADC values twice
-    TP_Read_ADC_XY(&XCh_Adc1, &YCh_Adc1);
-	Driver_Delay_us(10);
-    TP_Read_ADC_XY(&XCh_Adc2, &YCh_Adc2);
-	Driver_Delay_us(10);
-	
-    //The ADC error used twice is greater than ERR_RANGE to take the average
-    if( ((XCh_Adc2 <= XCh_Adc1 && XCh_Adc1 < XCh_Adc2 + ERR_RANGE) ||
-         (XCh_Adc1 <= XCh_Adc2 && XCh_Adc2 < XCh_Adc1 + ERR_RANGE))
-        && ((YCh_Adc2 <= YCh_Adc1 && YCh_Adc1 < YCh_Adc2 + ERR_RANGE) ||
-            (YCh_Adc1 <= YCh_Adc2 && YCh_Adc2 < YCh_Adc1 + ERR_RANGE))) {
-        *pXCh_Adc = (XCh_Adc1 + XCh_Adc2) / 2;
-        *pYCh_Adc = (YCh_Adc1 + YCh_Adc2) / 2;
-        return true;
+    float X, Y;
+
+    if(sTP_DEV.TP_Scan_Dir == R2L_D2U) {
+        X = sTP_DEV.fXfac * Xad + sTP_DEV.iXoff;
+        Y = sTP_DEV.fYfac * Yad + sTP_DEV.iYoff;
+    } else if(sTP_DEV.TP_Scan_Dir == L2R_U2D) {
+        X = sLCD_DIS.LCD_Dis_Column - sTP_DEV.fXfac * Xad - sTP_DEV.iXoff;
+        Y = sLCD_DIS.LCD_Dis_Page - sTP_DEV.fYfac * Yad - sTP_DEV.iYoff;
+    } else if(sTP_DEV.TP_Scan_Dir == U2D_R2L) {
+        X = sTP_DEV.fXfac * Yad + sTP_DEV.iXoff;
+        Y = sTP_DEV.fYfac * Xad + sTP_DEV.iYoff;
+    } else {
+        X = sLCD_DIS.LCD_Dis_Column - sTP_DEV.fXfac * Yad - sTP_DEV.iXoff;
+        Y = sLCD_DIS.LCD_Dis_Page - sTP_DEV.fYfac * Xad - sTP_DEV.iYoff;
     }
 
-    //The ADC error used twice is less than ERR_RANGE returns failed
-    return false;
+    X = X < 0 ? 0 : X > sLCD_DIS.LCD_Dis_Column - 1 ? sLCD_DIS.LCD_Dis_Column - 1 : X;
+    Y = Y < 0 ? 0 : Y > sLCD_DIS.LCD_Dis_Page - 1 ? sLCD_DIS.LCD_Dis_Page - 1 : Y;
+    *pXpoint = X + 0.5f;
+    *pYpoint = Y + 0.5f;
 }
 
 /*******************************************************************************
@@ -142,74 +191,27 @@ parameter:
 		chCoordType:
 					1 : calibration
 					0 : relative position
+note:
+	Polls the pen, for the modal screens (calibration, draw board). The
+	GUI takes its touches from TP_Service.
 *******************************************************************************/
 static uint8_t TP_Scan(uint8_t chCoordType)
 {
-    
+    uint16_t XCh_Adc, YCh_Adc;
+
     //In X, Y coordinate measurement, IRQ is disabled and output is low
     if (!DEV_Digital_Read(TP_IRQ_PIN)) {//Press the button to press
+        //A noisy burst is not a press yet
+        if (!TP_Read_ADC_XY(&XCh_Adc, &YCh_Adc))
+            return (sTP_DEV.chStatus & TP_PRESS_DOWN);
+
         //Read the physical coordinates
-        if (chCoordType) {
-            TP_Read_TwiceADC(&sTP_DEV.Xpoint, &sTP_DEV.Ypoint);
-            //Read the screen coordinates
-        } else if (TP_Read_TwiceADC(&sTP_DEV.Xpoint, &sTP_DEV.Ypoint)) {
-			if(LCD_2_8==id){
-
-				if(sTP_DEV.TP_Scan_Dir == R2L_D2U) {		//Converts the result to screen coordinates
-					sTP_Draw.Xpoint = sTP_DEV.fXfac * sTP_DEV.Xpoint +
-									  sTP_DEV.iXoff;
-					sTP_Draw.Ypoint = sTP_DEV.fYfac * sTP_DEV.Ypoint +
-									  sTP_DEV.iYoff;
-				} else if(sTP_DEV.TP_Scan_Dir == L2R_U2D) {
-					sTP_Draw.Xpoint = sLCD_DIS.LCD_Dis_Column -
-									  sTP_DEV.fXfac * sTP_DEV.Xpoint -
-									  sTP_DEV.iXoff;
-					sTP_Draw.Ypoint = sLCD_DIS.LCD_Dis_Page -
-									  sTP_DEV.fYfac * sTP_DEV.Ypoint -
-									  sTP_DEV.iYoff;
-				} else if(sTP_DEV.TP_Scan_Dir == U2D_R2L) {
-					sTP_Draw.Xpoint = sTP_DEV.fXfac * sTP_DEV.Ypoint +
-									  sTP_DEV.iXoff;
-					sTP_Draw.Ypoint = sTP_DEV.fYfac * sTP_DEV.Xpoint +
-									  sTP_DEV.iYoff;
-				} else {
-					sTP_Draw.Xpoint = sLCD_DIS.LCD_Dis_Column -
-									  sTP_DEV.fXfac * sTP_DEV.Ypoint -
-									  sTP_DEV.iXoff;
-					sTP_Draw.Ypoint = sLCD_DIS.LCD_Dis_Page -
-									  sTP_DEV.fYfac * sTP_DEV.Xpoint -
-									  sTP_DEV.iYoff;
-				}
-			}else{
-				//DEBUG("(Xad,Yad) = %d,%d\r\n",sTP_DEV.Xpoint,sTP_DEV.Ypoint);
-				if(sTP_DEV.TP_Scan_Dir == R2L_D2U) {		//Converts the result to screen coordinates
-					sTP_Draw.Xpoint = sTP_DEV.fXfac * sTP_DEV.Xpoint +
-									  sTP_DEV.iXoff;
-					sTP_Draw.Ypoint = sTP_DEV.fYfac * sTP_DEV.Ypoint +
-									  sTP_DEV.iYoff;
-				} else if(sTP_DEV.TP_Scan_Dir == L2R_U2D) {
-					sTP_Draw.Xpoint = sLCD_DIS.LCD_Dis_Column -
-									  sTP_DEV.fXfac * sTP_DEV.Xpoint -
-									  sTP_DEV.iXoff;
-					sTP_Draw.Ypoint = sLCD_DIS.LCD_Dis_Page -
-									  sTP_DEV.fYfac * sTP_DEV.Ypoint -
-									  sTP_DEV.iYoff;
-				} else if(sTP_DEV.TP_Scan_Dir == U2D_R2L) {
-					sTP_Draw.Xpoint = sTP_DEV.fXfac * sTP_DEV.Ypoint +
-									  sTP_DEV.iXoff;
-					sTP_Draw.Ypoint = sTP_DEV.fYfac * sTP_DEV.Xpoint +
-									  sTP_DEV.iYoff;
-				} else {
-					sTP_Draw.Xpoint = sLCD_DIS.LCD_Dis_Column -
-									  sTP_DEV.fXfac * sTP_DEV.Ypoint -
-									  sTP_DEV.iXoff;
-					sTP_Draw.Ypoint = sLCD_DIS.LCD_Dis_Page -
-									  sTP_DEV.fYfac * sTP_DEV.Xpoint -
-									  sTP_DEV.iYoff;
-				}
-				// DEBUG("( x , y ) = %d,%d\r\n",sTP_Draw.Xpoint,sTP_Draw.Ypoint);
-			}
-		}
+        sTP_DEV.Xpoint = XCh_Adc;
+        sTP_DEV.Ypoint = YCh_Adc;
+        //Read the screen coordinates
+        if (!chCoordType)
+            TP_ToScreen(XCh_Adc, YCh_Adc, &sTP_Draw.Xpoint, &sTP_Draw.Ypoint);
+
         if (0 == (sTP_DEV.chStatus & TP_PRESS_DOWN)) {	//Not being pressed
             sTP_DEV.chStatus = TP_PRESS_DOWN | TP_PRESSED;
             sTP_DEV.Xpoint0 = sTP_DEV.Xpoint;
@@ -229,6 +231,129 @@ static uint8_t TP_Scan(uint8_t chCoordType)
     return (sTP_DEV.chStatus & TP_PRESS_DOWN);
 }
 
+/*******************************************************************************
+function:
+		Sample the touch in progress and report what it did
+parameter:
+	pEvent :	Filled in when true is returned
+note:
+	Call from the main loop. Until the pen interrupt fires this is a flag
+	test. While the pen is down one burst is taken every TP_SAMPLE_US; the
+	per-burst medians go through a first order IIR filter, the position is
+	reported in screen coordinates with every event.
+*******************************************************************************/
+bool TP_Service(TP_EVENT *pEvent)
+{
+    uint16_t XCh_Adc, YCh_Adc;
+    uint64_t Now_Us;
+
+    if (!TP_Down && !TP_Irq_Pending)
+        return false;
+
+    Now_Us = time_us_64();
+    if (Now_Us < TP_Next_Us)
+        return false;
+    TP_Next_Us = Now_Us + TP_SAMPLE_US;
+
+    //The pen came up, the last position of the touch goes with the release
+    if (DEV_Digital_Read(TP_IRQ_PIN)) {
+        TP_Irq_Pending = false;
+        TP_Irq_Arm();
+        if (!TP_Down)
+            return false;
+        TP_Down = false;
+        pEvent->Type = TP_EVENT_UP;
+    } else {
+        if (!TP_Read_ADC_XY(&XCh_Adc, &YCh_Adc))
+            return false;
+
+        if (!TP_Down) {
+            TP_Filt_X = XCh_Adc << 4;
+            TP_Filt_Y = YCh_Adc << 4;
+            TP_Down = true;
+            TP_Down_Ms = to_ms_since_boot(get_absolute_time());
+            TP_Irq_Pending = false;
+            pEvent->Type = TP_EVENT_DOWN;
+        } else {
+            TP_Filt_X += ((XCh_Adc << 4) - TP_Filt_X) / TP_IIR_WEIGHT;
+            TP_Filt_Y += ((YCh_Adc << 4) - TP_Filt_Y) / TP_IIR_WEIGHT;
+            pEvent->Type = TP_EVENT_MOVE;
+        }
+    }
+
+    TP_ToScreen(TP_Filt_X / 16.0f, TP_Filt_Y / 16.0f, &pEvent->Xpoint, &pEvent->Ypoint);
+    pEvent->Held_Ms = to_ms_since_boot(get_absolute_time()) - TP_Down_Ms;
+    return true;
+}
+
+/*******************************************************************************
+function:
+		Keep the calibration in flash, or take it from there
+*******************************************************************************/
+static uint32_t TP_Cal_Check(const TP_CAL *pCal)
+{
+    const uint8_t *pByte = (const uint8_t *)pCal;
+    uint32_t Hash = 2166136261u;
+    uint32_t i;
+
+    for (i = 0; i < offsetof(TP_CAL, Check); i++)
+        Hash = (Hash ^ pByte[i]) * 16777619u;
+    return Hash;
+}
+
+//Runs with the other core parked and interrupts off
+static void TP_Flash_Write(void *pParam)
+{
+    flash_range_erase(TP_CAL_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(TP_CAL_FLASH_OFFSET, (const uint8_t *)pParam, FLASH_PAGE_SIZE);
+}
+
+static void TP_Save_Cal(void)
+{
+    uint8_t Page[FLASH_PAGE_SIZE];
+    TP_CAL Cal;
+
+    memset(&Cal, 0, sizeof(Cal));
+    Cal.Magic = TP_CAL_MAGIC;
+    Cal.Scan_Dir = sTP_DEV.TP_Scan_Dir;
+    Cal.Lcd_Id = id;
+    Cal.fXfac = sTP_DEV.fXfac;
+    Cal.fYfac = sTP_DEV.fYfac;
+    Cal.iXoff = sTP_DEV.iXoff;
+    Cal.iYoff = sTP_DEV.iYoff;
+    Cal.Check = TP_Cal_Check(&Cal);
+
+    memset(Page, 0xff, sizeof(Page));
+    memcpy(Page, &Cal, sizeof(Cal));
+    if (flash_safe_execute(TP_Flash_Write, Page, TP_FLASH_TIMEOUT_MS) == PICO_OK) {
+        TP_Cal_Loaded = true;
+        printf("Touch calibration saved\r\n");
+    } else {
+        printf("Touch calibration could not be saved\r\n");
+    }
+}
+
+static bool TP_Load_Cal(void)
+{
+    const TP_CAL *pCal = (const TP_CAL *)(XIP_BASE + TP_CAL_FLASH_OFFSET);
+
+    //Only for the panel and scan direction it was taken with
+    if (pCal->Magic != TP_CAL_MAGIC || pCal->Check != TP_Cal_Check(pCal) ||
+        pCal->Scan_Dir != sTP_DEV.TP_Scan_Dir || pCal->Lcd_Id != id)
+        return false;
+
+    sTP_DEV.fXfac = pCal->fXfac;
+    sTP_DEV.fYfac = pCal->fYfac;
+    sTP_DEV.iXoff = pCal->iXoff;
+    sTP_DEV.iYoff = pCal->iYoff;
+    return true;
+}
+
+bool TP_Calibrated(void)
+{
+    return TP_Cal_Loaded;
+}
+
 /*******************************************************************************
 function:
 		Draw Cross
@@ -350,6 +475,10 @@ void TP_Adjust(void)
                      "the screen adjustment is completed.",
                      &Font16, FONT_BACKGROUND, RED);
 
+    //The touch that asked for the calibration is not the first cross
+    while (!DEV_Digital_Read(TP_IRQ_PIN))
+        Driver_Delay_ms(10);
+
     uint8_t Mar_Val = 12;
     TP_DrawCross(Mar_Val, Mar_Val, RED);
 
@@ -649,8 +778,14 @@ void TP_Adjust(void)
                 LCD_Clear(LCD_BACKGROUND);
                 GUI_DisString_EN(20, 110, "Touch Screen Adjust OK!",
                                  &Font16 , FONT_BACKGROUND , RED);
+                TP_Save_Cal();
                 Driver_Delay_ms(1000);
                 LCD_Clear(LCD_BACKGROUND);
+
+                //The last cross is not a touch for TP_Service
+                TP_Down = false;
+                TP_Irq_Pending = false;
+                TP_Irq_Arm();
                 return;
                 
                 //Exception handling,Reset  Initial value
@@ -1057,10 +1192,25 @@ function:
 void TP_Init( LCD_SCAN_DIR Lcd_ScanDir )
 {
     DEV_Digital_Write(TP_CS_PIN,1);
+    DEV_Bus_SetClock(DEV_BUS_TP, TP_SPI_BAUDRATE);
 
     sTP_DEV.TP_Scan_Dir = Lcd_ScanDir;
 
+    //A first burst leaves the ADC powered down with PENIRQ enabled
     TP_Read_ADC_XY(&sTP_DEV.Xpoint, &sTP_DEV.Ypoint);
+
+    TP_Cal_Loaded = TP_Load_Cal();
+    if (TP_Cal_Loaded) {
+        printf("Touch calibration loaded from flash\r\n");
+    } else {
+        printf("No touch calibration stored, using the defaults\r\n");
+        TP_GetAdFac();
+    }
+
+    //A raw handler leaves the GPIO callback of this core to others
+    gpio_add_raw_irq_handler(TP_IRQ_PIN, TP_Irq_Handler);
+    TP_Irq_Arm();
+    irq_set_enabled(IO_IRQ_BANK0, true);
 }
 
 
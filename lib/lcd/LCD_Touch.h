@@ -5,6 +5,10 @@
 * | Info        :
 *   Image scanning
 *      Please use progressive scanning to generate images or fonts
+*   The pen interrupt only flags a touch; TP_Service samples it in short
+*   bursts on the shared bus while the pen is down, median filters each
+*   burst and smooths the medians. The calibration from TP_Adjust is kept
+*   in the last flash sector and loaded by TP_Init.
 *----------------
 * |	This version:   V1.0
 * | Date        :   2017-08-16
@@ -26,6 +30,32 @@
 #define TP_PRESS_DOWN           0x80
 #define TP_PRESSED              0x40
 
+#define TP_SPI_BAUDRATE		2000000		//XPT2046 clocks up to 2.5 MHz
+#define TP_SAMPLES			7			//Readings of each axis per burst, odd
+#define TP_SPREAD_MAX		40			//ADC counts the middle readings may spread
+#define TP_IIR_WEIGHT		4			//A new median moves the position by 1/TP_IIR_WEIGHT
+#define TP_SAMPLE_US		10000		//Burst interval while the pen is down
+
+//Touch events
+#define TP_EVENT_DOWN		1
+#define TP_EVENT_MOVE		2
+#define TP_EVENT_UP			3
+
+typedef struct {
+	uint8_t Type;
+	POINT Xpoint;			//Screen coordinates, filtered
+	POINT Ypoint;
+	uint32_t Held_Ms;		//Since the pen went down
+} TP_EVENT;
+
+typedef struct {
+	UDOUBLE Irqs;			//Pen interrupts
+	UDOUBLE Bursts;
+	UDOUBLE Rejected;		//Bursts too noisy to use
+	UDOUBLE Bus_Us;			//Time spent sampling on the bus
+} TP_STATS;
+extern TP_STATS sTP_Stats;
+
 //Touch screen structure
 typedef struct {
 	POINT Xpoint0;
@@ -57,4 +87,6 @@ void TP_Adjust(void);
 void TP_Dialog(LCD_SCAN_DIR LCD_ScanDir);
 void TP_DrawBoard(LCD_SCAN_DIR LCD_ScanDir);
 void TP_Init( LCD_SCAN_DIR Lcd_ScanDir );
+bool TP_Service(TP_EVENT *pEvent);
+bool TP_Calibrated(void);
 #endif
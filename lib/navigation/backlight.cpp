@@ -0,0 +1,180 @@
+#include "backlight.h"
+#include "fastmath.h"
+#include <cmath>
+
+extern "C" {
+    #include "LCD_Driver.h"
+}
+
+static constexpr int64_t J2000 = 946728000;   // 2000-01-01 12:00 UTC, in seconds since the epoch
+static constexpr float SUNRISE_ELEVATION = -0.833f;  // Upper limb on the horizon, with refraction
+
+static float asinDeg(float x) {
+    return FM_Atan2(x, sqrtf(1.0f - x * x)) * FM_RAD2DEG;
+}
+
+void Backlight::update(const GPSFix& fix, uint32_t now_ms) {
+    if (!fix.status) {
+        return;
+    }
+    if (fix.timestamp > 0) {
+        updateSun(fix.timestamp, fix.lat, fix.lon);
+    }
+
+    // Moving, or a change of speed, counts like a button press
+    if (fix.speed >= STATIONARY_KT || fabsf(fix.speed - m_activitySpeed) >= SPEED_CHANGE_KT) {
+        m_activityMs = now_ms;
+        m_activitySpeed = fix.speed;
+    }
+}
+
+void Backlight::addBatteryReading(float percent, float current_mA) {
+    m_batteryPercent = percent;
+    m_batteryCurrent = current_mA;
+    if (percent < 0 || current_mA >= 0) {
+        return;
+    }
+
+    // Only discharge tells what the board draws
+    uint16_t duty = LCD_GetBackLightDuty();
+    int bucket = duty / 100;
+    m_bucketDuty[bucket] += duty;
+    m_bucketCurrent[bucket] -= current_mA;
+    m_bucketCount[bucket]++;
+    m_currentSum -= current_mA;
+    m_dutySum += duty;
+    m_readings++;
+}
+
+void Backlight::wake(uint32_t now_ms) {
+    m_activityMs = now_ms;
+}
+
+void Backlight::service(uint32_t now_ms) {
+    uint16_t target = targetLevel(now_ms);
+    if (target > m_level) {
+        m_level = target;
+    } else if (target < m_level) {
+        uint32_t step = FADE_PER_SECOND * (now_ms - m_lastServiceMs) / 1000;
+        step = step < 1 ? 1 : step;
+        uint32_t gap = static_cast<uint32_t>(m_level - target);
+        m_level = gap > step ? static_cast<uint16_t>(m_level - step) : target;
+    }
+    m_lastServiceMs = now_ms;
+
+    if (m_level != m_shown) {
+        LCD_SetBackLight(m_level);
+        m_shown = m_level;
+    }
+}
+
+uint16_t Backlight::targetLevel(uint32_t now_ms) const {
+    float level = MAX_LEVEL;
+
+    // Less light needed as the sun goes down
+    if (m_hasSun && m_sunElevation < DAY_ELEVATION) {
+        float t = (m_sunElevation - NIGHT_ELEVATION) / (DAY_ELEVATION - NIGHT_ELEVATION);
+        t = t < 0 ? 0 : t;
+        level = NIGHT_LEVEL + t * (MAX_LEVEL - NIGHT_LEVEL);
+    }
+
+    // Less light allowed as the battery runs down
+    if (m_batteryPercent >= 0 && m_batteryPercent < HIGH_BATTERY) {
+        float t = (m_batteryPercent - LOW_BATTERY) / (HIGH_BATTERY - LOW_BATTERY);
+        t = t < 0 ? 0 : t;
+        float cap = LOW_BATTERY_LEVEL + t * (MAX_LEVEL - LOW_BATTERY_LEVEL);
+        level = cap < level ? cap : level;
+    }
+
+    // Nobody looking
+    if (now_ms - m_activityMs >= STATIONARY_MS) {
+        float dimmed = level * STATIONARY_FRACTION;
+        dimmed = dimmed > MIN_LEVEL ? dimmed : MIN_LEVEL;
+        level = dimmed < level ? dimmed : level;
+    }
+    return static_cast<uint16_t>(level + 0.5f);
+}
+
+// Sun position from the almanac's low precision formulas, good to about
+// 0.01 degrees this century, and the sunrise and sunset around the fix
+void Backlight::updateSun(uint32_t timestamp, float lat, float lon) {
+    // Whole days and the fraction apart, a float day count alone is only
+    // good to a couple of minutes
+    int64_t seconds = static_cast<int64_t>(timestamp) - J2000;
+    int32_t days = static_cast<int32_t>(seconds >= 0 ? seconds / 86400 : (seconds - 86399) / 86400);
+    float fraction = static_cast<float>(seconds - static_cast<int64_t>(days) * 86400) / 86400.0f;
+    float d = days + fraction;
+
+    float g = FM_Wrap360(357.529f + 0.98560028f * days + 0.98560028f * fraction) * FM_DEG2RAD;
+    float q = FM_Wrap360(280.459f + 0.98564736f * days + 0.98564736f * fraction);
+    float l = (q + 1.915f * FM_Sin(g) + 0.020f * FM_Sin(2 * g)) * FM_DEG2RAD;
+    float e = (23.439f - 0.00000036f * d) * FM_DEG2RAD;
+
+    float sinL, cosL, sinE, cosE;
+    FM_SinCos(l, &sinL, &cosL);
+    FM_SinCos(e, &sinE, &cosE);
+    float ra = FM_Atan2(cosE * sinL, cosL) * FM_RAD2DEG;
+    float sinDecl = sinE * sinL;
+    float cosDecl = sqrtf(1.0f - sinDecl * sinDecl);
+
+    // Hour angle, from the sidereal time at Greenwich
+    float gmst = FM_Wrap360(280.46061837f + 360.0f * fraction + 0.98564736629f * days + 0.98564736629f * fraction);
+    float h = FM_Wrap360(gmst + lon - ra);
+    h = h >= 180.0f ? h - 360.0f : h;
+
+    float sinLat, cosLat;
+    FM_SinCos(lat * FM_DEG2RAD, &sinLat, &cosLat);
+    m_sunElevation = asinDeg(sinLat * sinDecl + cosLat * cosDecl * FM_Cos(h * FM_DEG2RAD));
+    m_hasSun = true;
+
+    // The hour angle goes round once a day, which puts noon, sunrise and
+    // sunset at fixed offsets from now
+    float cosH0 = (FM_Sin(SUNRISE_ELEVATION * FM_DEG2RAD) - sinLat * sinDecl) / (cosLat * cosDecl);
+    if (cosH0 <= -1.0f || cosH0 >= 1.0f) {
+        m_sunrise = 0;
+        m_sunset = 0;
+        return;
+    }
+    float h0 = FM_Atan2(sqrtf(1.0f - cosH0 * cosH0), cosH0) * FM_RAD2DEG;
+    m_sunrise = timestamp + static_cast<int32_t>((-h - h0) * 240.0f);
+    m_sunset = timestamp + static_cast<int32_t>((-h + h0) * 240.0f);
+}
+
+bool Backlight::getRuntime(Runtime& runtime) const {
+    if (m_readings == 0) {
+        return false;
+    }
+    runtime.average_mA = static_cast<float>(m_currentSum / m_readings);
+    runtime.averageDuty = static_cast<float>(m_dutySum / m_readings);
+
+    // Line through the mean current of each duty range that has enough
+    // readings, its slope is the backlight
+    double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    float minDuty = 1000, maxDuty = 0;
+    for (int i = 0; i < DUTY_BUCKETS; i++) {
+        if (m_bucketCount[i] < BUCKET_READINGS) {
+            continue;
+        }
+        double x = m_bucketDuty[i] / m_bucketCount[i];
+        double y = m_bucketCurrent[i] / m_bucketCount[i];
+        n++;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        minDuty = x < minDuty ? x : minDuty;
+        maxDuty = x > maxDuty ? x : maxDuty;
+    }
+
+    runtime.measured = false;
+    runtime.backlight_mA = NOMINAL_FULL_MA;
+    if (n >= 2 && maxDuty - minDuty >= MIN_DUTY_SPREAD) {
+        double slope = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+        if (slope > 0) {
+            runtime.backlight_mA = static_cast<float>(slope * 1000);
+            runtime.measured = true;
+        }
+    }
+    runtime.full_mA = runtime.average_mA + runtime.backlight_mA * (1000 - runtime.averageDuty) / 1000;
+    return true;
+}
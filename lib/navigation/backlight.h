@@ -0,0 +1,103 @@
+#ifndef BACKLIGHT_H
+#define BACKLIGHT_H
+
+#include <stdint.h>
+#include "gps_data.h"
+
+// Sets the backlight from what the boat and the battery are doing. Levels
+// are perceived brightness, 0 to MAX_LEVEL, LCD_SetBackLight turns them
+// into PWM duty. The level is the lowest of:
+//  - daylight: full with the sun up, NIGHT_LEVEL once it is below the end
+//    of civil twilight, from the sun's elevation at the fix time and place
+//  - battery: full above HIGH_BATTERY, down to LOW_BATTERY_LEVEL at
+//    LOW_BATTERY, no limit while charging
+// and a fraction of that after STATIONARY_MS without moving or a button or
+// touch. Dimming fades, anything that asks for more light gets it at once.
+//
+// The INA219 readings taken at different duties give the backlight's share
+// of the current, so the report can tell what the dimming buys in runtime.
+class Backlight {
+public:
+    // A fix: the sun and whether the boat is moving
+    void update(const GPSFix& fix, uint32_t now_ms);
+
+    // Battery percentage, below 0 while charging, and the current the
+    // INA219 reads, negative while discharging
+    void addBatteryReading(float percent, float current_mA);
+
+    // Button or touch: full brightness at once
+    void wake(uint32_t now_ms);
+
+    // Move the level toward its target, call from the main loop
+    void service(uint32_t now_ms);
+
+    uint16_t getLevel() const { return m_level; }
+
+    // Last battery reading, below 0 while charging or before the first
+    float getBatteryPercent() const { return m_batteryPercent; }
+    float getBatteryCurrent() const { return m_batteryCurrent; }
+
+    // Sun at the last fix, rise and set are seconds since the epoch, 0 in
+    // polar day or night
+    bool hasSun() const { return m_hasSun; }
+    float getSunElevation() const { return m_sunElevation; }
+    uint32_t getSunrise() const { return m_sunrise; }
+    uint32_t getSunset() const { return m_sunset; }
+
+    // Average current since boot and what it would have been with the
+    // backlight at full duty; false until there are readings to go on
+    struct Runtime {
+        float average_mA;       // What the battery gave
+        float full_mA;          // The same at full duty
+        float backlight_mA;     // Backlight current at full duty
+        bool measured;          // From the readings, or NOMINAL_FULL_MA
+        float averageDuty;      // Permille, what the governor ran at
+    };
+    bool getRuntime(Runtime& runtime) const;
+
+    static constexpr uint16_t MAX_LEVEL = 1000;
+    static constexpr uint16_t NIGHT_LEVEL = 250;
+    static constexpr float DAY_ELEVATION = 6.0f;       // Degrees, full brightness above
+    static constexpr float NIGHT_ELEVATION = -6.0f;    // End of civil twilight
+    static constexpr float HIGH_BATTERY = 50.0f;       // Percent
+    static constexpr float LOW_BATTERY = 10.0f;
+    static constexpr uint16_t LOW_BATTERY_LEVEL = 400;
+    static constexpr uint32_t STATIONARY_MS = 60000;
+    static constexpr float STATIONARY_KT = 0.5f;       // Slower than this is not moving
+    static constexpr float SPEED_CHANGE_KT = 0.5f;     // A change this big wakes it up
+    static constexpr float STATIONARY_FRACTION = 0.35f;
+    static constexpr uint16_t MIN_LEVEL = 100;         // Dimmed, still readable
+    static constexpr uint32_t FADE_PER_SECOND = 500;   // Levels, full to off in 2 s
+    static constexpr float NOMINAL_FULL_MA = 60.0f;    // Until the readings measure it
+
+private:
+    uint16_t m_level = MAX_LEVEL;
+    int32_t m_shown = -1;           // Level LCD_SetBackLight last got
+    uint32_t m_lastServiceMs = 0;
+    uint32_t m_activityMs = 0;      // Last movement, button or touch
+    float m_activitySpeed = 0.0f;   // SOG at that time
+    float m_batteryPercent = -1.0f; // -1 charging or no reading yet
+    float m_batteryCurrent = 0.0f;  // mA, with m_batteryPercent
+    uint16_t targetLevel(uint32_t now_ms) const;
+
+    // Sun
+    bool m_hasSun = false;
+    float m_sunElevation = 0.0f;
+    uint32_t m_sunrise = 0;
+    uint32_t m_sunset = 0;
+    void updateSun(uint32_t timestamp, float lat, float lon);
+
+    // Mean discharge current per tenth of the duty range, for the fit
+    static constexpr int DUTY_BUCKETS = 11;
+    static constexpr uint32_t BUCKET_READINGS = 20;    // Before a bucket counts
+    static constexpr float MIN_DUTY_SPREAD = 200.0f;    // Permille between buckets to fit
+    // Sums run for hours of readings, too many for a float to keep adding to
+    double m_bucketDuty[DUTY_BUCKETS] = {};
+    double m_bucketCurrent[DUTY_BUCKETS] = {};
+    uint32_t m_bucketCount[DUTY_BUCKETS] = {};
+    double m_currentSum = 0.0;
+    double m_dutySum = 0.0;
+    uint32_t m_readings = 0;
+};
+
+#endif // BACKLIGHT_H
@@ -0,0 +1,62 @@
+#include "frame_scheduler.h"
+
+FrameScheduler::FrameScheduler(uint32_t fps) {
+    setTargetFps(fps);
+}
+
+void FrameScheduler::setTargetFps(uint32_t fps) {
+    if (fps < 1) {
+        fps = 1;
+    } else if (fps > MAX_FPS) {
+        fps = MAX_FPS;
+    }
+    m_periodUs = 1000000 / fps;
+}
+
+void FrameScheduler::request(uint64_t now_us) {
+    if (!m_pending) {
+        m_pending = true;
+        m_requestUs = now_us;
+    }
+}
+
+void FrameScheduler::requestNow(uint64_t now_us) {
+    request(now_us);
+    if (m_nextUs > now_us) {
+        m_nextUs = now_us;
+    }
+}
+
+bool FrameScheduler::due(uint64_t now_us) {
+    if (!m_pending || now_us < m_nextUs) {
+        return false;
+    }
+
+    // Every whole period between the first slot the frame could have had
+    // and now is a frame the display should have shown but did not
+    uint64_t firstSlot = m_requestUs > m_nextUs ? m_requestUs : m_nextUs;
+    m_stats.dropped += static_cast<uint32_t>((now_us - firstSlot) / m_periodUs);
+    return true;
+}
+
+void FrameScheduler::frameDone(uint64_t start_us, uint64_t end_us) {
+    uint32_t frameUs = static_cast<uint32_t>(end_us - start_us);
+
+    m_pending = false;
+    m_stats.frames++;
+    m_stats.lastUs = frameUs;
+    m_stats.totalUs += frameUs;
+    if (frameUs > m_stats.maxUs) {
+        m_stats.maxUs = frameUs;
+    }
+    if (frameUs > m_periodUs) {
+        m_stats.overruns++;
+    }
+
+    // The next slot is one period after this frame started, a frame that
+    // ran long pushes it out instead of starting a burst to catch up
+    m_nextUs = start_us + m_periodUs;
+    if (m_nextUs < end_us) {
+        m_nextUs = end_us;
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <stdint.h>
+
+// Paces redraws to a target frame rate. State changes only request a frame;
+// requests that arrive between two frame slots are coalesced into one frame
+// at the next slot, so the render rate no longer depends on how often the
+// main loop or the GPS runs.
+class FrameScheduler {
+public:
+    struct Stats {
+        uint32_t frames = 0;    // Frames rendered
+        uint32_t dropped = 0;   // Slots that passed with a frame pending
+        uint32_t overruns = 0;  // Frames that took longer than one period
+        uint32_t lastUs = 0;    // Render time of the last frame
+        uint32_t maxUs = 0;     // Longest render time
+        uint64_t totalUs = 0;   // Render time of all frames
+
+        uint32_t averageUs() const { return frames ? static_cast<uint32_t>(totalUs / frames) : 0; }
+    };
+
+    explicit FrameScheduler(uint32_t fps = DEFAULT_FPS);
+
+    // Target frame rate, 1 to MAX_FPS
+    void setTargetFps(uint32_t fps);
+    uint32_t getTargetFps() const { return 1000000 / m_periodUs; }
+
+    // Something changed that needs a frame
+    void request(uint64_t now_us);
+
+    // Something changed that should not wait for its slot, like a page switch
+    void requestNow(uint64_t now_us);
+
+    // Whether the pending frame should be rendered now; when it returns true
+    // render, then call frameDone()
+    bool due(uint64_t now_us);
+    void frameDone(uint64_t start_us, uint64_t end_us);
+
+    const Stats& getStats() const { return m_stats; }
+    void resetStats() { m_stats = Stats(); }
+
+    static constexpr uint32_t DEFAULT_FPS = 10;
+    static constexpr uint32_t MAX_FPS = 50;
+
+private:
+    uint32_t m_periodUs;
+    uint64_t m_nextUs = 0;       // Earliest time of the next frame slot
+    uint64_t m_requestUs = 0;    // When the pending frame was first requested
+    bool m_pending = false;
+    Stats m_stats;
+};
+
+#endif // FRAME_SCHEDULER_H
@@ -2,12 +2,17 @@
 #include "simulation.h"
 #include "timeseries.h"
 #include "pointers.h"
+#include "track_map.h"
+
+static constexpr float METRES_PER_DEGREE = 111195.0f;  // Of latitude, on a 6371 km sphere
+static constexpr float METRES_PER_NM = 1852.0f;
 
 NavigationGUI::NavigationGUI() {
     // Create component objects
     m_timeSeries = new TimeSeriesPlot(this);
     m_simulation = new Simulation(this, m_timeSeries);
     m_pointers = new Pointers(this);
+    m_trackMap = new TrackMap(this);
     
     // TackDetector is initialized with its constructor
     
@@ -20,6 +25,7 @@ NavigationGUI::~NavigationGUI() {
     delete m_timeSeries;
     delete m_simulation;
     delete m_pointers;
+    delete m_trackMap;
 }
 
 void NavigationGUI::init() {
@@ -31,32 +37,45 @@ void NavigationGUI::init() {
     // Initialize LCD
     LCD_SCAN_DIR lcd_scan_dir = SCAN_DIR_DFT;
     LCD_Init(lcd_scan_dir, 800);
+
+    // Touch comes in on the pen interrupt, with the stored calibration
+    TP_Init(lcd_scan_dir);
+
+    // Time a full screen clear: queueing it vs. getting it onto the panel
+    uint64_t clear_start = time_us_64();
     GUI_Clear(LCD_BACKGROUND);
+    uint32_t clear_queued_us = static_cast<uint32_t>(time_us_64() - clear_start);
+    LCD_WaitIdle();
+    uint32_t clear_us = static_cast<uint32_t>(time_us_64() - clear_start);
+    printf("LCD clear: %u us, CPU busy for %u us of it\n", clear_us, clear_queued_us);
+
+#if GUI_BENCHMARK
+    GUI_Benchmark();
+#endif
+#if FASTMATH_BENCHMARK
+    FM_Benchmark();
+#endif
+
+    // From here on draw into the framebuffer, each frame goes out in one flush
+    FB_Init(LCD_BACKGROUND);
 
     // Draw labels
-    updateTarget();
-    GUI_DisString_EN(0, 0, "No GPS", &Font24, BLACK, WHITE);
-    GUI_DisString_EN(10, 175, "SOG", &Font20, BLACK, WHITE);
-    GUI_DisString_EN(260, 175, "COG", &Font20, BLACK, WHITE);
-    GUI_DisString_EN(130, 175, "TACK", &Font20, BLACK, WHITE);
+    showPage(Page::Main);
+    m_clockField.setText("No GPS");
     
     // Initial battery display
     updateBatteryDisplay();
 
-    // Initialize plot area and draw initial plot
-    m_timeSeries->clearPlotArea();
+    // Draw the initial plot
     m_timeSeries->drawPlot();
-}
 
-// Set the update interval for the time series plot
-void NavigationGUI::setTimeSeriesUpdateInterval(uint32_t seconds) {
-    printf("Setting time series update interval to %u seconds\n", seconds);
-    m_timeSeries->setUpdateInterval(seconds);
+    FB_Flush();
 }
 
 void NavigationGUI::update(GPSFix data) {
     // Store the data
     Data = data;
+    m_hasData = true;
     
     // If simulation is active, add incremental simulated data
     if (m_simulation->isActive()) {
@@ -79,23 +98,81 @@ void NavigationGUI::update(GPSFix data) {
         uint32_t current_time = to_ms_since_boot(get_absolute_time());
         m_tackDetector.updatePosition(Data.lat, Data.lon);
         m_tackDetector.update(Data.course, Data.speed, current_time);
+        m_trackMap->addFix(Data.lat, Data.lon, Data.timestamp);
+        m_backlight.update(Data, current_time);
     }
 
     // Calculate VMG if in target mode
-    float vmg = 0.0;
-    char vmg_sign[2] = { ' ', '\0' };
-    float vmg_abs = 0.0;
-    
-    if (m_targetMode) {
-        vmg = calculateVMG(Data.speed, Data.course, target_bearing);
-        vmg_sign[0] = (vmg < 0 ? '-' : ' ');
-        vmg_abs = fabs(vmg);
-    }
+    m_vmg = m_targetMode ? calculateVMG(Data.speed, Data.course, target_bearing) : 0.0;
 
     // Update max speed if available
     if (Data.speed > max_sog) {
         max_sog = Data.speed;
     }
+    addToStats();
+
+    // Always add data points when they arrive (to maintain data accuracy)
+    uint32_t lastPlotUpdate = m_timeSeries->getLastUpdateTime();
+    if (Data.timestamp != lastPlotUpdate && Data.timestamp > 0) {
+        // Only add a data point if not in simulation mode (simulation already added it)
+        if (!m_simulation->isActive()) {
+            m_timeSeries->addDataPoint(m_vmg, Data.speed, Data.timestamp);
+        }
+    }
+
+    requestFrame();
+}
+
+void NavigationGUI::service() {
+    handleTouch();
+    m_backlight.service(to_ms_since_boot(get_absolute_time()));
+
+    // The start timer counts on its own, not with the fixes
+    if (m_page == Page::Start && m_gunMs) {
+        int32_t ms = static_cast<int32_t>(to_ms_since_boot(get_absolute_time()) - m_gunMs);
+        int32_t tick = ms >= 0 ? ms / 1000 : -((999 - ms) / 1000);
+        if (tick != m_timerTick) {
+            m_timerTick = tick;
+            requestFrame();
+        }
+    }
+
+    uint64_t start_us = time_us_64();
+    if (!m_frames.due(start_us)) {
+        return;
+    }
+
+    DEV_SPI_STATS start_spi = sDev_SPI_Stats;
+    renderFrame();
+    m_frames.frameDone(start_us, time_us_64());
+
+    m_lastFrameSpiBytes = sDev_SPI_Stats.Bytes - start_spi.Bytes;
+    m_lastFrameSpiTransfers = sDev_SPI_Stats.Transfers - start_spi.Transfers;
+    m_lastFrameWaitUs = sDev_SPI_Stats.Wait_Us - start_spi.Wait_Us;
+
+    // The first frame after a page switch, report when it is on the panel
+    if (m_pageShownUs) {
+        LCD_WaitIdle();
+        printf("Page %s on screen after %u us\n", pageName(m_page),
+               static_cast<uint32_t>(time_us_64() - m_pageShownUs));
+        m_pageShownUs = 0;
+    }
+}
+
+// Bring the screen up to date and send it, labels and areas redrawn by the
+// button handlers since the last frame go out with it
+void NavigationGUI::renderFrame() {
+    if (m_page == Page::Start) {
+        drawStartTimer();
+    }
+
+    if (!m_hasData) {
+        FB_Flush();
+        return;
+    }
+
+    char vmg_sign[2] = { m_vmg < 0 ? '-' : ' ', '\0' };
+    float vmg_abs = fabs(m_vmg);
 
     // Format speed floats as strings
     char speedStr[8];
@@ -108,35 +185,60 @@ void NavigationGUI::update(GPSFix data) {
     snprintf(vmgStr, sizeof(vmgStr), "%.1f", vmg_abs);    
     snprintf(courseStr, sizeof(courseStr), "%03d", static_cast<int>(round(Data.course)));
     
-    if (m_targetMode) {
+    switch (m_page) {
+    case Page::HugeSog: {
+        // Only SOG, right aligned so the digits stay put
+        char hugeStr[8];
+        snprintf(hugeStr, sizeof(hugeStr), "%4.1f", Data.speed < 99.9f ? Data.speed : 99.9f);
+        m_hugeField.setText(hugeStr);
+        break;
+    }
+    case Page::Map:
+        // New track and the boat, the whole map if the view moved
+        m_trackMap->draw();
+        break;
+    case Page::Start: {
+        // Metres to the line and the speed to get there with
+        char lineStr[8];
+        float line = distanceToLine();
+        snprintf(lineStr, sizeof(lineStr), "%-4.0f", line < 9999.0f ? line : 9999.0f);
+        m_lineField.setText(lineStr);
+        m_startSogField.setText(speedStr);
+        break;
+    }
+    case Page::Stats:
+        drawStats();
+        break;
+    case Page::Main:
         // In target mode, show VMG prominently
-        GUI_DisString_EN(70, 60, vmgStr, &Font96, LCD_BACKGROUND, WHITE);
-        GUI_DisString_EN(10, 60, vmg_sign, &Font96, LCD_BACKGROUND, WHITE);
+        m_mainField.setText(vmgStr);
+        m_signField.setText(vmg_sign);
         
         // Show SOG below
-        GUI_DisString_EN(5, 200, speedStr, &Font48, LCD_BACKGROUND, WHITE);
-    } else {
+        m_minorField.setText(speedStr);
+        break;
+    default:
         // In no-target mode, show SOG prominently
-        GUI_DisString_EN(70, 60, speedStr, &Font96, LCD_BACKGROUND, WHITE);
-        
-        // Clear the VMG area since we're not showing it in no-target mode
-        // LCD_SetArealColor(0, 200, 120, 248, LCD_BACKGROUND);
+        m_mainField.setText(speedStr);
 
         // Display max speed where SOG was
         snprintf(maxSpeedStr, sizeof(maxSpeedStr), "%.1f", max_sog);
-        GUI_DisString_EN(5, 200, maxSpeedStr, &Font48, LCD_BACKGROUND, WHITE);
+        m_minorField.setText(maxSpeedStr);
+        break;
     }
 
-    // Show course over ground
-    GUI_DisString_EN(230, 200, courseStr, &Font48, LCD_BACKGROUND, WHITE);
-    
-    // Show last tack heading if available
-    float last_tack = m_tackDetector.getLastTackHeading();
-    char tackHeadingStr[8] = " -"; // Default to "N/A"
-    if (last_tack > 0.0) {
-        snprintf(tackHeadingStr, sizeof(tackHeadingStr), "%03d", static_cast<int>(round(last_tack)));
+    if (m_page == Page::Main || m_page == Page::Sog) {
+        // Show course over ground
+        m_courseField.setText(courseStr);
+        
+        // Show last tack heading if available
+        float last_tack = m_tackDetector.getLastTackHeading();
+        char tackHeadingStr[8] = " -"; // Default to "N/A"
+        if (last_tack > 0.0) {
+            snprintf(tackHeadingStr, sizeof(tackHeadingStr), "%03d", static_cast<int>(round(last_tack)));
+        }
+        m_tackField.setText(tackHeadingStr);
     }
-    GUI_DisString_EN(120, 200, tackHeadingStr, &Font48, BLACK, WHITE);
 
     // Print timestamp
     char time_str[10];
@@ -147,60 +249,43 @@ void NavigationGUI::update(GPSFix data) {
     } else {
         time_from_epoch(Data.timestamp, time_str, sizeof(time_str));
     }
-    GUI_DisString_EN(0, 0, time_str, &Font24, BLACK, WHITE);
+    m_clockField.setText(time_str);
     
     // Update battery display
     updateBatteryDisplay();
     
-    // Always add data points when they arrive (to maintain data accuracy)
-    uint32_t lastPlotUpdate = m_timeSeries->getLastUpdateTime();
-    if (Data.timestamp != lastPlotUpdate && Data.timestamp > 0) {
-        // Only add a data point if not in simulation mode (simulation already added it)
-        if (!m_simulation->isActive()) {
-            m_timeSeries->addDataPoint(vmg, Data.speed, Data.timestamp);
-        }
-        
-        // Only update the visual display when it's time to update based on the configured interval
-        bool shouldUpdateNow = m_timeSeries->shouldUpdate(Data.timestamp);
-        
-        if (shouldUpdateNow) {
-            // Only clear the data area, not the axes and labels
-            m_timeSeries->clearPlotArea();
-            
-            // Draw the plot
-            m_timeSeries->drawPlot();
-            
-            // Update the last visual update timestamp
-            m_timeSeries->updateLastVisualTimestamp(Data.timestamp);
-        }
-    }
+    // Draw the column of every new sample, simulated ones included
+    m_timeSeries->drawLatest();
+
+    // Send whatever changed in this frame
+    FB_Flush();
 }
 
 // Calculate bearing between two points
 float NavigationGUI::calculateBearing(float lat1, float lon1, float lat2, float lon2) {
-    float dLon = (lon2 - lon1) * DEG2RAD;
-    lat1 *= DEG2RAD;
-    lat2 *= DEG2RAD;
-
-    float x = sin(dLon) * cos(lat2);
-    float y = cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(dLon);
-    float bearing = atan2(x, y);
-
-    return fmod((bearing * RAD2DEG + 360), 360); // Normalize to 0-360
+    float sinLat1, cosLat1, sinLat2, cosLat2, sinDLat, cosDLat, sinHalfDLon, cosHalfDLon;
+    FM_SinCos(lat1 * FM_DEG2RAD, &sinLat1, &cosLat1);
+    FM_SinCos(lat2 * FM_DEG2RAD, &sinLat2, &cosLat2);
+    FM_SinCos((lat2 - lat1) * FM_DEG2RAD, &sinDLat, &cosDLat);
+    FM_SinCos((lon2 - lon1) * FM_DEG2RAD / 2, &sinHalfDLon, &cosHalfDLon);
+
+    // x = sin(dLon) cos(lat2) and y = cos(lat1) sin(lat2) - sin(lat1) cos(lat2) cos(dLon),
+    // with y rewritten so nearby marks do not take the difference of two close values
+    float x = 2 * sinHalfDLon * cosHalfDLon * cosLat2;
+    float y = sinDLat + 2 * sinLat1 * cosLat2 * sinHalfDLon * sinHalfDLon;
+    float bearing = FM_Atan2(x, y);
+
+    return FM_Wrap360(bearing * FM_RAD2DEG); // Normalize to 0-360
 }
 
 // Calculate VMG to mark
 float NavigationGUI::calculateVMG(float speed, float course, float target_bearing) {
-    // Convert degrees to radians
-    float course_rad = course * DEG2RAD;
-    float target_bearing_rad = target_bearing * DEG2RAD;
-
     // Calculate VMG
-    return speed * cos(course_rad - target_bearing_rad);
+    return speed * FM_Cos((course - target_bearing) * FM_DEG2RAD);
 }
 
-// Update the target display
-void NavigationGUI::updateTarget() {
+// The target line of the main page
+void NavigationGUI::drawTargetLabel() {
     // Format the target mark text
     char markStr[20];
     
@@ -208,11 +293,6 @@ void NavigationGUI::updateTarget() {
     snprintf(markStr, sizeof(markStr), "VMG (kt) -> %s", current_target.name);
     
     int mark_str_len = 18 * strlen(markStr);
-    
-    // Clear the text area
-    LCD_SetArealColor(0, 40, 480, 70, LCD_BACKGROUND);
-    
-    // Draw the new text
     GUI_DisString_EN(320 - mark_str_len, 40, markStr, &Font24, BLACK, WHITE);
 }
 
@@ -221,7 +301,6 @@ void NavigationGUI::toggleTargetMode() {
     // Use a more reliable approach with a timeout to prevent button lockup
     static uint32_t last_toggle_time = 0;
     uint32_t current_time = to_ms_since_boot(get_absolute_time());
-    char markStr[20];
     
     // Allow toggling if at least 100ms has passed since the last toggle
     if (current_time - last_toggle_time < 100) {
@@ -232,30 +311,208 @@ void NavigationGUI::toggleTargetMode() {
     // Update the last toggle time
     last_toggle_time = current_time;
     
-    // Toggle the target mode
-    m_targetMode = !m_targetMode;
-    
-    if (m_targetMode) {
+    if (m_page == Page::Main) {
+        printf("Switched to no-target mode, showing SOG prominently\n");
+        switchPage(Page::Sog);
+    } else {
         printf("Switched to target mode, showing VMG to %s\n", current_target.name);
-        // Set minor display for SOG
-        GUI_DisString_EN(10, 175, "SOG", &Font20, BLACK, WHITE);
-        // In target mode, show VMG to target
-        updateTarget();
+        switchPage(Page::Main);
+    }
+}
+
+// Step through the pages, target mode to SOG through toggleTargetMode
+void NavigationGUI::cycleDisplayMode() {
+    static uint32_t last_cycle_time = 0;
+    uint32_t current_time = to_ms_since_boot(get_absolute_time());
+
+    if (m_page == Page::Main) {
+        toggleTargetMode();
+        return;
+    }
+
+    if (current_time - last_cycle_time < 100) {
+        printf("Cycling display mode too fast, ignoring request\n");
+        return;
+    }
+    last_cycle_time = current_time;
+
+    Page next = static_cast<Page>((static_cast<int>(m_page) + 1) % PAGE_COUNT);
+    printf("Switched to the %s page\n", pageName(next));
+    switchPage(next);
+}
+
+const char* NavigationGUI::pageName(Page page) {
+    static const char* const names[PAGE_COUNT] = {"main", "SOG", "huge SOG", "track map", "start", "stats"};
+    return names[static_cast<int>(page)];
+}
+
+// Show a page and time it, the frame after it brings the live fields
+void NavigationGUI::switchPage(Page page) {
+    m_pageShownUs = time_us_64();
+    showPage(page);
+    printf("Page %s chrome in %u us\n", pageName(page),
+           static_cast<uint32_t>(time_us_64() - m_pageShownUs));
+    m_frames.requestNow(time_us_64());
+}
+
+// Put the chrome of a page into the area between the status line and the
+// plot: from its cache, or drawn and cached the first time
+void NavigationGUI::showPage(Page page) {
+    if (m_page == Page::Map) {
+        m_trackMap->hide();
+    }
+    m_page = page;
+    if (page == Page::Main) {
+        m_targetMode = true;
+    } else if (page == Page::Sog) {
+        m_targetMode = false;
+    }
+
+    PageChrome& chrome = m_chrome[static_cast<int>(page)];
+    if (chrome.valid()) {
+        chrome.restore();
     } else {
-        printf("Switched to no-target mode, showing SOG prominently\n");
+        LCD_SetArealColor(0, MODE_AREA_TOP, 320, MODE_AREA_BOTTOM, LCD_BACKGROUND);
+        drawChrome(page);
+        if (FB_Active()) {
+            chrome.capture(0, MODE_AREA_TOP, 320, MODE_AREA_BOTTOM);
+            printf("Page %s chrome cached in %u bytes\n", pageName(page), chrome.getBytes());
+        }
+    }
+
+    // The live fields start over on the cleared area
+    invalidateFields();
+    if (page == Page::Map) {
+        m_trackMap->invalidate();
+    }
+}
 
-        // Clear the label area
-        LCD_SetArealColor(0, 40, 480, 70, LCD_BACKGROUND);
-        GUI_DisString_EN(140, 40, "SOG", &Font24, BLACK, WHITE);
+// Everything of a page that stays put while it is shown
+void NavigationGUI::drawChrome(Page page) {
+    static const char* const statLabels[STAT_ROWS] = {"Max SOG", "Avg SOG", "Sailed", "Tacks", "Under way"};
+
+    switch (page) {
+    case Page::Main:
+        drawTargetLabel();
+        drawFieldLabels();
+        break;
+    case Page::Sog:
+        GUI_DisString_EN(140, MODE_AREA_TOP, "SOG", &Font24, BLACK, WHITE);
+        drawFieldLabels();
+        break;
+    case Page::HugeSog:
+        GUI_DisString_EN(92, MODE_AREA_TOP, "SOG (kt)", &Font24, BLACK, WHITE);
+        break;
+    case Page::Start:
+        GUI_DisString_EN(117, MODE_AREA_TOP, "START", &Font24, BLACK, WHITE);
+        GUI_DisString_EN(10, 190, "LINE (m)", &Font20, BLACK, WHITE);
+        GUI_DisString_EN(200, 190, "SOG", &Font20, BLACK, WHITE);
+        break;
+    case Page::Stats:
+        GUI_DisString_EN(117, MODE_AREA_TOP, "STATS", &Font24, BLACK, WHITE);
+        for (int i = 0; i < STAT_ROWS; i++) {
+            GUI_DisString_EN(10, STAT_Y + i * STAT_SPACING, statLabels[i], &Font24, BLACK, WHITE);
+        }
+        break;
+    default:
+        // The track map draws its own title
+        break;
+    }
+}
 
-        // Clear the main display area for the prominent value
-        LCD_SetArealColor(0, 60, 320, 156, LCD_BACKGROUND);
+// Labels under the minor values
+void NavigationGUI::drawFieldLabels() {
+    GUI_DisString_EN(10, 175, m_targetMode ? "SOG" : "Max", &Font20, BLACK, WHITE);
+    GUI_DisString_EN(260, 175, "COG", &Font20, BLACK, WHITE);
+    GUI_DisString_EN(130, 175, "TACK", &Font20, BLACK, WHITE);
+}
 
-        // Set minor display for SOG
-        GUI_DisString_EN(10, 175, "Max", &Font20, BLACK, WHITE);
+// Start the sequence, or while it runs put the gun on the nearest full
+// minute, like syncing a watch on the signal. After the gun it starts over.
+void NavigationGUI::syncStartTimer() {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    int32_t left = static_cast<int32_t>(m_gunMs - now);
+    if (!m_gunMs || left <= 0) {
+        m_gunMs = now + START_SEQUENCE_MS;
+    } else {
+        m_gunMs = now + (left + 30000) / 60000 * 60000;
+    }
+    printf("Start timer: gun in %u s\n", (m_gunMs - now) / 1000);
+    m_timerTick = INT32_MIN;
+    requestFrame();
+}
 
+// Minutes and seconds to the gun, counting up with a '+' after it
+void NavigationGUI::drawStartTimer() {
+    char timerStr[8];
+    if (!m_gunMs) {
+        snprintf(timerStr, sizeof(timerStr), " %d:%02d", START_SEQUENCE_MS / 60000, 0);
+    } else {
+        int32_t ms = static_cast<int32_t>(m_gunMs - to_ms_since_boot(get_absolute_time()));
+        bool after = ms <= 0;
+        int32_t seconds = after ? -ms / 1000 : (ms + 999) / 1000;
+        seconds = seconds < 599 ? seconds : 599;
+        snprintf(timerStr, sizeof(timerStr), "%c%d:%02d", after ? '+' : ' ', seconds / 60, seconds % 60);
     }
+    m_timerField.setText(timerStr);
+}
 
+// Metres from the boat to the line between the committee boat and the pin,
+// on a plane around the boat
+float NavigationGUI::distanceToLine() const {
+    const Navigation::Mark& boat = Navigation::MARKS[Navigation::START_BOAT];
+    const Navigation::Mark& pin = Navigation::MARKS[Navigation::START_PIN];
+    float metresPerDegLon = METRES_PER_DEGREE * FM_Cos(Data.lat * FM_DEG2RAD);
+
+    float ax = (boat.lon - Data.lon) * metresPerDegLon;
+    float ay = (boat.lat - Data.lat) * METRES_PER_DEGREE;
+    float ex = (pin.lon - boat.lon) * metresPerDegLon;
+    float ey = (pin.lat - boat.lat) * METRES_PER_DEGREE;
+    float length2 = ex * ex + ey * ey;
+
+    float t = length2 > 0 ? -(ax * ex + ay * ey) / length2 : 0;
+    t = t < 0 ? 0 : t > 1 ? 1 : t;
+    float dx = ax + t * ex;
+    float dy = ay + t * ey;
+    return sqrtf(dx * dx + dy * dy);
+}
+
+// Totals for the stats page, from the fixes with the boat under way
+void NavigationGUI::addToStats() {
+    if (!Data.status || Data.speed < UNDER_WAY_KT) {
+        m_hasLastFix = false;
+        return;
+    }
+
+    if (m_hasLastFix && Data.timestamp > m_lastTimestamp) {
+        float metresPerDegLon = METRES_PER_DEGREE * FM_Cos(Data.lat * FM_DEG2RAD);
+        float dx = (Data.lon - m_lastLon) * metresPerDegLon;
+        float dy = (Data.lat - m_lastLat) * METRES_PER_DEGREE;
+        m_distanceNm += sqrtf(dx * dx + dy * dy) / METRES_PER_NM;
+        m_underWaySeconds += Data.timestamp - m_lastTimestamp;
+    }
+    if (!m_hasLastFix || Data.timestamp > m_lastTimestamp) {
+        m_sogSum += Data.speed;
+        m_sogCount++;
+    }
+
+    m_hasLastFix = true;
+    m_lastLat = Data.lat;
+    m_lastLon = Data.lon;
+    m_lastTimestamp = Data.timestamp;
+}
+
+void NavigationGUI::drawStats() {
+    char str[STAT_ROWS][16];
+    snprintf(str[0], sizeof(str[0]), "%.1f kt ", max_sog);
+    snprintf(str[1], sizeof(str[1]), "%.1f kt ", m_sogCount ? m_sogSum / m_sogCount : 0.0f);
+    snprintf(str[2], sizeof(str[2]), "%.2f nm ", m_distanceNm);
+    snprintf(str[3], sizeof(str[3]), "%u ", m_tackDetector.getTackCount());
+    snprintf(str[4], sizeof(str[4]), "%u:%02u:%02u", m_underWaySeconds / 3600,
+             m_underWaySeconds / 60 % 60, m_underWaySeconds % 60);
+    for (int i = 0; i < STAT_ROWS; i++) {
+        m_statFields[i].setText(str[i]);
+    }
 }
 
 // Update the battery percentage display in the top right corner
@@ -264,23 +521,28 @@ void NavigationGUI::updateBatteryDisplay() {
     float battery_percentage = m_batteryMonitor.getBatteryPercentage();
     float current = m_batteryMonitor.getCurrent_mA();
     
-    // Get display dimensions from sLCD_DIS
-    extern LCD_DIS sLCD_DIS;  // Declare the external LCD_DIS structure
-    
-    // Clear the battery display area
-    LCD_SetArealColor(215, 0, 320, 24, LCD_BACKGROUND);
+    // Switching between "charging" and a percentage changes font and position,
+    // so clear the whole battery area and start both fields over
+    m_backlight.addBatteryReading(battery_percentage, current);
+    int charging = battery_percentage < 0 ? 1 : 0;
+    if (charging != m_batteryCharging) {
+        LCD_SetArealColor(215, 0, 320, 24, LCD_BACKGROUND);
+        m_batteryField.invalidate();
+        m_chargingField.invalidate();
+        m_batteryCharging = charging;
+    }
     
     // Check if battery is charging (indicated by special value -1)
-    if (battery_percentage < 0) {
+    if (charging) {
         // Display "charging" instead of percentage
-        GUI_DisString_EN(220, 0, "charging", &Font16, BLACK, WHITE);
+        m_chargingField.setText("charging");
     } else {
         // Format as 2-digit whole integer with leading zero
         char batteryStr[8];
         snprintf(batteryStr, sizeof(batteryStr), "%02.0f%%", battery_percentage);
         
         // Draw the battery percentage
-        GUI_DisString_EN(265, 0, batteryStr, &Font24, BLACK, WHITE);
+        m_batteryField.setText(batteryStr);
     }
     
     // // Debug output
@@ -291,12 +553,44 @@ void NavigationGUI::updateBatteryDisplay() {
     // }
 }
 
+// Force every text field to redraw in full on its next update
+void NavigationGUI::invalidateFields() {
+    m_mainField.invalidate();
+    m_signField.invalidate();
+    m_minorField.invalidate();
+    m_courseField.invalidate();
+    m_tackField.invalidate();
+    m_clockField.invalidate();
+    m_batteryField.invalidate();
+    m_chargingField.invalidate();
+    m_hugeField.invalidate();
+    m_timerField.invalidate();
+    m_lineField.invalidate();
+    m_startSogField.invalidate();
+    for (TextField& field : m_statFields) {
+        field.invalidate();
+    }
+}
+
 // Cycle to the next target mark
 void NavigationGUI::cycleToNextTarget() {
     // Use a more reliable approach with a timeout to prevent button lockup
     static uint32_t last_cycle_time = 0;
     uint32_t current_time = to_ms_since_boot(get_absolute_time());
 
+    // On the map the short press zooms instead
+    if (m_page == Page::Map) {
+        m_trackMap->cycleZoom();
+        requestFrame();
+        return;
+    }
+
+    // And on the start page it starts or syncs the timer
+    if (m_page == Page::Start) {
+        syncStartTimer();
+        return;
+    }
+
     if (!m_targetMode) {
         printf("Not in target mode, ignoring cycle request\n");
         return;
@@ -325,9 +619,16 @@ void NavigationGUI::cycleToNextTarget() {
     // Increment index and wrap around if needed
     int next_index = (current_index + 1) % Navigation::MARKS.size();
     
-    // Update the current target
-    current_target = Navigation::MARKS[next_index];
+    selectTarget(Navigation::MARKS[next_index]);
+}
+
+// Make a mark the target and show it
+void NavigationGUI::selectTarget(const Target& target) {
+    current_target = target;
     printf("New target: %s\n", current_target.name);
+    if (m_targetListener) {
+        m_targetListener(current_target);
+    }
     
     // Recalculate the bearing to the new target if we have valid GPS data
     if (Data.status) {
@@ -338,6 +639,76 @@ void NavigationGUI::cycleToNextTarget() {
         printf("New bearing: %.1f degrees\n", target_bearing);
     }
     
-    // Update the target display
-    updateTarget();
+    // The target line of the main page is chrome, the map shows the
+    // target by its mark
+    m_chrome[static_cast<int>(Page::Main)].invalidate();
+    if (m_page == Page::Main) {
+        showPage(Page::Main);
+    } else if (m_page == Page::Map) {
+        m_trackMap->refresh();
+    }
+    requestFrame();
+}
+
+// Taps act on release, a touch held long enough calibrates instead
+void NavigationGUI::handleTouch() {
+    TP_EVENT event;
+    if (!TP_Service(&event)) {
+        return;
+    }
+
+    if (event.Type == TP_EVENT_DOWN) {
+        m_touchHeld = false;
+        wakeBacklight();
+    } else if (event.Type == TP_EVENT_MOVE) {
+        if (!m_touchHeld && event.Held_Ms >= TOUCH_CALIBRATE_MS) {
+            m_touchHeld = true;
+            calibrateTouch();
+        }
+    } else if (!m_touchHeld && event.Held_Ms < TOUCH_TAP_MS) {
+        handleTap(event.Xpoint, event.Ypoint);
+    }
+}
+
+// On the map a tap on a mark targets it and one elsewhere on the map zooms.
+// The target line of the main page picks the next target and the timer of
+// the start page syncs it. The rest of the screen, the map title included,
+// goes to the next page.
+void NavigationGUI::handleTap(int x, int y) {
+    printf("Tap at %d,%d\n", x, y);
+
+    if (m_page == Page::Map && y >= TrackMap::Y_START && y < TrackMap::Y_END) {
+        const Target* mark = m_trackMap->markAt(x, y);
+        if (mark) {
+            selectTarget(*mark);
+        } else {
+            m_trackMap->cycleZoom();
+            requestFrame();
+        }
+        return;
+    }
+
+    bool targetLine = y >= MODE_AREA_TOP && y < MODE_AREA_TOP + 30;
+    bool timer = y >= 70 && y < 190;
+    if ((targetLine && m_page == Page::Main) || (timer && m_page == Page::Start)) {
+        cycleToNextTarget();
+    } else {
+        cycleDisplayMode();
+    }
+}
+
+// The calibration takes the whole screen, the first page is drawn again after it
+void NavigationGUI::calibrateTouch() {
+    printf("Touch held, calibrating the touch screen\n");
+    FB_Enable(false);
+    TP_Adjust();
+    FB_Init(LCD_BACKGROUND);
+
+    // The cached chrome keeps colors, not palette indices, so it outlives
+    // the framebuffer; the map starts over without its boat
+    m_trackMap->invalidate();
+    showPage(Page::Main);
+    m_batteryCharging = -1;
+    m_timeSeries->drawPlot();
+    requestFrame();
 }
\ No newline at end of file
@@ -7,12 +7,20 @@
 #include "tack_detector.h"
 #include "marks.h"
 #include "pico_ups.h"
+#include "text_field.h"
+#include "segment_field.h"
+#include "frame_scheduler.h"
+#include "page_chrome.h"
+#include "backlight.h"
+#include "fastmath.h"
 
 extern "C" {
     #include "DEV_Config.h"
+    #include "DEV_Bus.h"
     #include "LCD_Driver.h"
     #include "LCD_Touch.h"
     #include "LCD_GUI.h"
+    #include "LCD_Framebuffer.h"
     #include "LCD_Bmp.h"
 }
 
@@ -20,6 +28,7 @@ extern "C" {
 class Simulation;
 class TimeSeriesPlot;
 class Pointers;
+class TrackMap;
 
 // Define constants for navigation calculations
 static constexpr double DEG2RAD = M_PI / 180.0;
@@ -36,8 +45,14 @@ class NavigationGUI {
 
         // Initialization function
         void init();
+        
+        // Take in a new fix; this only updates state and requests a frame
         void update(GPSFix data);
         
+        // Call from the main loop, takes touches and renders a frame when
+        // one is pending and due
+        void service();
+        
         // Navigation calculations
         float calculateBearing(float lat1, float lon1, float lat2, float lon2);
         float calculateVMG(float speed, float course, float target_bearing);
@@ -46,33 +61,82 @@ class NavigationGUI {
         float getTargetBearing() const { return target_bearing; }
         const Target& getCurrentTarget() const { return current_target; }
         float getLastTackHeading() const { return m_tackDetector.getLastTackHeading(); }
+        uint32_t getTackCount() const { return m_tackDetector.getTackCount(); }
+        
+        // Frame pacing
+        void setTargetFps(uint32_t fps) { m_frames.setTargetFps(fps); }
+        const FrameScheduler::Stats& getFrameStats() const { return m_frames.getStats(); }
+        void resetFrameStats() { m_frames.resetStats(); }
+        
+        // SPI traffic of the last frame
+        uint32_t getLastFrameSpiBytes() const { return m_lastFrameSpiBytes; }
+        uint32_t getLastFrameSpiTransfers() const { return m_lastFrameSpiTransfers; }
+        uint32_t getLastFrameWaitUs() const { return m_lastFrameWaitUs; }
+        
+        // Backlight, the button wakes it up
+        const Backlight& getBacklight() const { return m_backlight; }
+        void wakeBacklight() { m_backlight.wake(to_ms_since_boot(get_absolute_time())); }
         
         // Target selection
         void cycleToNextTarget();
         
-        // Toggle target mode (used for long press)
+        // Called with the new target on every change, by the button or a touch
+        using TargetListener = void (*)(const Target& target);
+        void setTargetListener(TargetListener listener) { m_targetListener = listener; }
+        
+        // Toggle target mode, between the main and the SOG page
         void toggleTargetMode();
         
-        // Configure time series plot
-        void setTimeSeriesUpdateInterval(uint32_t seconds);
+        // Long press: the next page, in the order of Page
+        void cycleDisplayMode();
     
     private:
         // Friend declarations
         friend class Simulation;
         friend class TimeSeriesPlot;
         friend class Pointers;
+        friend class TrackMap;
         
         // Component objects
         Simulation* m_simulation;
         TimeSeriesPlot* m_timeSeries;
         Pointers* m_pointers;
+        TrackMap* m_trackMap;
         TackDetector m_tackDetector;  // Tack detection and tracking
         INA219 m_batteryMonitor;      // Battery monitoring
+        Backlight m_backlight;        // Dims with the daylight, the battery and when nobody looks
         
         // Battery display
         void updateBatteryDisplay();
+        int m_batteryCharging = -1;   // -1 until the first reading, then 0/1
+        
+        // Retained text fields, only changed characters are redrawn
+        TextField m_mainField{70, 60, &Font96};      // VMG, or SOG in no-target mode
+        TextField m_signField{10, 60, &Font96};      // VMG sign
+        TextField m_minorField{5, 200, &Font48};     // SOG, or max SOG in no-target mode
+        TextField m_courseField{230, 200, &Font48};
+        TextField m_tackField{120, 200, &Font48};
+        TextField m_clockField{0, 0, &Font24};
+        TextField m_batteryField{265, 0, &Font24};
+        TextField m_chargingField{220, 0, &Font16};
+        SegmentField m_hugeField{0, 75, 170};        // SOG in huge SOG mode, fits "99.9"
+        TextField m_timerField{15, 70, &Font96};     // Start timer, " 4:59" before the gun
+        TextField m_lineField{5, 214, &Font48};      // Metres to the start line
+        TextField m_startSogField{200, 214, &Font48};
+        static constexpr int STAT_ROWS = 5;
+        static constexpr int STAT_Y = 78;
+        static constexpr int STAT_SPACING = 38;
+        TextField m_statFields[STAT_ROWS] = {
+            {180, STAT_Y, &Font24}, {180, STAT_Y + STAT_SPACING, &Font24},
+            {180, STAT_Y + 2 * STAT_SPACING, &Font24}, {180, STAT_Y + 3 * STAT_SPACING, &Font24},
+            {180, STAT_Y + 4 * STAT_SPACING, &Font24}};
+        
+        // Force a full redraw of every field, after an area was cleared
+        void invalidateFields();
         
         GPSFix Data;
+        bool m_hasData = false;     // Data holds a fix to show
+        float m_vmg = 0.0;          // VMG to the target of Data
 
         // Display parameters
         int centerX = 160;  // Center X coordinate of the display
@@ -86,12 +150,74 @@ class NavigationGUI {
 
         // Current target - using the marks from marks.h
         Target current_target = Navigation::MARKS[0];
+        TargetListener m_targetListener = nullptr;
         
-        // Flag to indicate whether we're in target mode or not
+        // Flag to indicate whether we're in target mode or not, the main
+        // page turns it on and the SOG page off
         bool m_targetMode = true;
         
-        // Helper function to update the target display
-        void updateTarget();
+        // Pages take everything between the status line and the plot. The
+        // static part of each is drawn once and cached, see PageChrome.
+        enum class Page { Main, Sog, HugeSog, Map, Start, Stats, Count };
+        static constexpr int PAGE_COUNT = static_cast<int>(Page::Count);
+        static const char* pageName(Page page);
+        Page m_page = Page::Main;
+        PageChrome m_chrome[PAGE_COUNT];
+        uint64_t m_pageShownUs = 0;     // When a page switch started, until it is on the panel
+        static constexpr int MODE_AREA_TOP = 40;
+        static constexpr int MODE_AREA_BOTTOM = 275;
+        void switchPage(Page page);
+        void showPage(Page page);
+        void drawChrome(Page page);
+        
+        // Draw the labels of the normal layout
+        void drawFieldLabels();
+        void drawTargetLabel();
+        
+        // Start page: a countdown to the gun, then the time since it, and
+        // the distance to the line between two of the marks
+        static constexpr uint32_t START_SEQUENCE_MS = 5 * 60 * 1000;
+        uint32_t m_gunMs = 0;           // Boot time of the gun, 0 before the timer was started
+        int32_t m_timerTick = 0;        // Second of the timer last requested a frame for
+        void syncStartTimer();
+        void drawStartTimer();
+        float distanceToLine() const;
+        
+        // Stats page, totals over the fixes with the boat under way
+        static constexpr float UNDER_WAY_KT = 1.0f;
+        float m_distanceNm = 0.0f;
+        uint32_t m_underWaySeconds = 0;
+        float m_sogSum = 0.0f;
+        uint32_t m_sogCount = 0;
+        bool m_hasLastFix = false;
+        float m_lastLat = 0.0f;
+        float m_lastLon = 0.0f;
+        uint32_t m_lastTimestamp = 0;
+        void addToStats();
+        void drawStats();
+        
+        // Frames are rendered at a paced rate, whatever changed since the
+        // last one goes out together
+        FrameScheduler m_frames;
+        void requestFrame() { m_frames.request(time_us_64()); }
+        void renderFrame();
+        
+        // SPI traffic of the last frame
+        uint32_t m_lastFrameSpiBytes = 0;
+        uint32_t m_lastFrameSpiTransfers = 0;
+        uint32_t m_lastFrameWaitUs = 0;     // Time spent waiting on the LCD queue
+        
+        // Make a mark the target and show it
+        void selectTarget(const Target& target);
+        
+        // Touch: a tap picks a mark on the map or the next target or page,
+        // holding the screen calibrates it
+        static constexpr uint32_t TOUCH_TAP_MS = 1000;        // Longer touches are not taps
+        static constexpr uint32_t TOUCH_CALIBRATE_MS = 5000;
+        bool m_touchHeld = false;   // This touch already started a calibration
+        void handleTouch();
+        void handleTap(int x, int y);
+        void calibrateTouch();
 };
 
 #endif
@@ -23,6 +23,10 @@ constexpr std::array<Mark, 8> MARKS = {{
     {"33",   37.801,      -122.3477333}
 }};
 
+// The start line, from the committee boat to the pin
+constexpr std::size_t START_BOAT = 0;
+constexpr std::size_t START_PIN = 5;
+
 } // namespace Navigation
 
 #endif // MARKS_H
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "page_chrome.h"
+
+PageChrome::~PageChrome() {
+    delete[] m_spans;
+}
+
+void PageChrome::capture(int xStart, int yStart, int xEnd, int yEnd) {
+    invalidate();
+    m_xStart = xStart;
+    m_yStart = yStart;
+    m_xEnd = xEnd;
+    m_yEnd = yEnd;
+
+    // Count first, the runs get exactly the memory they need
+    m_count = FB_SaveSpans(xStart, yStart, xEnd, yEnd, nullptr, 0);
+    m_spans = new FB_SPAN[m_count];
+    FB_SaveSpans(xStart, yStart, xEnd, yEnd, m_spans, m_count);
+}
+
+void PageChrome::restore() const {
+    if (m_spans) {
+        FB_RestoreSpans(m_xStart, m_yStart, m_xEnd, m_yEnd, m_spans, m_count);
+    }
+}
+
+void PageChrome::invalidate() {
+    delete[] m_spans;
+    m_spans = nullptr;
+    m_count = 0;
+}
@@ -0,0 +1,45 @@
+#ifndef PAGE_CHROME_H
+#define PAGE_CHROME_H
+
+#include <stdint.h>
+
+extern "C" {
+    #include "LCD_Framebuffer.h"
+}
+
+// The static part of a page: titles, labels and anything else that does
+// not change while the page is shown. It is drawn once and kept as color
+// runs of the page area; showing the page again puts the area back in one
+// pass over the framebuffer, and only the pixels that differ go out with
+// the next flush.
+class PageChrome {
+public:
+    PageChrome() = default;
+    ~PageChrome();
+    PageChrome(const PageChrome&) = delete;
+    PageChrome& operator=(const PageChrome&) = delete;
+
+    // Whether there is anything to restore
+    bool valid() const { return m_spans != nullptr; }
+
+    // Keep what the framebuffer shows in the area now
+    void capture(int xStart, int yStart, int xEnd, int yEnd);
+
+    // Put it back, over whatever the area shows
+    void restore() const;
+
+    // What the chrome shows changed, it has to be drawn again
+    void invalidate();
+
+    uint32_t getBytes() const { return m_count * sizeof(FB_SPAN); }
+
+private:
+    FB_SPAN* m_spans = nullptr;
+    uint32_t m_count = 0;
+    int m_xStart = 0;
+    int m_yStart = 0;
+    int m_xEnd = 0;
+    int m_yEnd = 0;
+};
+
+#endif // PAGE_CHROME_H
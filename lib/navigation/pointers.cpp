@@ -6,35 +6,107 @@ extern "C" {
 }
 
 Pointers::Pointers(NavigationGUI* gui) : m_gui(gui) {
+    Sprite_Init(&m_markSprite);
+    Sprite_Init(&m_tackSprite);
+}
+
+void Pointers::setRadius(int r) {
+    if (r == m_radius) {
+        return;
+    }
+
+    // The shapes on screen are about to be rebuilt
+    hide();
+    m_radius = r;
+}
+
+// Rasterize the pointers for every degree, the same pixels
+// GUI_DrawRadialTriangle and GUI_DrawRadialCircle would draw there
+void Pointers::buildShapes() {
+    int tackRadius = m_radius + TACK_OFFSET;
+    int outerRadius = tackRadius + 4;  // Tip of the arrow
+    int baseRadius = tackRadius + 20;  // Base of the arrow
+    float baseAngleOffset = 0.1;
+    int markRadius = m_radius + MARK_OFFSET;
+    std::vector<size_t> first(360);
+
+    // Offset of a point on a circle around the center, rounded the way the
+    // radial draws round screen coordinates
+    auto polarX = [](int r, float angle_rad) { return static_cast<int>(std::floor(r * FM_Cos(angle_rad))); };
+    auto polarY = [](int r, float angle_rad) { return static_cast<int>(std::floor(r * FM_Sin(angle_rad))); };
+
+    m_tackSpans.clear();
+    for (int deg = 0; deg < 360; deg++) {
+        float angle_rad = (deg - 90) * FM_DEG2RAD;  // 0 degrees at the top
+        int tipX = polarX(outerRadius, angle_rad);
+        int tipY = polarY(outerRadius, angle_rad);
+        int baseX1 = polarX(baseRadius, angle_rad + baseAngleOffset);
+        int baseY1 = polarY(baseRadius, angle_rad + baseAngleOffset);
+        int baseX2 = polarX(baseRadius, angle_rad - baseAngleOffset);
+        int baseY2 = polarY(baseRadius, angle_rad - baseAngleOffset);
+
+        SPRITE_SPAN spans[64];
+        Sprite_Triangle(&m_tackShapes[deg], spans, 64, tipX, tipY, baseX1, baseY1, baseX2, baseY2);
+        first[deg] = m_tackSpans.size();
+        m_tackSpans.insert(m_tackSpans.end(), spans, spans + m_tackShapes[deg].Span_Num);
+
+        m_markX[deg] = polarX(markRadius, angle_rad);
+        m_markY[deg] = polarY(markRadius, angle_rad);
+    }
+
+    // The pool has stopped growing, point the shapes into it
+    for (int deg = 0; deg < 360; deg++) {
+        m_tackShapes[deg].pSpans = m_tackSpans.data() + first[deg];
+    }
+
+    Sprite_Circle(&m_markShape, m_markSpans, 2 * MARK_SIZE + 1, MARK_SIZE);
+    m_cacheRadius = m_radius;
+}
+
+int Pointers::degreeIndex(float bearing_deg) {
+    int deg = static_cast<int>(lround(bearing_deg)) % 360;
+    return deg < 0 ? deg + 360 : deg;
+}
+
+void Pointers::showMark() {
+    Sprite_Show(&m_markSprite, &m_markShape,
+                m_centerX + m_markX[m_markIndex], m_centerY + m_markY[m_markIndex], YELLOW);
+}
+
+void Pointers::showTack() {
+    // If bearing on starboard, make pointer green
+    COLOR color = m_tackIndex > 180 ? GREEN : RED;
+    Sprite_Show(&m_tackSprite, &m_tackShapes[m_tackIndex], m_centerX, m_centerY, color);
 }
 
 // Update mark pointer
 void Pointers::updateMarkPointer(float bearing_deg) {
-    // Erase old pointer
-    if (m_prevMarkDeg >= 0) {
-        GUI_DrawRadialCircle(m_prevMarkDeg, 10, m_centerX, m_centerY, m_radius + 15, YELLOW);
+    if (m_cacheRadius != m_radius) {
+        buildShapes();
     }
 
-    // Draw new pointer
-    GUI_DrawRadialCircle(bearing_deg, 10, m_centerX, m_centerY, m_radius + 15, YELLOW);
-    m_prevMarkDeg = bearing_deg;
+    // The tack pointer may cover the mark, take it off and put it back on top
+    Sprite_Hide(&m_tackSprite);
+    m_markIndex = degreeIndex(bearing_deg);
+    showMark();
+    if (m_tackIndex >= 0) {
+        showTack();
+    }
 }
 
 // Update tack pointer
 void Pointers::updateTackPointer(float bearing_deg) {
-    // If bearing on starboard, make pointer green
-    if (bearing_deg > 180) {
-        GUI_DrawRadialTriangle(bearing_deg, m_radius - 5, m_centerX, m_centerY, GREEN, 1);
-    } else {
-        GUI_DrawRadialTriangle(bearing_deg, m_radius - 5, m_centerX, m_centerY, RED, 1);
+    if (m_cacheRadius != m_radius) {
+        buildShapes();
     }
 
-    // Erase old pointer
-    if (m_prevTackDeg >= 0) {
-        GUI_DrawRadialTriangle(m_prevTackDeg, m_radius - 5, m_centerX, m_centerY, BLACK, 1);
-    }
+    m_tackIndex = degreeIndex(bearing_deg);
+    showTack();
+}
 
-    // Draw new pointer
-    GUI_DrawRadialTriangle(bearing_deg, m_radius - 5, m_centerX, m_centerY, WHITE, 1);
-    m_prevTackDeg = bearing_deg;
-}
\ No newline at end of file
+void Pointers::hide() {
+    Sprite_Hide(&m_tackSprite);
+    Sprite_Hide(&m_markSprite);
+    m_tackIndex = -1;
+    m_markIndex = -1;
+}
@@ -1,8 +1,17 @@
 #ifndef POINTERS_H
 #define POINTERS_H
 
+#include <vector>
+
+extern "C" {
+    #include "LCD_Sprite.h"
+}
+
 class NavigationGUI; // Forward declaration
 
+// Pointers on the compass ring. Each is a save-under sprite, its shape for
+// every whole degree is rasterized once, so moving a pointer only restores
+// the pixels it covered and fills the new spans.
 class Pointers {
 public:
     Pointers(NavigationGUI* gui);
@@ -13,9 +22,12 @@ public:
     // Update tack pointer
     void updateTackPointer(float bearing_deg);
     
+    // Take both pointers off the screen, before drawing anything underneath them
+    void hide();
+    
     // Set center and radius
     void setCenter(int x, int y) { m_centerX = x; m_centerY = y; }
-    void setRadius(int r) { m_radius = r; }
+    void setRadius(int r);
     
 private:
     NavigationGUI* m_gui;
@@ -25,9 +37,30 @@ private:
     int m_centerY = 150;  // Center Y coordinate of the display
     int m_radius = 130;   // Radius of the circle
     
-    // Internal variables
-    float m_prevTackDeg = -1;  // -1 indicates "no arrow drawn"
-    float m_prevMarkDeg = -1;  // -1 indicates "no arrow drawn"
+    // Pointer sizes
+    static constexpr int MARK_SIZE = 10;    // Mark circle radius
+    static constexpr int MARK_OFFSET = 15;  // Mark circle center outside the ring
+    static constexpr int TACK_OFFSET = -5;  // Tack arrow radius relative to the ring
+    
+    // Shapes for every degree, built for m_cacheRadius
+    int m_cacheRadius = -1;
+    std::vector<SPRITE_SPAN> m_tackSpans;
+    SPRITE_SHAPE m_tackShapes[360];
+    SPRITE_SPAN m_markSpans[2 * MARK_SIZE + 1];
+    SPRITE_SHAPE m_markShape;
+    int16_t m_markX[360];  // Mark circle center relative to the ring center
+    int16_t m_markY[360];
+    void buildShapes();
+    
+    // The tack pointer is drawn over the mark pointer
+    SPRITE m_markSprite;
+    SPRITE m_tackSprite;
+    int m_markIndex = -1;  // Degree shown, -1 indicates "no pointer drawn"
+    int m_tackIndex = -1;
+    
+    static int degreeIndex(float bearing_deg);
+    void showMark();
+    void showTack();
 };
 
-#endif // POINTERS_H
\ No newline at end of file
+#endif // POINTERS_H
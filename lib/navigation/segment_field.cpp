@@ -0,0 +1,45 @@
+#include "segment_field.h"
+#include <string.h>
+
+SegmentField::SegmentField(int x, int y, uint16_t height, uint16_t foreground, uint16_t background)
+    : m_x(x), m_y(y), m_foreground(foreground), m_background(background) {
+    // The renderer clamps the same way, keep the cleared area in step with it
+    m_height = height < SEG_HEIGHT_MIN ? SEG_HEIGHT_MIN : height > SEG_HEIGHT_MAX ? SEG_HEIGHT_MAX : height;
+}
+
+void SegmentField::setText(const char* text) {
+    int len = strnlen(text, MAX_CHARS);
+    int shownLen = strlen(m_shown);
+
+    // Cells only line up with the old ones if every character has the same
+    // width, otherwise start over from a blank field
+    bool sameLayout = m_valid && len == shownLen;
+    for (int i = 0; sameLayout && i < len; i++) {
+        sameLayout = SEG_CharWidth(text[i], m_height) == SEG_CharWidth(m_shown[i], m_height);
+    }
+    if (m_valid && !sameLayout) {
+        clear();
+    }
+
+    int x = m_x;
+    for (int i = 0; i < len; i++) {
+        uint8_t redraw = sameLayout ? SEG_Encode(text[i]) ^ SEG_Encode(m_shown[i]) : SEG_ALL;
+        if (redraw) {
+            SEG_DrawChar(x, m_y, m_height, text[i], redraw, m_background, m_foreground);
+        }
+        x += SEG_CharWidth(text[i], m_height);
+    }
+
+    memcpy(m_shown, text, len);
+    m_shown[len] = '\0';
+    m_valid = true;
+}
+
+void SegmentField::clear() {
+    int width = getWidth();
+    if (width > 0) {
+        LCD_SetArealColor(m_x, m_y, m_x + width, m_y + m_height, m_background);
+    }
+    m_shown[0] = '\0';
+    m_valid = true;
+}
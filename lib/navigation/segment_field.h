@@ -0,0 +1,44 @@
+#ifndef SEGMENT_FIELD_H
+#define SEGMENT_FIELD_H
+
+#include <stdint.h>
+
+extern "C" {
+    #include "LCD_GUI.h"
+    #include "LCD_Segment.h"
+}
+
+// A fixed-position seven-segment number of any height. Like TextField it
+// remembers what is on screen; setText() redraws only the segments that
+// turn on or off, and whole cells only when the layout changes. The field
+// has to fit on the screen.
+class SegmentField {
+public:
+    SegmentField(int x, int y, uint16_t height, uint16_t foreground = WHITE, uint16_t background = BLACK);
+
+    // Show a number, see SEG_Encode for the characters
+    void setText(const char* text);
+
+    // Something drew over the field; the next setText() redraws every cell
+    void invalidate() { m_valid = false; }
+
+    // Blank the cells currently shown
+    void clear();
+
+    const char* getText() const { return m_shown; }
+    int getWidth() const { return SEG_StringWidth(m_shown, m_height); }
+
+    static constexpr int MAX_CHARS = 8;
+
+private:
+    int m_x;
+    int m_y;
+    uint16_t m_height;
+    uint16_t m_foreground;
+    uint16_t m_background;
+
+    char m_shown[MAX_CHARS + 1] = "";  // Text last drawn
+    bool m_valid = false;              // False when the screen may differ from m_shown
+};
+
+#endif // SEGMENT_FIELD_H
@@ -1,4 +1,5 @@
 #include "tack_detector.h"
+#include "fastmath.h"
 #include "pico/stdlib.h"
 #include <stdio.h>
 #include <algorithm>
@@ -9,6 +10,7 @@ TackDetector::TackDetector() {
     previous_heading = 0.0;
     is_on_starboard_tack = false;
     last_tack_time = 0;
+    tack_count = 0;
     
     // Initialize position and distance tracking
     last_lat = 0.0;
@@ -82,6 +84,7 @@ void TackDetector::update(float heading, float speed, uint32_t timestamp) {
                     // This is a valid tack - store the previous heading
                     last_tack_heading = previous_heading;
                     last_tack_time = timestamp;
+                    tack_count++;
                     is_on_starboard_tack = on_starboard_now;
                     
                     // Reset distance tracking
@@ -116,21 +119,19 @@ void TackDetector::updatePosition(float lat, float lon) {
 
 float TackDetector::normalizeAngle(float angle) const {
     // Normalize angle to 0-360 range
-    return fmod(angle + 360.0, 360.0);
+    return FM_Wrap360(angle);
 }
 
 float TackDetector::calculateDistance(float lat1, float lon1, float lat2, float lon2) const {
-    // Convert latitude and longitude from degrees to radians
-    float lat1_rad = lat1 * M_PI / 180.0;
-    float lon1_rad = lon1 * M_PI / 180.0;
-    float lat2_rad = lat2 * M_PI / 180.0;
-    float lon2_rad = lon2 * M_PI / 180.0;
-    
     // Haversine formula to calculate distance between two points on Earth
-    float dlon = lon2_rad - lon1_rad;
-    float dlat = lat2_rad - lat1_rad;
-    float a = sin(dlat/2) * sin(dlat/2) + cos(lat1_rad) * cos(lat2_rad) * sin(dlon/2) * sin(dlon/2);
-    float c = 2 * atan2(sqrt(a), sqrt(1-a));
+    float sinHalfDLat, cosHalfDLat, sinHalfDLon, cosHalfDLon, sinLat, cosLat1, cosLat2;
+    FM_SinCos((lat2 - lat1) * FM_DEG2RAD / 2, &sinHalfDLat, &cosHalfDLat);
+    FM_SinCos((lon2 - lon1) * FM_DEG2RAD / 2, &sinHalfDLon, &cosHalfDLon);
+    FM_SinCos(lat1 * FM_DEG2RAD, &sinLat, &cosLat1);
+    FM_SinCos(lat2 * FM_DEG2RAD, &sinLat, &cosLat2);
+
+    float a = sinHalfDLat * sinHalfDLat + cosLat1 * cosLat2 * sinHalfDLon * sinHalfDLon;
+    float c = 2 * FM_Atan2(sqrtf(a), sqrtf(1 - a));
     float distance = 6371000 * c; // Earth radius in meters
     
     return distance;
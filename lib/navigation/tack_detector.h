@@ -18,6 +18,7 @@ public:
     // Accessors
     float getLastTackHeading() const { return last_tack_heading; }
     bool isOnStarboardTack() const { return is_on_starboard_tack; }
+    uint32_t getTackCount() const { return tack_count; }
     
     // Configuration methods
     void setWindDirection(float direction) { WIND_DIRECTION = direction; }
@@ -33,6 +34,7 @@ private:
     float previous_heading;      // Previous heading for detecting changes
     bool is_on_starboard_tack;   // Track which tack the boat is on
     uint32_t last_tack_time;     // Time of the last tack for debouncing
+    uint32_t tack_count;         // Tacks since boot
     
     // Position and distance tracking
     float last_lat;              // Latitude at last heading change
@@ -0,0 +1,67 @@
+#include "text_field.h"
+#include <string.h>
+
+TextField::TextField(int x, int y, sFONT* font, uint16_t foreground, uint16_t background)
+    : m_x(x), m_y(y), m_font(font), m_foreground(foreground), m_background(background) {
+}
+
+void TextField::setStyle(sFONT* font, uint16_t foreground, uint16_t background) {
+    if (font == m_font && foreground == m_foreground && background == m_background) {
+        return;
+    }
+
+    // Blank the old cells first, a smaller font would not cover them
+    clear();
+    m_font = font;
+    m_foreground = foreground;
+    m_background = background;
+    m_valid = false;
+}
+
+void TextField::setText(const char* text) {
+    int len = strnlen(text, MAX_CHARS);
+    int shownLen = strlen(m_shown);
+
+    // Pad to the length on screen so a shorter value blanks the leftover cells
+    char cells[MAX_CHARS + 1];
+    memcpy(cells, text, len);
+    int count = len > shownLen ? len : shownLen;
+    memset(cells + len, ' ', count - len);
+    cells[count] = '\0';
+
+    // Redraw each run of cells that differs from what is shown
+    auto unchanged = [&](int i) { return m_valid && i < shownLen && cells[i] == m_shown[i]; };
+    int i = 0;
+    while (i < count) {
+        if (unchanged(i)) {
+            i++;
+            continue;
+        }
+        int start = i;
+        while (i < count && !unchanged(i)) {
+            i++;
+        }
+        drawCells(cells, start, i - start);
+    }
+
+    memcpy(m_shown, text, len);
+    m_shown[len] = '\0';
+    m_valid = true;
+}
+
+void TextField::clear() {
+    char blank[MAX_CHARS + 1];
+    int len = strlen(m_shown);
+    memset(blank, ' ', len);
+    blank[len] = '\0';
+    drawCells(blank, 0, len);
+    m_shown[0] = '\0';
+    m_valid = true;
+}
+
+void TextField::drawCells(const char* cells, int start, int count) {
+    char run[MAX_CHARS + 1];
+    memcpy(run, cells + start, count);
+    run[count] = '\0';
+    GUI_DisString_EN(m_x + start * m_font->Width, m_y, run, m_font, m_background, m_foreground);
+}
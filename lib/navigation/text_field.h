@@ -0,0 +1,47 @@
+#ifndef TEXT_FIELD_H
+#define TEXT_FIELD_H
+
+#include <stdint.h>
+
+extern "C" {
+    #include "LCD_GUI.h"
+}
+
+// A fixed-position line of text that remembers what it last put on screen.
+// setText() only redraws the character cells that differ from the last
+// rendered string, and nothing at all if the text did not change.
+class TextField {
+public:
+    TextField(int x, int y, sFONT* font, uint16_t foreground = WHITE, uint16_t background = BLACK);
+
+    // Show text, redrawing only the changed character cells
+    void setText(const char* text);
+
+    // Change font or colours; the next setText() redraws every cell
+    void setStyle(sFONT* font, uint16_t foreground, uint16_t background);
+
+    // Something drew over the field; the next setText() redraws every cell
+    // and still blanks cells left over from the longer of old and new text
+    void invalidate() { m_valid = false; }
+
+    // Blank the cells currently shown
+    void clear();
+
+    const char* getText() const { return m_shown; }
+
+    static constexpr int MAX_CHARS = 20;
+
+private:
+    int m_x;
+    int m_y;
+    sFONT* m_font;
+    uint16_t m_foreground;
+    uint16_t m_background;
+
+    char m_shown[MAX_CHARS + 1] = "";  // Text last drawn
+    bool m_valid = false;              // False when the screen may differ from m_shown
+
+    void drawCells(const char* cells, int start, int count);
+};
+
+#endif // TEXT_FIELD_H
@@ -21,6 +21,40 @@ void TimeSeriesPlot::addDataPoint(float vmg, float sog, uint32_t timestamp) {
         m_dataCount++;
     }
     
+    // Column of this sample, the window maps DATA_POINTS samples to WIDTH columns
+    int column = (m_slot * WIDTH) / DATA_POINTS;
+    m_slot = (m_slot + 1) % DATA_POINTS;
+    
+    // Moving on to a new column starts its envelope and blanks the far end of the gap
+    if (column != m_column) {
+        m_column = column;
+        m_columns[column].count = 0;
+        m_dirty[column] = true;
+        int blank = (column + GAP) % WIDTH;
+        m_columns[blank].count = 0;
+        m_dirty[blank] = true;
+    }
+    
+    // Grow the envelope, it only needs a redraw if it grew by a pixel
+    ColumnEnvelope& env = m_columns[column];
+    const float values[2] = { vmg, sog };
+    for (int s = 0; s < 2; s++) {
+        int16_t row = valueToRow(values[s]);
+        if (env.count == 0) {
+            env.top[s] = env.bottom[s] = row;
+        } else if (row < env.top[s]) {
+            env.top[s] = row;
+            m_dirty[column] = true;
+        } else if (row > env.bottom[s]) {
+            env.bottom[s] = row;
+            m_dirty[column] = true;
+        }
+        env.last[s] = row;
+    }
+    if (env.count < UINT8_MAX) {
+        env.count++;
+    }
+    
     // Update the last update time
     m_lastUpdate = timestamp;
 }
@@ -32,63 +66,33 @@ float TimeSeriesPlot::getLastSOG() const {
     return m_plotData[lastIndex].sog;
 }
 
-// Check if enough time has elapsed to update the plot
-bool TimeSeriesPlot::shouldUpdate(uint32_t currentTime) const {
-    // If this is the first update, always update
-    if (m_lastVisualUpdate == 0) return true;
-    
-    // Calculate elapsed time in seconds
-    uint32_t elapsedSecs = currentTime - m_lastVisualUpdate;
-    
-    // Update if enough time has elapsed
-    return elapsedSecs >= m_updateIntervalSecs;
-}
+// Fixed y-axis range, 0-8 knots over the plot height
+static constexpr float MAX_VALUE = 8.0f;
+static constexpr int NUM_GRID_LINES = 5; // 0, 2, 4, 6, 8 knots
 
-// Clear the plot area (only the data area to reduce flickering)
-void TimeSeriesPlot::clearPlotArea() {
-    // Clear only the data area with a black rectangle, leaving axes and labels intact
-    GUI_DrawRectangle(
-        X_START + 1, Y_START, 
-        X_END, Y_END - 1, 
-        LCD_BACKGROUND, DRAW_FULL, DOT_PIXEL_1X1
-    );
+// Screen row of a value, clamped to the plot area
+int TimeSeriesPlot::valueToRow(float value) const {
+    int row = Y_END - static_cast<int>(value * HEIGHT / MAX_VALUE);
+    return row < Y_START ? Y_START : row > Y_END - 1 ? Y_END - 1 : row;
 }
 
 // Draw the time series plot
 void TimeSeriesPlot::drawPlot() {
-    // Fixed y-axis range as requested (0-8 knots)
-    float minValue = 0;
-    float maxValue = 8;
-    float yScale = (float)HEIGHT / (maxValue - minValue);
-    
-    // Draw axes
-    GUI_DrawLine(X_START, Y_START, X_START, Y_END, WHITE, LINE_SOLID, DOT_PIXEL_1X1);
-    GUI_DrawLine(X_START, Y_END, X_END, Y_END, WHITE, LINE_SOLID, DOT_PIXEL_1X1);
+    // Draw axes, just outside the columns
+    LCD_SetArealColor(X_START - 1, Y_START, X_START, Y_END + 1, WHITE);
+    LCD_SetArealColor(X_START - 1, Y_END, X_END, Y_END + 1, WHITE);
     
-    // Draw horizontal grid lines
-    int numGridLines = 5; // 0, 2, 4, 6, 8 knots
-    for (int i = 0; i < numGridLines; i++) {
-        int y = Y_END - (i * HEIGHT) / (numGridLines - 1);
-        GUI_DrawLine(X_START, y, X_END, y, GRAY, LINE_DOTTED, DOT_PIXEL_1X1);
-        
-        // Draw y-axis labels (no decimal places)
+    // Draw y-axis labels (no decimal places) next to the horizontal grid lines
+    for (int i = 0; i < NUM_GRID_LINES; i++) {
+        int y = Y_END - (i * HEIGHT) / (NUM_GRID_LINES - 1);
         char label[10];
-        int value = (i * maxValue) / (numGridLines - 1);
+        int value = (i * MAX_VALUE) / (NUM_GRID_LINES - 1);
         snprintf(label, sizeof(label), "%d", value);
         GUI_DisString_EN(5, y - 8, label, &Font16, BLACK, WHITE);
     }
     
-    // Draw vertical grid lines (time markers)
-    int numTimeMarkers = 6; // 0, 1, 2, 3, 4, 5 minutes
-    for (int i = 0; i < numTimeMarkers; i++) {
-        int x = X_START + (i * WIDTH) / (numTimeMarkers - 1);
-        GUI_DrawLine(x, Y_START, x, Y_END, GRAY, LINE_DOTTED, DOT_PIXEL_1X1);
-        
-        // Draw x-axis labels (minutes) - fixed to show 5, 4, 3, 2, 1, 0
-        char label[10];
-        snprintf(label, sizeof(label), "%d", 5-i);
-        GUI_DisString_EN(x - 5, Y_END + 5, label, &Font16, BLACK, WHITE);
-    }
+    // The sweep has no fixed time positions, only a scale
+    GUI_DisString_EN(X_START + WIDTH / 2 - 50, Y_END + 3, "1 min/div", &Font16, BLACK, WHITE);
     
     // Draw centered legend
     int legendX = X_START + (WIDTH / 2) - 70; // Center position
@@ -100,73 +104,55 @@ void TimeSeriesPlot::drawPlot() {
     GUI_DrawLine(legendX + 70, Y_START - 12, legendX + 90, Y_START - 12, YELLOW, LINE_SOLID, DOT_PIXEL_1X1);
     GUI_DisString_EN(legendX + 95, Y_START - 18, "SOG", &Font16, BLACK, WHITE);
     
-    // If no data points, just return after drawing the axes and labels
-    if (m_dataCount == 0) {
-        return;
+    // Grid and data
+    for (int column = 0; column < WIDTH; column++) {
+        drawColumn(column);
+    }
+}
+
+// Draw the columns whose envelope changed since they were last drawn
+void TimeSeriesPlot::drawLatest() {
+    for (int column = 0; column < WIDTH; column++) {
+        if (m_dirty[column]) {
+            drawColumn(column);
+        }
     }
+}
+
+// Draw one column of the plot area: grid, then for each series the span
+// of its envelope, stretched to meet the last value of the column before
+void TimeSeriesPlot::drawColumn(int column) {
+    COLOR* pLine = LCD_GetLineBuf();
     
-    // Calculate the x scaling factor - always based on full buffer size
-    // Each pixel represents DATA_POINTS / WIDTH data points
-    float pointsPerPixel = (float)DATA_POINTS / WIDTH;
+    // Grid, dotted like LINE_DOTTED: two pixels on, one off
+    bool gridColumn = column % GRID_COLUMNS == GRID_COLUMNS - 1;
+    for (int row = 0; row < HEIGHT; row++) {
+        bool dot = gridColumn && row % 3 != 2;
+        pLine[row] = dot ? GRAY : LCD_BACKGROUND;
+    }
+    if (column % 3 != 2) {
+        for (int i = 1; i < NUM_GRID_LINES; i++) {
+            pLine[HEIGHT - (i * HEIGHT) / (NUM_GRID_LINES - 1)] = GRAY;
+        }
+    }
     
-    // Draw the data series
-    if (m_dataCount > 1) {
-        // Draw VMG data series
-        for (int x = 0; x < WIDTH - 1; x++) {
-            // Calculate the data indices for this pixel and the next
-            // X-axis is inverted: left is t-5min, right is current time
-            float dataIdx1 = pointsPerPixel * (WIDTH - 1 - x);
-            float dataIdx2 = pointsPerPixel * (WIDTH - x);
-            
-            // Convert to actual indices in the circular buffer
-            int bufferIdx1 = (m_dataIndex - 1 - (int)dataIdx1 + DATA_POINTS) % DATA_POINTS;
-            int bufferIdx2 = (m_dataIndex - 1 - (int)dataIdx2 + DATA_POINTS) % DATA_POINTS;
-            
-            // Skip if we don't have enough data yet (leave blank for non-existent data)
-            if (dataIdx1 >= m_dataCount || dataIdx2 >= m_dataCount) {
-                continue;
-            }
-            
-            // Calculate screen coordinates
-            int x1 = X_START + x;
-            int y1 = Y_END - (m_plotData[bufferIdx1].vmg - minValue) * yScale;
-            int x2 = X_START + x + 1;
-            int y2 = Y_END - (m_plotData[bufferIdx2].vmg - minValue) * yScale;
-            
-            // Ensure y values are within the plot area
-            y1 = (y1 < Y_START) ? Y_START : (y1 > Y_END) ? Y_END : y1;
-            y2 = (y2 < Y_START) ? Y_START : (y2 > Y_END) ? Y_END : y2;
-            
-            GUI_DrawLine(x1, y1, x2, y2, CYAN, LINE_SOLID, DOT_PIXEL_1X1);
+    // The gap and columns without data stay blank, SOG last so it ends up on top
+    const ColumnEnvelope& env = m_columns[column];
+    const ColumnEnvelope& prev = m_columns[(column - 1 + WIDTH) % WIDTH];
+    const COLOR colors[2] = { CYAN, YELLOW };
+    for (int s = 0; env.count > 0 && s < 2; s++) {
+        int top = env.top[s];
+        int bottom = env.bottom[s];
+        if (prev.count > 0) {
+            top = prev.last[s] < top ? prev.last[s] : top;
+            bottom = prev.last[s] > bottom ? prev.last[s] : bottom;
         }
-        
-        // Draw SOG data series
-        for (int x = 0; x < WIDTH - 1; x++) {
-            // Calculate the data indices for this pixel and the next
-            // X-axis is inverted: left is t-5min, right is current time
-            float dataIdx1 = pointsPerPixel * (WIDTH - 1 - x);
-            float dataIdx2 = pointsPerPixel * (WIDTH - x);
-            
-            // Convert to actual indices in the circular buffer
-            int bufferIdx1 = (m_dataIndex - 1 - (int)dataIdx1 + DATA_POINTS) % DATA_POINTS;
-            int bufferIdx2 = (m_dataIndex - 1 - (int)dataIdx2 + DATA_POINTS) % DATA_POINTS;
-            
-            // Skip if we don't have enough data yet (leave blank for non-existent data)
-            if (dataIdx1 >= m_dataCount || dataIdx2 >= m_dataCount) {
-                continue;
-            }
-            
-            // Calculate screen coordinates
-            int x1 = X_START + x;
-            int y1 = Y_END - (m_plotData[bufferIdx1].sog - minValue) * yScale;
-            int x2 = X_START + x + 1;
-            int y2 = Y_END - (m_plotData[bufferIdx2].sog - minValue) * yScale;
-            
-            // Ensure y values are within the plot area
-            y1 = (y1 < Y_START) ? Y_START : (y1 > Y_END) ? Y_END : y1;
-            y2 = (y2 < Y_START) ? Y_START : (y2 > Y_END) ? Y_END : y2;
-            
-            GUI_DrawLine(x1, y1, x2, y2, YELLOW, LINE_SOLID, DOT_PIXEL_1X1);
+        for (int r = top; r <= bottom; r++) {
+            pLine[r - Y_START] = colors[s];
         }
     }
-}
\ No newline at end of file
+    
+    LCD_SetWindow(X_START + column, Y_START, X_START + column + 1, Y_END);
+    LCD_WritePixels(pLine, HEIGHT);
+    m_dirty[column] = false;
+}
@@ -5,6 +5,11 @@
 
 class NavigationGUI; // Forward declaration
 
+// The plot is a sweep: the DATA_POINTS samples of the window are spread
+// over WIDTH columns written at a cursor that moves right and wraps around,
+// with a few blank columns ahead of it marking "now". Every column keeps
+// the min/max/last envelope of its samples, so a peak is never dropped,
+// and only columns whose envelope moved by a pixel are redrawn.
 class TimeSeriesPlot {
 public:
     TimeSeriesPlot(NavigationGUI* gui);
@@ -17,8 +22,8 @@ public:
     };
     
     // Plot methods
-    void drawPlot();
-    void clearPlotArea();
+    void drawPlot();        // Axes, labels and every column
+    void drawLatest();      // Only the columns whose envelope changed
     void addDataPoint(float vmg, float sog, uint32_t timestamp);
     
     // Constants for plot dimensions
@@ -29,27 +34,35 @@ public:
     static constexpr int HEIGHT = 160;       // Height of the plot area
     static constexpr int X_END = X_START + WIDTH;  // Right edge of plot
     static constexpr int Y_END = Y_START + HEIGHT; // Bottom edge of plot
+    static constexpr int GAP = 4;            // Blank columns ahead of the newest sample
+    static constexpr int GRID_COLUMNS = WIDTH / 5;  // Vertical grid spacing, one minute
     
     // Accessor methods
     int getDataCount() const { return m_dataCount; }
     float getLastSOG() const;
     uint32_t getLastUpdateTime() const { return m_lastUpdate; }
     
-    // Update interval configuration
-    void setUpdateInterval(uint32_t seconds) { m_updateIntervalSecs = seconds; }
-    uint32_t getUpdateInterval() const { return m_updateIntervalSecs; }
-    bool shouldUpdate(uint32_t currentTime) const;
-    void updateLastVisualTimestamp(uint32_t timestamp) { m_lastVisualUpdate = timestamp; }
-    uint32_t getLastVisualUpdateTime() const { return m_lastVisualUpdate; }
-    
 private:
     NavigationGUI* m_gui;
     PlotDataPoint m_plotData[DATA_POINTS]; // Circular buffer for plot data
     int m_dataIndex = 0;      // Current index in the circular buffer
     int m_dataCount = 0;      // Number of valid data points
     uint32_t m_lastUpdate = 0; // Last time the plot was updated
-    uint32_t m_lastVisualUpdate = 0; // Last time the plot was visually updated
-    uint32_t m_updateIntervalSecs = 1; // Update interval in seconds (default: 1 second)
+    
+    // Rows covered by the samples of one column, per series (VMG, SOG)
+    struct ColumnEnvelope {
+        int16_t top[2];       // Row of the highest value
+        int16_t bottom[2];    // Row of the lowest value
+        int16_t last[2];      // Row of the latest value, where the next column connects
+        uint8_t count;        // Samples in the column, 0 is blank
+    };
+    ColumnEnvelope m_columns[WIDTH] = {};
+    bool m_dirty[WIDTH] = {}; // Envelope changed since the column was drawn
+    int m_column = -1;        // Column of the latest sample
+    int m_slot = 0;           // Position of the next sample in the window, 0 to DATA_POINTS - 1
+    
+    int valueToRow(float value) const;
+    void drawColumn(int column);
 };
 
 #endif // TIMESERIES_H
\ No newline at end of file
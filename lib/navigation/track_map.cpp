@@ -0,0 +1,283 @@
+#include "track_map.h"
+#include "gui.h"
+#include <cstring>
+
+extern "C" {
+    #include "LCD_GUI.h"
+}
+
+// Track that dropped out of the window stays on screen this long before
+// the map is rasterized again to take it off
+static constexpr uint32_t EXPIRED_SECONDS = 60;
+
+static constexpr float METRES_PER_DEGREE = 111195.0f;  // Of latitude, on a 6371 km sphere
+
+TrackMap::TrackMap(NavigationGUI* gui) : m_gui(gui) {
+    Sprite_Init(&m_boatSprite);
+    Sprite_Circle(&m_boatShape, m_boatSpans, 2 * BOAT_SIZE + 1, BOAT_SIZE);
+}
+
+// Metres east and north of the first fix, flat over the few kilometres a map shows
+TrackMap::Point TrackMap::project(float lat, float lon) const {
+    return { (lon - m_lon0) * m_metresPerDegLon, (lat - m_lat0) * METRES_PER_DEGREE };
+}
+
+void TrackMap::addFix(float lat, float lon, uint32_t timestamp) {
+    if (!m_hasOrigin) {
+        m_lat0 = lat;
+        m_lon0 = lon;
+        m_metresPerDegLon = METRES_PER_DEGREE * FM_Cos(lat * FM_DEG2RAD);
+        m_hasOrigin = true;
+    }
+    Point p = project(lat, lon);
+
+    // Drop the track that left the window
+    while (m_tail != m_head && timestamp - vertex(m_tail).timestamp > HISTORY_SECONDS) {
+        m_tail++;
+    }
+
+    if (m_head == m_tail) {
+        keepVertex(p, timestamp);
+        m_runCount = 0;
+        return;
+    }
+
+    // Jitter while stationary is not track
+    const Point& last = m_runCount ? m_run[m_runCount - 1] : vertex(m_head - 1).p;
+    float dx = p.x - last.x;
+    float dy = p.y - last.y;
+    if (dx * dx + dy * dy < MIN_SPACING * MIN_SPACING) {
+        return;
+    }
+
+    // The held back fixes no longer lie along a line to this one: the last of
+    // them becomes a vertex and the run starts over from it
+    if (m_runCount == MAX_RUN || !runFits(p)) {
+        keepVertex(m_run[m_runCount - 1], m_runTime[m_runCount - 1]);
+        m_runCount = 0;
+    }
+    m_run[m_runCount] = p;
+    m_runTime[m_runCount] = timestamp;
+    m_runCount++;
+}
+
+// Whether every held back fix is within TOLERANCE of the segment from the
+// last vertex to p
+bool TrackMap::runFits(Point p) const {
+    const Point& a = vertex(m_head - 1).p;
+    float ex = p.x - a.x;
+    float ey = p.y - a.y;
+    float length2 = ex * ex + ey * ey;
+
+    for (int i = 0; i < m_runCount; i++) {
+        float qx = m_run[i].x - a.x;
+        float qy = m_run[i].y - a.y;
+        float t = length2 > 0 ? (qx * ex + qy * ey) / length2 : 0;
+        t = t < 0 ? 0 : t > 1 ? 1 : t;
+        float ox = qx - t * ex;
+        float oy = qy - t * ey;
+        if (ox * ox + oy * oy > TOLERANCE * TOLERANCE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TrackMap::keepVertex(Point p, uint32_t timestamp) {
+    // A full ring drops its oldest vertex
+    if (m_head - m_tail == MAX_VERTICES) {
+        m_tail++;
+    }
+    m_vertices[m_head % MAX_VERTICES] = {p, timestamp};
+    m_head++;
+}
+
+// Panel pixel of a point, clamped far enough out that clipping stays in range
+void TrackMap::toScreen(Point p, int32_t& x, int32_t& y) const {
+    float scale = 1.0f / METRES_PER_PIXEL[m_zoom];
+    float fx = (X_START + X_END) / 2 + (p.x - m_view.x) * scale;
+    float fy = (Y_START + Y_END) / 2 - (p.y - m_view.y) * scale;
+    fx = fx < -10000 ? -10000 : fx > 10000 ? 10000 : fx;
+    fy = fy < -10000 ? -10000 : fy > 10000 ? 10000 : fy;
+    x = static_cast<int32_t>(floorf(fx + 0.5f));
+    y = static_cast<int32_t>(floorf(fy + 0.5f));
+}
+
+// Where the boat is, the newest fix
+bool TrackMap::boatNearEdge() const {
+    Point boat = m_runCount ? m_run[m_runCount - 1] : vertex(m_head - 1).p;
+    int32_t x, y;
+    toScreen(boat, x, y);
+    return x < X_START + PAN_MARGIN || x >= X_END - PAN_MARGIN ||
+           y < Y_START + PAN_MARGIN || y >= Y_END - PAN_MARGIN;
+}
+
+void TrackMap::draw() {
+    if (m_head == m_tail) {
+        return;
+    }
+
+    // The boat is about to sail off the map, center it again
+    if (boatNearEdge()) {
+        m_view = m_runCount ? m_run[m_runCount - 1] : vertex(m_head - 1).p;
+        m_rasterize = true;
+    }
+
+    // Track that has been out of the window for a while comes off
+    if (vertex(m_tail).timestamp - m_shownFrom > EXPIRED_SECONDS) {
+        m_rasterize = true;
+    }
+
+    if (m_rasterize) {
+        rasterize();
+        return;
+    }
+
+    // Only the segments kept since the last frame, under the boat
+    if (m_drawnTo + 1 != m_head) {
+        Sprite_Hide(&m_boatSprite);
+        uint32_t from = m_drawnTo < m_tail ? m_tail : m_drawnTo;
+        for (uint32_t seq = from; seq + 1 < m_head; seq++) {
+            drawSegment(vertex(seq).p, vertex(seq + 1).p);
+        }
+        m_drawnTo = m_head - 1;
+    }
+    showBoat();
+}
+
+// Everything in the window: title, marks, the whole track and the boat
+void TrackMap::rasterize() {
+    Sprite_Hide(&m_boatSprite);
+    LCD_SetArealColor(X_START, TITLE_Y, X_END, Y_END, LCD_BACKGROUND);
+    drawTitle();
+    drawMarks();
+
+    for (uint32_t seq = m_tail; seq + 1 < m_head; seq++) {
+        drawSegment(vertex(seq).p, vertex(seq + 1).p);
+    }
+    m_drawnTo = m_head - 1;
+    m_shownFrom = vertex(m_tail).timestamp;
+    m_rasterize = false;
+
+    showBoat();
+}
+
+// Title and the width of the map at this zoom
+void TrackMap::drawTitle() {
+    char scaleStr[16];
+    float width = (X_END - X_START) * METRES_PER_PIXEL[m_zoom];
+    if (width >= 1000) {
+        snprintf(scaleStr, sizeof(scaleStr), "%.1f km", width / 1000);
+    } else {
+        snprintf(scaleStr, sizeof(scaleStr), "%.0f m", width);
+    }
+    GUI_DisString_EN(10, TITLE_Y, "TRACK", &Font24, BLACK, WHITE);
+    GUI_DisString_EN(X_END - 10 - strlen(scaleStr) * Font16.Width, TITLE_Y + 4, scaleStr, &Font16, BLACK, WHITE);
+}
+
+// A dot and the name of every mark that fits, the target stands out
+void TrackMap::drawMarks() {
+    const NavigationGUI::Target& target = m_gui->getCurrentTarget();
+    for (const Navigation::Mark& mark : Navigation::MARKS) {
+        int32_t x, y;
+        toScreen(project(mark.lat, mark.lon), x, y);
+        int32_t labelEnd = x + 6 + strlen(mark.name) * Font12.Width;
+        if (x - 3 < X_START || labelEnd > X_END || y - 6 < Y_START || y + 6 > Y_END) {
+            continue;
+        }
+
+        COLOR color = strcmp(mark.name, target.name) == 0 ? YELLOW : GRAY;
+        // The GUI draws one pixel up and left of the coordinates it is given
+        GUI_DrawCircle(x + 1, y + 1, 3, color, DRAW_FULL, DOT_PIXEL_1X1);
+        GUI_DisString_EN(x + 7, y - 5, mark.name, &Font12, BLACK, color);
+    }
+}
+
+const Navigation::Mark* TrackMap::markAt(int32_t x, int32_t y) const {
+    if (!m_hasOrigin) {
+        return nullptr;
+    }
+
+    const Navigation::Mark* nearest = nullptr;
+    int32_t nearest2 = TOUCH_RADIUS * TOUCH_RADIUS;
+    for (const Navigation::Mark& mark : Navigation::MARKS) {
+        int32_t mx, my;
+        toScreen(project(mark.lat, mark.lon), mx, my);
+        int32_t d2 = (mx - x) * (mx - x) + (my - y) * (my - y);
+        if (d2 <= nearest2) {
+            nearest = &mark;
+            nearest2 = d2;
+        }
+    }
+    return nearest;
+}
+
+// Outcode of a pixel against the map area
+static int outcode(int32_t x, int32_t y) {
+    return (x < TrackMap::X_START ? 1 : x >= TrackMap::X_END ? 2 : 0) |
+           (y < TrackMap::Y_START ? 4 : y >= TrackMap::Y_END ? 8 : 0);
+}
+
+// One segment of track, clipped to the map area (Cohen-Sutherland)
+void TrackMap::drawSegment(const Point& a, const Point& b) {
+    int32_t x0, y0, x1, y1;
+    toScreen(a, x0, y0);
+    toScreen(b, x1, y1);
+
+    int code0 = outcode(x0, y0);
+    int code1 = outcode(x1, y1);
+    while (code0 | code1) {
+        if (code0 & code1) {
+            return;
+        }
+        int code = code0 ? code0 : code1;
+        int32_t x, y;
+        if (code & 4) {
+            x = x0 + (x1 - x0) * (Y_START - y0) / (y1 - y0);
+            y = Y_START;
+        } else if (code & 8) {
+            x = x0 + (x1 - x0) * (Y_END - 1 - y0) / (y1 - y0);
+            y = Y_END - 1;
+        } else if (code & 1) {
+            y = y0 + (y1 - y0) * (X_START - x0) / (x1 - x0);
+            x = X_START;
+        } else {
+            y = y0 + (y1 - y0) * (X_END - 1 - x0) / (x1 - x0);
+            x = X_END - 1;
+        }
+        if (code == code0) {
+            x0 = x;
+            y0 = y;
+            code0 = outcode(x0, y0);
+        } else {
+            x1 = x;
+            y1 = y;
+            code1 = outcode(x1, y1);
+        }
+    }
+
+    GUI_DrawLine(x0 + 1, y0 + 1, x1 + 1, y1 + 1, CYAN, LINE_SOLID, DOT_PIXEL_1X1);
+}
+
+void TrackMap::showBoat() {
+    Point boat = m_runCount ? m_run[m_runCount - 1] : vertex(m_head - 1).p;
+    int32_t x, y;
+    toScreen(boat, x, y);
+    Sprite_Show(&m_boatSprite, &m_boatShape, x + 1, y + 1, WHITE);
+}
+
+void TrackMap::invalidate() {
+    // Whatever was under the boat is gone with the area
+    Sprite_Init(&m_boatSprite);
+    m_rasterize = true;
+}
+
+void TrackMap::hide() {
+    Sprite_Hide(&m_boatSprite);
+}
+
+void TrackMap::cycleZoom() {
+    m_zoom = (m_zoom + 1) % ZOOM_LEVELS;
+    printf("Map zoom: %.1f m per pixel\n", METRES_PER_PIXEL[m_zoom]);
+    m_rasterize = true;
+}
@@ -0,0 +1,116 @@
+#ifndef TRACK_MAP_H
+#define TRACK_MAP_H
+
+#include <stdint.h>
+#include "marks.h"
+
+extern "C" {
+    #include "LCD_Sprite.h"
+}
+
+class NavigationGUI; // Forward declaration
+
+// Breadcrumb map of the last HISTORY_SECONDS of track with the marks on it.
+// Fixes are projected to metres on a plane around the first one, and the
+// track is simplified as it comes in: the fixes since the last kept vertex
+// are held back while they stay within TOLERANCE of a straight line to the
+// newest one, a streaming form of Douglas-Peucker. Every kept vertex adds
+// one segment, drawn once, and the boat is a save-under sprite. The map is
+// only rasterized again when the view pans or zooms, or to drop old track.
+class TrackMap {
+public:
+    TrackMap(NavigationGUI* gui);
+
+    // Take in a fix, only draw() touches the screen
+    void addFix(float lat, float lon, uint32_t timestamp);
+
+    // New segments and the boat, or the whole map when the view changed
+    void draw();
+
+    // The area was cleared; the next draw() rasterizes everything
+    void invalidate();
+
+    // Take the boat off the screen, before drawing anything over the map
+    void hide();
+
+    // Next zoom level, from the widest back to the closest
+    void cycleZoom();
+
+    // The target changed, the marks are drawn again with the next draw()
+    void refresh() { m_rasterize = true; }
+
+    // The mark within TOUCH_RADIUS pixels of a point on the map, if any
+    const Navigation::Mark* markAt(int32_t x, int32_t y) const;
+
+    // Map area in panel pixels, end exclusive, under a line for the title
+    static constexpr int X_START = 0;
+    static constexpr int Y_START = 66;
+    static constexpr int X_END = 320;
+    static constexpr int Y_END = 275;
+    static constexpr int TITLE_Y = 40;
+
+    static constexpr uint32_t HISTORY_SECONDS = 600;  // Track kept, 10 minutes
+    static constexpr float TOLERANCE = 2.0f;          // Metres the simplified track may be off
+    static constexpr float MIN_SPACING = 1.0f;        // Metres a fix has to move to count
+    static constexpr int MAX_RUN = 16;                // Fixes held back at most
+    static constexpr int MAX_VERTICES = 512;          // Kept vertices, oldest dropped first
+    static constexpr int TOUCH_RADIUS = 20;           // Pixels a tap may miss a mark by
+
+private:
+    NavigationGUI* m_gui;
+
+    struct Point {
+        float x;    // Metres east of the origin
+        float y;    // Metres north of the origin
+    };
+
+    // Projection, set by the first fix
+    bool m_hasOrigin = false;
+    float m_lat0 = 0.0f;
+    float m_lon0 = 0.0f;
+    float m_metresPerDegLon = 0.0f;
+    Point project(float lat, float lon) const;
+
+    // Kept vertices, a ring indexed by sequence number
+    struct Vertex {
+        Point p;
+        uint32_t timestamp;
+    };
+    Vertex m_vertices[MAX_VERTICES];
+    uint32_t m_head = 0;     // Sequence number of the next vertex
+    uint32_t m_tail = 0;     // Sequence number of the oldest vertex
+    const Vertex& vertex(uint32_t seq) const { return m_vertices[seq % MAX_VERTICES]; }
+    void keepVertex(Point p, uint32_t timestamp);
+
+    // Fixes since the last kept vertex, the last one is where the boat is
+    Point m_run[MAX_RUN];
+    uint32_t m_runTime[MAX_RUN];
+    int m_runCount = 0;
+    bool runFits(Point p) const;
+
+    // View: the point at the center of the area and the metres per pixel
+    static constexpr int ZOOM_LEVELS = 5;
+    static constexpr float METRES_PER_PIXEL[ZOOM_LEVELS] = {20.0f, 10.0f, 5.0f, 2.5f, 1.0f};
+    static constexpr int PAN_MARGIN = 30;  // Pixels from the edge where the view recenters
+    Point m_view = {0.0f, 0.0f};
+    int m_zoom = 1;
+    bool m_rasterize = true;     // Everything has to be drawn again
+    uint32_t m_drawnTo = 0;      // Sequence number of the newest vertex on screen
+    uint32_t m_shownFrom = 0;    // Oldest timestamp on screen, older track is dropped by a rasterize
+    void toScreen(Point p, int32_t& x, int32_t& y) const;
+    bool boatNearEdge() const;
+
+    void rasterize();
+    void drawTitle();
+    void drawMarks();
+    void drawSegment(const Point& a, const Point& b);
+
+    // The boat
+    static constexpr int BOAT_SIZE = 3;
+    SPRITE_SPAN m_boatSpans[2 * BOAT_SIZE + 1];
+    SPRITE_SHAPE m_boatShape;
+    SPRITE m_boatSprite;
+    void showBoat();
+};
+
+#endif // TRACK_MAP_H
@@ -1,7 +1,13 @@
 #include "DEV_Config.h"
+#include "DEV_Bus.h"
 #include "MMC_SD.h"			   
+#include "hardware/dma.h"
 					   					   
 unsigned char  SD_Type=0;  //version of the sd card
+SD_STATS sSD_Stats;
+static bool SD_Bus_Held;   //from SD_Select to SD_DisSelect
+static uint32_t SD_Clock=SD_SPI_BAUDRATE_DEFAULT;  //what the card takes once initialized
+static int SD_Dma_Tx=-1,SD_Dma_Rx=-1;
 
 //data: data to be written to sd card.
 //return: data read from sd card.
@@ -11,53 +17,145 @@ unsigned char SD_SPI_ReadWriteByte(unsigned char CMD)
 //	return SPI_Read_Byte();
 }	  
 
-//set spi in low speed mode.
+//set spi in low speed mode, the card is only guaranteed 400 kHz until initialized.
 void SD_SPI_SpeedLow(void)
 {
-//	SPI1->CR1&=0XFFC7; 
-//	SPI1->CR1|=SPI_BaudRatePrescaler_256;
-//	SPI_Cmd(SPI1,ENABLE); 
+	DEV_Bus_SetClock(DEV_BUS_SD, SD_SPI_BAUDRATE_LOW);
 }
 
 
-//set spi in high speed mode.
+//set spi in high speed mode, as fast as the card said it goes.
 void SD_SPI_SpeedHigh(void)
 {
-//	SPI1->CR1&=0XFFC7; 
-//	SPI1->CR1|=SPI_BaudRatePrescaler_32;
-//	SPI_Cmd(SPI1,ENABLE); 
+	DEV_Bus_SetClock(DEV_BUS_SD, SD_Clock);
 }
 
+//exchange a run of bytes by DMA, the CPU only waits for the end.
+//tx: bytes to send, NULL sends 0xFF
+//rx: where the reply goes, NULL throws it away
+static void SD_SPI_Dma(const unsigned char *tx,unsigned char *rx,unsigned short len)
+{
+	static const unsigned char Fill=0xFF;
+	static unsigned char Sink;
+	dma_channel_config c;
+
+	if(SD_Dma_Rx<0){//before SD_Initialize
+		while(len--){
+			unsigned char r=SD_SPI_ReadWriteByte(tx?*tx++:0xFF);
+			if(rx)*rx++=r;
+		}
+		return;
+	}
 
-//released spi bus
-void SD_DisSelect(void)
+	c=dma_channel_get_default_config(SD_Dma_Tx);
+	channel_config_set_transfer_data_size(&c,DMA_SIZE_8);
+	channel_config_set_dreq(&c,spi_get_dreq(SPI_PORT,true));
+	channel_config_set_read_increment(&c,tx!=NULL);
+	channel_config_set_write_increment(&c,false);
+	dma_channel_configure(SD_Dma_Tx,&c,&spi_get_hw(SPI_PORT)->dr,tx?tx:&Fill,len,false);
+
+	c=dma_channel_get_default_config(SD_Dma_Rx);
+	channel_config_set_transfer_data_size(&c,DMA_SIZE_8);
+	channel_config_set_dreq(&c,spi_get_dreq(SPI_PORT,false));
+	channel_config_set_read_increment(&c,false);
+	channel_config_set_write_increment(&c,rx!=NULL);
+	dma_channel_configure(SD_Dma_Rx,&c,rx?rx:&Sink,&spi_get_hw(SPI_PORT)->dr,len,false);
+
+	//both at once, rx is done when the last byte has been clocked
+	dma_start_channel_mask((1u<<SD_Dma_Tx)|(1u<<SD_Dma_Rx));
+	dma_channel_wait_for_finish_blocking(SD_Dma_Rx);
+	sDev_SPI_Stats.Bytes+=len;
+	sDev_SPI_Stats.Transfers++;
+}
+
+
+//take the shared bus, the LCD and touch wait until SD_DisSelect
+static void SD_Bus_Take(void)
+{
+	if(SD_Bus_Held)
+		return;
+	DEV_Bus_Acquire(DEV_BUS_SD);
+	SD_Bus_Held = true;
+}
+
+//chip select high with the 8 clocks the card needs to let go of MISO
+static void SD_Park(void)
 {
 	DEV_Digital_Write(SD_CS_PIN,1);
  	SD_SPI_ReadWriteByte(0xff);//providing extra 8 clocks  
 }
 
+static void SD_Unpark(void)
+{
+	DEV_Digital_Write(SD_CS_PIN,0);
+}
+
+//released spi bus
+void SD_DisSelect(void)
+{
+	SD_Bus_Take();
+	SD_Park();
+	SD_Bus_Held = false;
+	DEV_Bus_Release(DEV_BUS_SD);
+}
+
 //pick sd card and waiting until until it's ready
 //return: 0: succed 1: failure
 unsigned char SD_Select(void)
 {
-	DEV_Digital_Write(SD_CS_PIN,0);
+	SD_Bus_Take();
+	SD_Unpark();
 	if(SD_WaitReady()==0)return 0; 
 	SD_DisSelect();
 	return 1;
 }
 
-//waiting for sd card until it's ready
+//waiting for sd card until it's ready, chip select low and the bus held.
+//a card that is still programming is deselected and left alone between polls,
+//the bus is free for the LCD and touch and the core sleeps until the next one.
+//return: 0 ready, 1 timed out
 unsigned char SD_WaitReady(void)
 {
-	unsigned int t=0;
-	do{
+	absolute_time_t Timeout;
+	uint64_t Start;
+	unsigned char t;
+
+	for(t=0;t<SD_BUSY_SPIN;t++)//most waits are over in a few bytes
 		if(SD_SPI_ReadWriteByte(0XFF) == 0XFF)
 			return 0;
-		t++;		  	
-	}while(t<0XFFFFFF);
+
+	Start=time_us_64();
+	Timeout=make_timeout_time_ms(SD_BUSY_TIMEOUT_MS);
+	do{
+		SD_Park();
+		SD_Bus_Held=false;
+		DEV_Bus_Release(DEV_BUS_SD);
+		sleep_us(SD_BUSY_POLL_US);//WFE until the alarm, or another event
+		SD_Bus_Take();
+		SD_Unpark();
+		if(SD_SPI_ReadWriteByte(0XFF) == 0XFF){
+			sSD_Stats.Busy_Us+=time_us_64()-Start;
+			return 0;
+		}
+	}while(!time_reached(Timeout));
+	sSD_Stats.Busy_Us+=time_us_64()-Start;
 	return 1;
 }
 
+//whether the card is done programming the last write, without waiting for it.
+//a caller with nothing else to do can come back later instead of sitting in
+//SD_WaitReady for up to SD_BUSY_TIMEOUT_MS.
+//return: 1 ready, 0 busy
+unsigned char SD_IsReady(void)
+{
+	unsigned char r;
+	SD_Bus_Take();
+	SD_Unpark();
+	r=SD_SPI_ReadWriteByte(0XFF);
+	SD_DisSelect();
+	return r==0XFF;
+}
+
 //waiting for response from sd card.
 //Response: expect from sd card.
 //return: succeed for 0, fail for other else 
@@ -81,10 +179,7 @@ unsigned char SD_RecvData(unsigned char *buf,unsigned short len)
 {			  	  
 	if(SD_GetResponse(0xFE))
 		return 1;//waiting for start command send back from sd card.
-    while(len--){//receiving data...
-        *buf = SD_SPI_ReadWriteByte(0xFF);
-        buf++;
-    }
+	SD_SPI_Dma(NULL,buf,len);//receiving data...
 
     //send 2 dummy write (dummy CRC)
     SD_SPI_ReadWriteByte(0xFF);
@@ -102,8 +197,7 @@ unsigned char SD_SendBlock(unsigned char*buf,unsigned char cmd)
 	if(SD_WaitReady())return 1;
 	SD_SPI_ReadWriteByte(cmd);
 	if(cmd!=0XFD){
-		for(t=0;t<512;t++)
-			SD_SPI_ReadWriteByte(buf[t]);
+		SD_SPI_Dma(buf,NULL,512);
 	    SD_SPI_ReadWriteByte(0xFF);//ignoring CRC
 	    SD_SPI_ReadWriteByte(0xFF);
 		t = SD_SPI_ReadWriteByte(0xFF);
@@ -197,6 +291,43 @@ uint32_t SD_GetSectorCount(void)
     return Capacity;
 }
 
+//ask for high speed mode (CMD6), up to 50 MHz instead of 25.
+//return: 0 switched, 1 the card stays in default speed
+static unsigned char SD_SwitchHighSpeed(void)
+{
+	unsigned char status[64];
+	unsigned char r1;
+
+	r1=SD_SendCmd(CMD6,0x00FFFFF1,0X01);//check function 1 of group 1
+	if(r1==0)r1=SD_RecvData(status,64);
+	SD_DisSelect();
+	if(r1||!(status[13]&0x02))return 1;
+
+	r1=SD_SendCmd(CMD6,0x80FFFFF1,0X01);//switch to it
+	if(r1==0)r1=SD_RecvData(status,64);
+	SD_DisSelect();
+	if(r1||(status[16]&0x0F)!=1)return 1;
+	return 0;
+}
+
+//the fastest clock the card takes, from TRAN_SPEED in the CSD.
+//return: Hz, capped at what the bus can do
+static uint32_t SD_GetMaxClock(void)
+{
+	static const uint8_t Mult[16]={0,10,12,13,15,20,25,30,35,40,45,50,55,60,70,80};
+	unsigned char csd[16];
+	uint32_t Rate,Unit;
+
+	if(SD_GetCSD(csd))return SD_SPI_BAUDRATE_DEFAULT;
+	//time value in tenths times 100 kbit/s, 1, 10 or 100 Mbit/s
+	Unit=csd[3]&0x07;
+	if(Unit>3)return SD_SPI_BAUDRATE_DEFAULT;
+	Rate=Mult[(csd[3]>>3)&0x0F]*10000;
+	while(Unit--)Rate*=10;
+	if(Rate==0)return SD_SPI_BAUDRATE_DEFAULT;
+	return Rate<SD_SPI_BAUDRATE_MAX?Rate:SD_SPI_BAUDRATE_MAX;
+}
+
 //initialize sd card 
 unsigned char SD_Initialize(void)
 {
@@ -207,6 +338,7 @@ unsigned char SD_Initialize(void)
    	
 	DEV_Digital_Write(SD_CS_PIN,1);
  	SD_SPI_SpeedLow();	
+	SD_Bus_Take();
  	for(i=0;i<10;i++)SD_SPI_ReadWriteByte(0XFF);
 	retry=20;
 	do
@@ -261,7 +393,20 @@ unsigned char SD_Initialize(void)
 		}
 	}
 	SD_DisSelect();
+	if(SD_Type)
+	{
+		if(SD_Type>=SD_TYPE_V2)SD_SwitchHighSpeed();
+		SD_Clock=SD_GetMaxClock();
+		if(SD_Dma_Rx<0)
+		{
+			SD_Dma_Tx=dma_claim_unused_channel(true);
+			SD_Dma_Rx=dma_claim_unused_channel(true);
+		}
+	}
 	SD_SPI_SpeedHigh();
+	SD_Bus_Take();//the new clock is set when the card gets the bus
+	sSD_Stats.Clock_Hz=DEV_Bus_GetClock();
+	SD_DisSelect();
 	if(SD_Type)return 0;
 	else if(r1)return r1; 	   
 	return 0xaa;
@@ -276,6 +421,8 @@ unsigned char SD_Initialize(void)
 uint8_t SD_ReadDisk(uint8_t *buf,uint32_t sector,uint8_t cnt)
 {
 	unsigned char r1;
+	uint64_t Start=time_us_64();
+	uint32_t n=cnt;
 	if(SD_Type!=SD_TYPE_V2HC)sector <<= 9;
 	if(cnt==1)
 	{
@@ -295,6 +442,8 @@ uint8_t SD_ReadDisk(uint8_t *buf,uint32_t sector,uint8_t cnt)
 		SD_SendCmd(CMD12,0,0X01);	
 	}   
 	SD_DisSelect();
+	sSD_Stats.Read_Bytes+=n*512;
+	sSD_Stats.Read_Us+=time_us_64()-Start;
 	return r1;//
 }
 
@@ -304,9 +453,13 @@ uint8_t SD_ReadDisk(uint8_t *buf,uint32_t sector,uint8_t cnt)
 //sector: start sector
 //cnt: totals of sectors]
 //return: 0 ok, other for failure
+//several sectors go in one CMD25, with the count sent ahead (ACMD23) so the
+//card can erase them all before the data arrives.
 uint8_t SD_WriteDisk(uint8_t *buf,uint32_t sector,uint8_t cnt)
 {
 	unsigned char r1;
+	uint64_t Start=time_us_64();
+	uint32_t n=cnt,Took;
 	if(SD_Type!=SD_TYPE_V2HC)sector *= 512;
 	if(cnt==1)
 	{
@@ -329,11 +482,18 @@ uint8_t SD_WriteDisk(uint8_t *buf,uint32_t sector,uint8_t cnt)
 			{
 				r1=SD_SendBlock(buf,0xFC); 
 				buf+=512;  
+				//the card is programming, it may be deselected until it is done
+				DEV_Bus_Yield(DEV_BUS_SD, SD_Park, SD_Unpark);
 			}while(--cnt && r1==0);
-			r1=SD_SendBlock(0,0xFD);
+			if(r1==0)r1=SD_SendBlock(0,0xFD);
+			else SD_SendBlock(0,0xFD);
 		}
 	}   
 	SD_DisSelect();
+	Took=time_us_64()-Start;
+	sSD_Stats.Write_Bytes+=n*512;
+	sSD_Stats.Write_Us+=Took;
+	if(Took>sSD_Stats.Write_Max_Us)sSD_Stats.Write_Max_Us=Took;
 	return r1;
 }	   
 
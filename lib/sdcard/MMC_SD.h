@@ -9,9 +9,18 @@
 #define SD_TYPE_V1      0X02
 #define SD_TYPE_V2      0X04
 #define SD_TYPE_V2HC    0X06	   
+
+#define SD_SPI_BAUDRATE_LOW		400000		//until the card is initialized
+#define SD_SPI_BAUDRATE_DEFAULT	25000000	//default speed, when the CSD says nothing better
+#define SD_SPI_BAUDRATE_MAX		50000000	//high speed mode
+
+#define SD_BUSY_SPIN		16		//polls before a busy card is left to program on its own
+#define SD_BUSY_POLL_US		100		//between polls after that
+#define SD_BUSY_TIMEOUT_MS	500		//longest write busy the spec allows
    
 #define CMD0    0       
 #define CMD1    1
+#define CMD6    6
 #define CMD8    8       
 #define CMD9    9       
 #define CMD10   10      
@@ -46,10 +55,25 @@ typedef unsigned char uint8_t;
 
 extern uint8_t  SD_Type;
 
+//transfer counters, sustained MB/s is bytes over microseconds
+typedef struct {
+	uint32_t Clock_Hz;		//SPI clock after SD_Initialize, as the port divides it
+	uint32_t Read_Bytes;
+	uint32_t Read_Us;
+	uint32_t Write_Bytes;
+	uint32_t Write_Us;		//in SD_WriteDisk, waiting out the card included
+	uint32_t Write_Max_Us;	//slowest SD_WriteDisk
+	uint32_t Busy_Us;		//card busy past SD_BUSY_SPIN polls, the bus was free
+} SD_STATS;
+extern SD_STATS sSD_Stats;
+
 uint8_t SD_SPI_ReadWriteByte(uint8_t data);
 void SD_SPI_SpeedLow(void);
 void SD_SPI_SpeedHigh(void);
+uint8_t SD_Select(void);
+void SD_DisSelect(void);
 uint8_t SD_WaitReady(void);							    
+uint8_t SD_IsReady(void);
 uint8_t SD_GetResponse(uint8_t Response);					
 uint8_t SD_Initialize(void);							
 uint8_t SD_ReadDisk(uint8_t*buf,uint32_t sector,uint8_t cnt);		
@@ -2,6 +2,7 @@
 #include <cmath>
 #include "pico/stdlib.h"
 #include "pico/multicore.h"
+#include "pico/flash.h"
 #include "hardware/watchdog.h"
 #include "pico/cyw43_arch.h"
 #include "hardware/gpio.h"
@@ -10,9 +11,18 @@
 #include "navigation/gui.h"
 #include "webserver.h"
 #include "gps_data.h"  // defines externs for filtered/raw data and mutexes
-#include "gps_logger.h"  // GPS logger for CSV logging
+#include "gps_logger.h"  // GPS logger, binary session logs
+extern "C" {
+    #include "MMC_SD.h"  // SD transfer counters
+}
 #include "config.h"
 
+// Print the 5 s status report on the console; the printf calls cost the
+// main loop a few ms each time
+#ifndef STATUS_REPORT
+#define STATUS_REPORT 0
+#endif
+
 // Define the GPIO pin for the button
 const uint BUTTON_PIN = 2;  // Using GPIO pin 2 as specified by user
 
@@ -23,6 +33,7 @@ static uint32_t last_button_time = 0;
 static uint32_t button_press_start_time = 0;
 static const uint32_t LONG_PRESS_DURATION = 3000;  // 3 seconds for long press
 static bool long_press_processed = false;  // Flag to track if long press was already processed
+static const uint32_t BATTERY_LOG_INTERVAL = 5000;  // ms between battery readings in the log
 
 // Forward declarations
 void button_callback(uint gpio, uint32_t events);
@@ -65,6 +76,13 @@ void core1_main() {
     printf("Starting GPS on Core 1 with UART interrupts...\n");
     l76b.init();
 
+    // Park here when core 0 writes flash, the touch calibration
+    flash_safe_execute_core_init();
+
+    // Stream the GUI's frames to the LCD from here, core 0 only draws them.
+    // Returns right away when the pipeline is compiled out.
+    FB_Pipeline_Run();
+
     while (true) {
         sleep_ms(100);
     }
@@ -106,6 +124,102 @@ void update_gps_buffer(
 }
 
 
+#if STATUS_REPORT
+// Frame, bus, log, SD and backlight figures on the console
+static void printStatus() {
+    const FrameScheduler::Stats& frames = navGui.getFrameStats();
+    printf("GUI frames: %u (%u dropped, %u over budget), %u us avg, %u us max; "
+        "last %u us (%u us waiting on the LCD), %u SPI bytes in %u transfers\n",
+        frames.frames, frames.dropped, frames.overruns, frames.averageUs(), frames.maxUs,
+        frames.lastUs, navGui.getLastFrameWaitUs(),
+        navGui.getLastFrameSpiBytes(), navGui.getLastFrameSpiTransfers());
+    navGui.resetFrameStats();
+
+    // Flush cost on the drawing core against how long frames take
+    // to reach the panel; set FB_PIPELINE to 0 for the single-core figures
+    static FB_STATS last_fb;
+    printf("LCD flushes (%s): %u in 5 s, %u pixels/s; last held core 0 for %u us, "
+        "on the panel after %u us (%u us max), %u us stalled on the pipeline\n",
+        FB_PIPELINE ? "core 1" : "core 0",
+        sFB_Stats.Flushes - last_fb.Flushes, (sFB_Stats.Pixels - last_fb.Pixels) / 5,
+        sFB_Stats.Hold_Us, sFB_Stats.Latency_Us, sFB_Stats.Latency_Max_Us,
+        sFB_Stats.Stall_Us - last_fb.Stall_Us);
+    last_fb = sFB_Stats;
+    sFB_Stats.Latency_Max_Us = 0;
+
+    // Touch only costs bus time while the screen is touched
+    static TP_STATS last_tp;
+    if (sTP_Stats.Irqs != last_tp.Irqs) {
+        printf("Touch: %u pen interrupts, %u bursts (%u rejected), %u us on the bus\n",
+            sTP_Stats.Irqs - last_tp.Irqs, sTP_Stats.Bursts - last_tp.Bursts,
+            sTP_Stats.Rejected - last_tp.Rejected, sTP_Stats.Bus_Us - last_tp.Bus_Us);
+        last_tp = sTP_Stats;
+    }
+
+    // Who waited for the shared SPI bus, and the longest anyone kept it
+    static DEV_BUS_STATS last_bus[DEV_BUS_NUM];
+    static const char* const bus_names[DEV_BUS_NUM] = {"LCD", "touch", "SD"};
+    printf("SPI bus:");
+    for (int i = 0; i < DEV_BUS_NUM; i++) {
+        DEV_BUS_STATS& bus = sDev_Bus_Stats[i];
+        printf(" %s %u grants, %u us waiting (%u max), held %u us max, %u yields%s",
+            bus_names[i], bus.Grants - last_bus[i].Grants, bus.Wait_Us - last_bus[i].Wait_Us,
+            bus.Wait_Max_Us, bus.Hold_Max_Us, bus.Yields - last_bus[i].Yields,
+            i + 1 < DEV_BUS_NUM ? ";" : "\n");
+        bus.Wait_Max_Us = 0;
+        bus.Hold_Max_Us = 0;
+        last_bus[i] = bus;
+    }
+
+    // How far the card is behind the streams, and what a write holds up the loop for
+    const GPSLogger::Stats& log_stats = gpsLogger.getStats();
+    const LogWriter::Stats& writer_stats = gpsLogger.getWriterStats();
+    if (gpsLogger.isInitialized()) {
+        printf("Log: %u records at %.1f bytes, %u NMEA sentences, %u battery readings, %u events "
+            "in %u/%u/%u/%u chunks (%u records dropped), %u queued; %u sector writes, "
+            "%u syncs, %u errors, %u passes the card was busy; last write %u us, slowest %u us; "
+            "file in %u fragments\n",
+            log_stats.records, log_stats.nibbles / 2.0f / (log_stats.records ? log_stats.records : 1),
+            log_stats.sentences, log_stats.readings, log_stats.events,
+            writer_stats.chunks[SCLOG_STREAM_FIXES], writer_stats.chunks[SCLOG_STREAM_NMEA],
+            writer_stats.chunks[SCLOG_STREAM_BATTERY], writer_stats.chunks[SCLOG_STREAM_EVENTS],
+            writer_stats.dropped, writer_stats.queued, writer_stats.sectorWrites,
+            writer_stats.syncs, writer_stats.errors, writer_stats.busy, writer_stats.lastUs, writer_stats.maxUs,
+            writer_stats.fragments);
+        gpsLogger.resetMaxUs();
+    }
+
+    // What the card sustains while the logger writes, and the slowest write
+    static SD_STATS last_sd;
+    if (sSD_Stats.Write_Us != last_sd.Write_Us) {
+        uint32_t written = sSD_Stats.Write_Bytes - last_sd.Write_Bytes;
+        printf("SD at %u kHz: %u kB written at %.2f MB/s sustained, worst write %u us, "
+            "%u us left to the card to program\n",
+            sSD_Stats.Clock_Hz / 1000, written / 1024,
+            (float)written / (sSD_Stats.Write_Us - last_sd.Write_Us),
+            sSD_Stats.Write_Max_Us, sSD_Stats.Busy_Us - last_sd.Busy_Us);
+        sSD_Stats.Write_Max_Us = 0;
+        last_sd = sSD_Stats;
+    }
+
+    // What the backlight dimming buys, from the INA219 readings
+    const Backlight& backlight = navGui.getBacklight();
+    Backlight::Runtime runtime;
+    if (backlight.getRuntime(runtime)) {
+        char rise[10] = "-", set[10] = "-";
+        if (backlight.getSunrise()) {
+            time_from_epoch(backlight.getSunrise(), rise, sizeof(rise));
+            time_from_epoch(backlight.getSunset(), set, sizeof(set));
+        }
+        printf("Backlight: level %u, %.0f%% duty on average; %.0f mA drawn, %.0f mA at full "
+            "brightness (backlight %.0f mA, %s): runtime x%.2f; sun %.1f deg, up %s to %s UTC\n",
+            backlight.getLevel(), runtime.averageDuty / 10, runtime.average_mA, runtime.full_mA,
+            runtime.backlight_mA, runtime.measured ? "measured" : "nominal",
+            runtime.full_mA / runtime.average_mA, backlight.getSunElevation(), rise, set);
+    }
+}
+#endif
+
 int main() {
     stdio_init_all();
     sleep_ms(1000);  // Allow USB CDC to settle for serial output
@@ -116,6 +230,7 @@ int main() {
     mutex_init(&filtered_data_mutex);
     mutex_init(&raw_data_mutex);
     mutex_init(&gps_buffer_mutex);
+    queue_init(&nmea_queue, sizeof(NMEASentence), NMEA_QUEUE_SIZE);
 
     // Initialize the button pin with interrupt
     printf("Setting up button on GPIO %d with interrupt...\n", BUTTON_PIN);
@@ -138,9 +253,12 @@ int main() {
 
     // server.start();
 
-    // Set time series update interval to 10 seconds
-    navGui.setTimeSeriesUpdateInterval(10);
     navGui.init();
+
+    // Every change of target goes to the log, from the button or a touch
+    navGui.setTargetListener([](const NavigationGUI::Target& target) {
+        gpsLogger.logEvent(SCLOG_EVENT_MARK, target.name);
+    });
     
     // We'll initialize the GPS logger after we get a valid GPS fix
     // This allows us to use the accurate GPS timestamp for the filename
@@ -148,6 +266,10 @@ int main() {
     
     multicore_launch_core1(core1_main);
     static uint32_t last_logged_timestamp = 0;
+    static uint32_t last_fix_timestamp = 0;
+    static uint16_t last_fix_ms = 0;
+    static uint32_t last_tack_count = 0;
+    static uint32_t last_battery_log_time = 0;
     static int wait_counter = 0;
 
     while (true) {
@@ -180,11 +302,11 @@ int main() {
                 
                 // Format as mmdd (month and day)
                 int mmdd = (tm_info->tm_mon + 1) * 100 + tm_info->tm_mday;
-                snprintf(filename, sizeof(filename), "gps%04d.csv", mmdd);
+                snprintf(filename, sizeof(filename), "gps%04d.scl", mmdd);
                 
                 printf("Using date (mmdd) for filename: %04d (from timestamp %u)\n", mmdd, raw_snapshot.timestamp);
                 
-                if (gpsLogger.init(filename)) {
+                if (gpsLogger.init(filename, raw_snapshot.timestamp)) {
                     printf("GPS logger initialized successfully with file: %s\n", filename);
                     logger_initialized = true;
                 } else {
@@ -192,6 +314,15 @@ int main() {
                 }
             }
 
+            // Log every fix, raw and filtered, at the receiver's rate
+            if (raw_snapshot.timestamp != last_fix_timestamp || raw_snapshot.ms != last_fix_ms) {
+                if (gpsLogger.isInitialized()) {
+                    gpsLogger.logData(raw_snapshot, filtered_snapshot);
+                }
+                last_fix_timestamp = raw_snapshot.timestamp;
+                last_fix_ms = raw_snapshot.ms;
+            }
+
             // Update the GPS buffer with both raw and filtered data
             // for ever 5 seconds
             if (
@@ -202,20 +333,23 @@ int main() {
 
                 update_gps_buffer(raw_snapshot, filtered_snapshot);
                 
-                // Log GPS data to CSV file
-                if (gpsLogger.isInitialized()) {
-                    if (gpsLogger.logData(raw_snapshot, filtered_snapshot)) {
-                        // Successful logging
-                    } else {
-                        printf("Error: Failed to log GPS data\n");
-                    }
-                }
-                
                 last_logged_timestamp = raw_snapshot.timestamp;
+
+#if STATUS_REPORT
+                printStatus();
+#endif
             }
 
             // navGui.update(raw_snapshot);
             navGui.update(filtered_snapshot);
+
+            // A tack the GUI just saw, with the heading it settled on
+            if (navGui.getTackCount() != last_tack_count) {
+                last_tack_count = navGui.getTackCount();
+                char heading[16];
+                snprintf(heading, sizeof(heading), "%.0f", navGui.getLastTackHeading());
+                gpsLogger.logEvent(SCLOG_EVENT_TACK, heading);
+            }
         } else {
             if (wait_counter++ % 1000 == 0) {
                 printf("Waiting for raw GPS fix...\n");
@@ -223,25 +357,57 @@ int main() {
             }
         }
 
+        // Render a frame if anything changed and one is due
+        navGui.service();
+
+        // NMEA sentences from core 1, into the log once it is open
+        NMEASentence sentence;
+        while (queue_try_remove(&nmea_queue, &sentence)) {
+            if (gpsLogger.isInitialized()) {
+                gpsLogger.logNmea(sentence.text, sentence.ms);
+            }
+        }
+
+        // The GUI reads the battery with every frame, the log takes the
+        // latest reading on its own clock, with a fix or without
+        uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+        if (gpsLogger.isInitialized() && now_ms - last_battery_log_time >= BATTERY_LOG_INTERVAL) {
+            gpsLogger.logBattery(navGui.getBacklight().getBatteryPercent(),
+                                 navGui.getBacklight().getBatteryCurrent());
+            last_battery_log_time = now_ms;
+        }
+
+        // Put queued log chunks on the card, one per pass; a battery about
+        // to give out syncs every record
+        float battery = navGui.getBacklight().getBatteryPercent();
+        gpsLogger.setLowBattery(battery >= 0.0f && battery < Backlight::LOW_BATTERY);
+        gpsLogger.service();
+
         // Check if button is currently pressed
         if (button_pressed_flag) {
             uint32_t current_time = to_ms_since_boot(get_absolute_time());
             uint32_t press_duration = current_time - button_press_start_time;
+            navGui.wakeBacklight();
             
             // Check for long press while button is still held down
             if (!long_press_processed && press_duration >= LONG_PRESS_DURATION) {
-                // Long press detected - toggle target mode
-                printf("Long press detected while holding (%u ms), toggling target mode\n", press_duration);
-                navGui.toggleTargetMode();
+                // Long press detected - next display mode
+                printf("Long press detected while holding (%u ms), cycling display mode\n", press_duration);
+                navGui.cycleDisplayMode();
+                gpsLogger.logEvent(SCLOG_EVENT_BUTTON, "long");
                 long_press_processed = true;  // Mark as processed to avoid multiple triggers
             }
             
             // Check if button was released
             if (button_released_flag) {
+                // Someone at the unit, maybe about to switch it off
+                gpsLogger.requestSync();
+
                 if (!long_press_processed) {
                     // Short press detected - cycle to next target
                     printf("Short press detected (%u ms), cycling to next target\n", press_duration);
                     navGui.cycleToNextTarget();
+                    gpsLogger.logEvent(SCLOG_EVENT_BUTTON, "short");
                 } else {
                     printf("Button released after long press, no additional action needed\n");
                 }
@@ -0,0 +1,18 @@
+// Runs FM_Benchmark() on the host: the accuracy figures are the ones the
+// target prints, the timings only compare the functions on this machine.
+//
+//   fastmath_bench
+
+#include "fastmath.h"
+#include <chrono>
+#include <cstdint>
+
+extern "C" uint64_t time_us_64(void) {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+int main() {
+    FM_Benchmark();
+    return 0;
+}
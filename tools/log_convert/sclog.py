@@ -0,0 +1,481 @@
+"""
+Convert Speed Cube binary session logs (.scl) to CSV, GPX and NMEA.
+
+The log layout is described in lib/gps_logger/log_format.h. Every 512-byte
+sector carries its own CRC, so a log cut short by a power loss is read up to
+the last sector that made it to the card; sectors that fail the check are
+skipped and reported. The logger preallocates the file, what follows the
+last sector of the session is left over on the card and ignored.
+
+A log holds streams: the fixes, the NMEA sentences, battery readings and
+events. Only the streams asked for are read, the index sectors tell where
+their chunks are.
+
+    python3 tools/log_convert/sclog.py gps1114.scl                # gps1114.csv, .nmea, _battery.csv, _events.csv
+    python3 tools/log_convert/sclog.py gps*.scl --format csv gpx --out-dir out/
+    python3 tools/log_convert/sclog.py gps1114.scl --streams battery events
+"""
+import argparse
+import math
+import struct
+import sys
+import zlib
+from datetime import datetime, timezone
+from pathlib import Path
+
+SECTOR = 512
+MAGIC_HEADER = 0x48474C53
+MAGIC_INDEX = 0x49474C53
+MAGIC_DATA = 0x44474C53
+MAGIC_TRAILER = 0x54474C53
+VERSIONS = (1, 2, 3)
+STREAMS = ("fixes", "nmea", "battery", "events")
+EVENTS = {1: "tack", 2: "mark", 3: "button"}
+
+SECTOR_HEAD = struct.Struct("<III")        # magic, session, sequence
+HEADER = struct.Struct("<HHHHI")           # version, record_size, records_per_sector, field_count, start_time
+FIELD = struct.Struct("<16s8sBBBBf")       # name, unit, type, offset, predict, reserved, scale
+DATA_HEAD = struct.Struct("<HH")           # count, reserved, after the sector head; up to version 2
+CHUNK_HEAD = struct.Struct("<HBBHHII")     # count, stream, reserved, length, reserved, first_ms, last_ms
+INDEX_HEAD = struct.Struct("<HH")          # count, reserved
+INDEX_ENTRY = struct.Struct("<B3xI")       # stream, first_ms
+INDEX_ENTRIES = (SECTOR - 4 - SECTOR_HEAD.size - INDEX_HEAD.size) // INDEX_ENTRY.size
+INDEX_SPAN = INDEX_ENTRIES + 1             # An index sector and the chunks it lists
+TEXT = struct.Struct("<IBB")               # time_ms, type, length, then the text
+BATTERY = struct.Struct("<Ihh")            # time_ms, 0.1 %, mA
+TRAILER = struct.Struct("<III")            # records, data_sectors, end_time
+TYPES = {1: "H", 2: "i", 3: "I"}
+PREDICT_NONE, PREDICT_DELTA, PREDICT_LINEAR, PREDICT_ANGLE = range(4)
+
+
+class Log:
+    """
+    A decoded log: its fields, its records and what the recovery scan found.
+
+    Attributes:
+        fields (list): (name, unit, struct format, offset, scale, decimals, predict)
+            per field.
+        records (list): One tuple of scaled values per fix, in field order.
+        nmea (list): (ms, sentence) per NMEA sentence, ms since start_time.
+        battery (list): (ms, percent, current_mA) per reading, percent below 0
+            while charging.
+        events (list): (ms, type, text) per event, type a name from EVENTS.
+        start_time (int): Session start, UTC seconds since the epoch.
+        closed (bool): Whether the trailer was found, the logger closed the file.
+        closed_records (int): Fixes the trailer says were logged.
+        bad_sectors (int): Sectors of this log that failed the session or CRC
+            check, from version 3 only those of the streams read.
+        missing (list): Data sequence numbers that were not found, from version
+            3 chunks that were listed but never written.
+        sectors_read (int): Sectors read from the file.
+    """
+
+    def __init__(self):
+        self.fields = []
+        self.records = []
+        self.nmea = []
+        self.battery = []
+        self.events = []
+        self.start_time = 0
+        self.closed = False
+        self.closed_records = 0
+        self.bad_sectors = 0
+        self.missing = []
+        self.sectors_read = 0
+
+
+def check_sector(sector):
+    """
+    Split a sector into its head and body if its CRC checks out.
+
+    Args:
+        sector (bytes): 512 bytes of the file.
+
+    Returns:
+        tuple: (magic, session, sequence, sector) or None when the CRC fails.
+    """
+    crc, = struct.unpack_from("<I", sector, SECTOR - 4)
+    if zlib.crc32(sector[:SECTOR - 4]) != crc:
+        return None
+    return SECTOR_HEAD.unpack_from(sector) + (sector,)
+
+
+def read_header(sector):
+    """
+    Read the record layout from the header sector.
+
+    Args:
+        sector (bytes): The header sector.
+
+    Returns:
+        tuple: (version, record_size, fields, start_time), fields as in Log.fields.
+    """
+    version, record_size, _, field_count, start_time = HEADER.unpack_from(sector, SECTOR_HEAD.size)
+    if version not in VERSIONS:
+        raise ValueError(f"log version {version}, this converter reads {VERSIONS}")
+    fields = []
+    for i in range(field_count):
+        name, unit, kind, offset, predict, _, scale = FIELD.unpack_from(
+            sector, SECTOR_HEAD.size + HEADER.size + i * FIELD.size)
+        # The scale is a float on the device, 1e-7 comes back as 1.0000000117e-07
+        scale = float(f"{scale:.7g}")
+        decimals = max(0, round(-math.log10(scale))) if scale < 1 else 0
+        fields.append((name.rstrip(b"\0").decode(), unit.rstrip(b"\0").decode(), "<" + TYPES[kind], offset, scale,
+                       decimals, predict))
+    return version, record_size, fields, start_time
+
+
+def nibbles(data):
+    """The nibbles of the coded records, low nibble of each byte first."""
+    for byte in data:
+        yield byte & 0x0F
+        yield byte >> 4
+
+
+def read_residual(code):
+    """One residual: 3 bits a nibble, low bits first, zigzag coded."""
+    value = shift = 0
+    while True:
+        nibble = next(code)
+        value |= (nibble & 7) << shift
+        shift += 3
+        if not nibble & 8:
+            return (value >> 1) ^ -(value & 1)
+
+
+def decode_sector(sector, version, record_size, fields):
+    """
+    The records of one data sector, stored values in field order.
+
+    Version 1 has fixed records. From version 2 the first record is whole, a
+    keyframe, and the others residuals against the records before them; see
+    lib/gps_logger/log_format.h. Version 3 has a longer chunk head.
+    """
+    count, _ = DATA_HEAD.unpack_from(sector, SECTOR_HEAD.size)
+    body = SECTOR_HEAD.size + (CHUNK_HEAD.size if version >= 3 else DATA_HEAD.size)
+    if version == 1:
+        return [[struct.unpack_from(fmt, sector, body + k * record_size + offset)[0]
+                 for _, _, fmt, offset, _, _, _ in fields] for k in range(count)]
+
+    names = [field[0] for field in fields]
+    stamp, ms = names.index("timestamp"), names.index("ms")
+    record = [struct.unpack_from(fmt, sector, body + offset)[0] for _, _, fmt, offset, _, _, _ in fields]
+    records = [record]
+    times = [record[stamp] * 1000 + record[ms]]
+    code = nibbles(sector[body + record_size:SECTOR - 4])
+    before = None
+    for _ in range(count - 1):
+        residual = read_residual(code)
+        times.append(residual + (2 * times[-1] - times[-2] if len(times) > 1 else times[-1]))
+        last = record
+        record = list(last)
+        record[stamp], record[ms] = divmod(times[-1], 1000)
+        for i, (_, _, _, _, scale, _, predict) in enumerate(fields):
+            if predict == PREDICT_NONE:
+                continue
+            residual = read_residual(code)
+            if predict == PREDICT_LINEAR and before is not None:
+                record[i] = residual + 2 * last[i] - before[i]
+            elif predict == PREDICT_ANGLE:
+                record[i] = (residual + last[i]) % round(360 / scale)
+            else:
+                record[i] = residual + last[i]
+        before = last
+        records.append(record)
+    return records
+
+
+def decode_text(sector):
+    """The (ms, type, text) records of an NMEA or events chunk."""
+    _, _, _, length, _, _, _ = CHUNK_HEAD.unpack_from(sector, SECTOR_HEAD.size)
+    offset = SECTOR_HEAD.size + CHUNK_HEAD.size
+    end = offset + length
+    records = []
+    while offset + TEXT.size <= end:
+        ms, kind, size = TEXT.unpack_from(sector, offset)
+        offset += TEXT.size
+        records.append((ms, kind, sector[offset:offset + size].decode("ascii", "replace")))
+        offset += size
+    return records
+
+
+def decode_battery(sector):
+    """The (ms, percent, current_mA) readings of a battery chunk."""
+    _, _, _, length, _, _, _ = CHUNK_HEAD.unpack_from(sector, SECTOR_HEAD.size)
+    body = SECTOR_HEAD.size + CHUNK_HEAD.size
+    return [(ms, percent / 10, current) for ms, percent, current in
+            BATTERY.iter_unpack(sector[body:body + length - length % BATTERY.size])]
+
+
+def read_sector(f, sequence):
+    """A sector of the file by its place, as check_sector, None past the end."""
+    f.seek(sequence * SECTOR)
+    sector = f.read(SECTOR)
+    return check_sector(sector) if len(sector) == SECTOR else None
+
+
+def scan_log(log, data, session, version, record_size):
+    """
+    Up to version 2: every sector is read, the data ones hold fixes in
+    sequence order.
+    """
+    sectors = [check_sector(data[offset:offset + SECTOR]) for offset in range(0, len(data) - SECTOR + 1, SECTOR)]
+    log.sectors_read = len(sectors)
+
+    # The file is preallocated: past the last sector of this session it holds
+    # whatever the card had there, and so may sectors of an older session
+    ours = [i for i, s in enumerate(sectors) if s and s[1] == session]
+    sectors = sectors[:ours[-1] + 1]
+    blocks = {}
+    for checked in sectors:
+        if checked is None or checked[1] != session:
+            log.bad_sectors += 1
+            continue
+        magic, _, sequence, sector = checked
+        if magic == MAGIC_DATA:
+            blocks[sequence] = sector
+        elif magic == MAGIC_TRAILER:
+            log.closed = True
+            log.closed_records, _, _ = TRAILER.unpack_from(sector, SECTOR_HEAD.size)
+
+    last = max(blocks, default=0)
+    log.missing = [sequence for sequence in range(1, last + 1) if sequence not in blocks]
+    for sequence in sorted(blocks):
+        for record in decode_sector(blocks[sequence], version, record_size, log.fields):
+            log.records.append(tuple(value * field[4] for value, field in zip(record, log.fields)))
+
+
+def find_chunks(log, f, session, wanted):
+    """
+    From version 3: the chunks of the wanted streams, from the index sectors.
+    Chunks an index was not written for, at the end of a log that was not
+    closed, are found by their heads.
+
+    Returns:
+        dict: Sequence to sector for the chunks that were read on the way,
+            None for those still to read.
+    """
+    chunks = {}
+    index_at = 1
+    while True:
+        index = read_sector(f, index_at)
+        log.sectors_read += 1
+        ours = index is not None and index[1] == session
+        if ours and index[0] == MAGIC_TRAILER:
+            log.closed = True
+            log.closed_records, _, _ = TRAILER.unpack_from(index[3], SECTOR_HEAD.size)
+            return chunks
+        listed = 0
+        if ours and index[0] == MAGIC_INDEX:
+            listed, _ = INDEX_HEAD.unpack_from(index[3], SECTOR_HEAD.size)
+            for i in range(listed):
+                stream, _ = INDEX_ENTRY.unpack_from(index[3], SECTOR_HEAD.size + INDEX_HEAD.size + i * INDEX_ENTRY.size)
+                if stream in wanted:
+                    chunks[index_at + 1 + i] = None
+        if listed == INDEX_ENTRIES:
+            index_at += INDEX_SPAN
+            continue
+
+        # The index is short or gone, the log ends in this span
+        found = ours
+        for sequence in range(index_at + 1 + listed, index_at + INDEX_SPAN):
+            checked = read_sector(f, sequence)
+            log.sectors_read += 1
+            if checked is None or checked[1] != session:
+                continue
+            found = True
+            magic, _, _, sector = checked
+            if magic == MAGIC_TRAILER:
+                log.closed = True
+                log.closed_records, _, _ = TRAILER.unpack_from(sector, SECTOR_HEAD.size)
+                return chunks
+            if magic == MAGIC_DATA and CHUNK_HEAD.unpack_from(sector, SECTOR_HEAD.size)[1] in wanted:
+                chunks[sequence] = sector
+        if not found:
+            return chunks
+        if index is None:
+            log.bad_sectors += 1
+        index_at += INDEX_SPAN
+
+
+def read_log(path, streams=STREAMS):
+    """
+    Decode a log, only the streams asked for from version 3.
+
+    Args:
+        path (Path): The .scl file.
+        streams (tuple): Names from STREAMS.
+
+    Returns:
+        Log: The decoded log.
+    """
+    log = Log()
+    with open(path, "rb") as f:
+        header = check_sector(f.read(SECTOR))
+        if header is None or header[0] != MAGIC_HEADER or header[2] != 0:
+            raise ValueError("no valid header sector")
+        session = header[1]
+        version, record_size, log.fields, log.start_time = read_header(header[3])
+        if version < 3:
+            f.seek(0)
+            scan_log(log, f.read(), session, version, record_size)
+            return log
+
+        wanted = {STREAMS.index(name) for name in streams}
+        chunks = find_chunks(log, f, session, wanted)
+        for sequence in sorted(chunks):
+            sector = chunks[sequence]
+            if sector is None:
+                checked = read_sector(f, sequence)
+                log.sectors_read += 1
+                if checked is None:
+                    log.bad_sectors += 1
+                    continue
+                if checked[:3] != (MAGIC_DATA, session, sequence):
+                    log.missing.append(sequence)
+                    continue
+                sector = checked[3]
+
+            stream = STREAMS[CHUNK_HEAD.unpack_from(sector, SECTOR_HEAD.size)[1]]
+            if stream == "fixes":
+                for record in decode_sector(sector, version, record_size, log.fields):
+                    log.records.append(tuple(value * field[4] for value, field in zip(record, log.fields)))
+            elif stream == "nmea":
+                log.nmea.extend((ms, text) for ms, _, text in decode_text(sector))
+            elif stream == "battery":
+                log.battery.extend(decode_battery(sector))
+            else:
+                log.events.extend((ms, EVENTS.get(kind, str(kind)), text) for ms, kind, text in decode_text(sector))
+    return log
+
+
+def format_time(seconds):
+    """Timestamp as the old CSV logs had it, MM/DD/YYYY HH:MM:SS UTC."""
+    return datetime.fromtimestamp(seconds, timezone.utc).strftime("%m/%d/%Y %H:%M:%S")
+
+
+def write_csv(log, path):
+    """
+    Write the records with one column per field, and the date and time after
+    the timestamp like the logger used to.
+
+    Args:
+        log (Log): The decoded log.
+        path (Path): Where to write.
+    """
+    names = [field[0] for field in log.fields]
+    with open(path, "w", encoding="utf-8") as f:
+        columns = []
+        for name in names:
+            columns.append(name)
+            if name == "timestamp":
+                columns.append("date_time")
+        f.write(",".join(columns) + "\n")
+        for record in log.records:
+            values = []
+            for (name, _, _, _, _, decimals, _), value in zip(log.fields, record):
+                values.append(f"{value:.{decimals}f}")
+                if name == "timestamp":
+                    values.append(format_time(int(value)))
+            f.write(",".join(values) + "\n")
+
+
+def session_time(log, ms):
+    """Session milliseconds as UTC seconds and the date and time, to the ms."""
+    seconds = log.start_time + ms / 1000
+    return f"{seconds:.3f}", format_time(int(seconds)) + f".{ms % 1000:03d}"
+
+
+def write_nmea(log, path):
+    """Write the NMEA sentences one to a line, as the receiver sent them."""
+    with open(path, "w", encoding="ascii", newline="\r\n") as f:
+        for _, sentence in log.nmea:
+            f.write(sentence + "\n")
+
+
+def write_battery(log, path):
+    """Write the battery readings, a percentage below 0 while charging."""
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("timestamp,date_time,percent,current_mA\n")
+        for ms, percent, current in log.battery:
+            f.write(",".join(session_time(log, ms)) + f",{percent:.1f},{current}\n")
+
+
+def write_events(log, path):
+    """Write the events, the text quoted."""
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("timestamp,date_time,event,text\n")
+        for ms, kind, text in log.events:
+            quoted = text.replace('"', '""')
+            f.write(",".join(session_time(log, ms)) + f',{kind},"{quoted}"\n')
+
+
+def write_gpx(log, path, track):
+    """
+    Write one GPX 1.1 track of the raw or filtered positions.
+
+    Args:
+        log (Log): The decoded log.
+        path (Path): Where to write.
+        track (str): "raw" or "filtered", which fields to take.
+    """
+    names = [field[0] for field in log.fields]
+    lat, lon = names.index(f"{track}_lat"), names.index(f"{track}_lon")
+    stamp = names.index("timestamp")
+    ms = names.index("ms") if "ms" in names else None
+    with open(path, "w", encoding="utf-8") as f:
+        f.write('<?xml version="1.0" encoding="UTF-8"?>\n'
+                '<gpx version="1.1" creator="speed-cube sclog.py" xmlns="http://www.topografix.com/GPX/1/1">\n'
+                f'  <trk><name>{Path(path).stem} {track}</name><trkseg>\n')
+        for record in log.records:
+            when = datetime.fromtimestamp(int(record[stamp]), timezone.utc).strftime("%Y-%m-%dT%H:%M:%S")
+            when += f".{int(record[ms]):03d}Z" if ms is not None else "Z"
+            f.write(f'    <trkpt lat="{record[lat]:.7f}" lon="{record[lon]:.7f}"><time>{when}</time></trkpt>\n')
+        f.write("  </trkseg></trk>\n</gpx>\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert Speed Cube .scl logs to CSV, GPX and NMEA.")
+    parser.add_argument("logs", nargs="+", type=Path, help="binary logs from the SD card")
+    parser.add_argument("--streams", nargs="+", choices=STREAMS, default=list(STREAMS), help="streams to read")
+    parser.add_argument("--format", nargs="+", choices=["csv", "gpx"], default=["csv"], help="outputs of the fixes")
+    parser.add_argument("--track", choices=["raw", "filtered"], default="filtered", help="positions for GPX")
+    parser.add_argument("--out-dir", type=Path, help="where to write, next to each log by default")
+    args = parser.parse_args()
+
+    failed = False
+    for path in args.logs:
+        try:
+            log = read_log(path, args.streams)
+        except (OSError, ValueError) as error:
+            print(f"{path}: {error}", file=sys.stderr)
+            failed = True
+            continue
+
+        # How the log ended: closed, or cut short and read up to the last good sector
+        state = f"closed with {log.closed_records} records" if log.closed else "not closed, recovered"
+        print(f"{path}: {len(log.records)} records, {len(log.nmea)} NMEA sentences, {len(log.battery)} battery "
+              f"readings and {len(log.events)} events from {format_time(log.start_time)}, {state}; "
+              f"{log.sectors_read} sectors read, {log.bad_sectors} bad, {len(log.missing)} data sectors missing",
+              file=sys.stderr)
+
+        out_dir = args.out_dir or path.parent
+        out_dir.mkdir(parents=True, exist_ok=True)
+        if "fixes" in args.streams:
+            for kind in args.format:
+                out = out_dir / (path.stem + "." + kind)
+                if kind == "csv":
+                    write_csv(log, out)
+                else:
+                    write_gpx(log, out, args.track)
+        if log.nmea:
+            write_nmea(log, out_dir / (path.stem + ".nmea"))
+        if log.battery:
+            write_battery(log, out_dir / (path.stem + "_battery.csv"))
+        if log.events:
+            write_events(log, out_dir / (path.stem + "_events.csv"))
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,277 @@
+"""
+Round trip of the session log: lib/gps_logger writes it, sclog.py reads it.
+
+log_roundtrip, from the tools/virtual_panel host build, runs GPSLogger and
+LogWriter on an SD card in RAM and copies each log out with a list of what
+went into it. These tests read the logs back and check the two agree. ctest
+runs them, or by hand:
+
+    python3 tools/log_convert/test_sclog.py build-host/log_roundtrip
+"""
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+import sclog  # noqa: E402
+
+HARNESS = None
+OUT = None
+CHUNK_BYTES = sclog.SECTOR - 4 - sclog.SECTOR_HEAD.size - sclog.CHUNK_HEAD.size
+RECORD_BYTES = 50                           # Longest coded fix, 99 nibbles
+FIXES = sclog.STREAMS.index("fixes")
+
+
+def f32(value):
+    """A double rounded to a float, as the device has it."""
+    return struct.unpack("<f", struct.pack("<f", value))[0]
+
+
+def stored_fix(lat, lon, speed, course):
+    """
+    What GPSLogger stores for one set of values: positions in 1e-6 degrees,
+    speeds in 0.01 kt and courses in 0.01 degrees, a whole turn taken off.
+    """
+    centi = 0 if speed <= 0 else 65535 if speed >= f32(655.35) else int(f32(f32(speed * 100) + 0.5))
+    return [round(lat * 1e6), round(lon * 1e6), centi, round(f32(course * 100)) % 36000]
+
+
+class Expected:
+    """
+    What log_roundtrip logged, from its NAME.expect: fixes as the stored
+    values, the other streams as sclog.Log has them.
+    """
+
+    def __init__(self, path):
+        self.fixes = []
+        self.nmea = []
+        self.battery = []
+        self.events = []
+        self.closed = None
+        for line in Path(path).read_text().splitlines():
+            kind, _, rest = line.partition(" ")
+            if kind == "fix":
+                values = rest.split()
+                floats = [float.fromhex(value) for value in values[2:]]
+                self.fixes.append([int(values[0]), int(values[1])] + stored_fix(*floats[:4]) + stored_fix(*floats[4:]))
+            elif kind == "nmea":
+                ms, text = rest.split(" ", 1)
+                self.nmea.append((int(ms), text))
+            elif kind == "battery":
+                ms, percent, current = rest.split()
+                self.battery.append((int(ms), round(f32(float.fromhex(percent) * 10)) / 10,
+                                     round(float.fromhex(current))))
+            elif kind == "event":
+                ms, event, text = rest.split(" ", 2)
+                self.events.append((int(ms), sclog.EVENTS[int(event)], text))
+            elif kind == "closed":
+                self.closed = rest == "1"
+
+
+def stored(log):
+    """The fixes of a decoded log as stored values, in field order."""
+    return [[round(value / field[4]) for value, field in zip(record, log.fields)] for record in log.records]
+
+
+def chunks(path, stream):
+    """
+    The chunks of one stream, found by reading every sector of the log, not
+    through the index.
+
+    Returns:
+        list: (sequence, length, records) per chunk in sequence order, fixes
+            as stored values, the other streams as their sclog.decode_*.
+    """
+    data = Path(path).read_bytes()
+    _, session, _, header = sclog.check_sector(data[:sclog.SECTOR])
+    version, record_size, fields, _ = sclog.read_header(header)
+    found = []
+    for offset in range(sclog.SECTOR, len(data) - sclog.SECTOR + 1, sclog.SECTOR):
+        checked = sclog.check_sector(data[offset:offset + sclog.SECTOR])
+        if checked is None or checked[1] != session:
+            continue
+        magic, _, sequence, sector = checked
+        if magic == sclog.MAGIC_TRAILER:
+            break
+        if magic != sclog.MAGIC_DATA:
+            continue
+        _, kind, _, length, _, _, _ = sclog.CHUNK_HEAD.unpack_from(sector, sclog.SECTOR_HEAD.size)
+        if kind != stream:
+            continue
+        if stream == FIXES:
+            records = sclog.decode_sector(sector, version, record_size, fields)
+        elif sclog.STREAMS[stream] == "battery":
+            records = sclog.decode_battery(sector)
+        else:
+            records = sclog.decode_text(sector)
+        found.append((sequence, length, records))
+    return found
+
+
+def setUpModule():
+    global OUT
+    OUT = tempfile.TemporaryDirectory()
+    subprocess.run([HARNESS, OUT.name], check=True, stdout=subprocess.DEVNULL)
+
+
+def tearDownModule():
+    OUT.cleanup()
+
+
+class SailTest(unittest.TestCase):
+    """Five minutes of fixes with the other streams beside them, closed."""
+
+    @classmethod
+    def setUpClass(cls):
+        cls.path = Path(OUT.name) / "sail.scl"
+        cls.log = sclog.read_log(cls.path)
+        cls.expected = Expected(Path(OUT.name) / "sail.expect")
+
+    def test_closed(self):
+        self.assertTrue(self.expected.closed)
+        self.assertTrue(self.log.closed)
+        self.assertEqual(self.log.closed_records, len(self.expected.fixes))
+        self.assertEqual(self.log.bad_sectors, 0)
+        self.assertEqual(self.log.missing, [])
+
+    def test_fixes(self):
+        self.assertEqual(len(self.log.records), len(self.expected.fixes))
+        for i, (got, want) in enumerate(zip(stored(self.log), self.expected.fixes)):
+            self.assertEqual(got, want, f"fix {i}")
+
+    def test_course_wraps(self):
+        # The raw course crosses north both ways, the residual is taken the
+        # short way round and the sum put back in the turn
+        raw_course = [fix[5] for fix in self.expected.fixes]
+        steps = [b - a for a, b in zip(raw_course, raw_course[1:])]
+        self.assertTrue(any(step > 18000 for step in steps))
+        self.assertTrue(any(step < -18000 for step in steps))
+        self.assertEqual([fix[5] for fix in stored(self.log)], raw_course)
+
+    def test_time_jump_starts_a_keyframe(self):
+        # 40 days are more than a 32-bit residual, the fix after the jump
+        # starts a chunk while the one before still had room
+        times = [fix[0] * 1000 + fix[1] for fix in self.expected.fixes]
+        jump = next(i for i in range(1, len(times)) if times[i] - times[i - 1] > 2 ** 31)
+        found = chunks(self.path, FIXES)
+        starts = [records[0][:2] for _, _, records in found]
+        self.assertIn(self.expected.fixes[jump][:2], starts)
+        before = found[starts.index(self.expected.fixes[jump][:2]) - 1]
+        self.assertLess(before[1], CHUNK_BYTES - RECORD_BYTES)
+
+    def test_chunks_roll_over(self):
+        # Each chunk decodes on its own from its keyframe, together they are
+        # every fix; all but the last and the one cut by the jump are full
+        found = chunks(self.path, FIXES)
+        self.assertGreater(len(found), 10)
+        records = [record for _, _, chunk in found for record in chunk]
+        self.assertEqual(records, self.expected.fixes)
+        full = [length >= CHUNK_BYTES - RECORD_BYTES for _, length, _ in found[:-1]]
+        self.assertEqual(full.count(False), 1)
+
+    def test_other_streams(self):
+        self.assertEqual(self.log.nmea, self.expected.nmea)
+        self.assertEqual(self.log.battery, self.expected.battery)
+        self.assertEqual(self.log.events, self.expected.events)
+
+
+class SpanTest(unittest.TestCase):
+    """Battery readings that fill the chunks of the first index span exactly."""
+
+    @classmethod
+    def setUpClass(cls):
+        cls.path = Path(OUT.name) / "span.scl"
+        cls.log = sclog.read_log(cls.path)
+        cls.expected = Expected(Path(OUT.name) / "span.expect")
+
+    def test_index_fills(self):
+        # The last chunk of the span is full and still filling at the close,
+        # the trailer takes the next index's place
+        with open(self.path, "rb") as f:
+            index = sclog.read_sector(f, 1)
+            trailer = sclog.read_sector(f, 1 + sclog.INDEX_SPAN)
+        self.assertEqual(index[0], sclog.MAGIC_INDEX)
+        self.assertEqual(sclog.INDEX_HEAD.unpack_from(index[3], sclog.SECTOR_HEAD.size)[0], sclog.INDEX_ENTRIES)
+        self.assertEqual(trailer[0], sclog.MAGIC_TRAILER)
+        self.assertEqual(self.path.stat().st_size, (sclog.INDEX_SPAN + 2) * sclog.SECTOR)
+        found = chunks(self.path, sclog.STREAMS.index("battery"))
+        self.assertEqual(len(found), sclog.INDEX_ENTRIES)
+        self.assertTrue(all(length == CHUNK_BYTES for _, length, _ in found))
+
+    def test_readings(self):
+        self.assertTrue(self.log.closed)
+        self.assertEqual(self.log.battery, self.expected.battery)
+        self.assertEqual(self.log.bad_sectors, 0)
+        self.assertEqual(self.log.missing, [])
+
+
+class CutTest(unittest.TestCase):
+    """
+    Fixes and NMEA into the second index span, never synced, the power cut:
+    the second index and the filling chunks are not on the card.
+    """
+
+    @classmethod
+    def setUpClass(cls):
+        cls.path = Path(OUT.name) / "cut.scl"
+        cls.log = sclog.read_log(cls.path)
+        cls.expected = Expected(Path(OUT.name) / "cut.expect")
+
+    def test_not_closed(self):
+        self.assertFalse(self.expected.closed)
+        self.assertFalse(self.log.closed)
+        with open(self.path, "rb") as f:
+            self.assertIsNone(sclog.read_sector(f, 1 + sclog.INDEX_SPAN))
+        self.assertEqual(self.log.bad_sectors, 1)
+        self.assertEqual(self.log.missing, [])
+
+    def test_recovered(self):
+        # Each stream reads back up to its filling chunk, including the
+        # chunks of the second span found by their heads
+        for stream, got, want in ((FIXES, stored(self.log), self.expected.fixes),
+                                  (sclog.STREAMS.index("nmea"), self.log.nmea, self.expected.nmea)):
+            found = chunks(self.path, stream)
+            self.assertGreater(found[-1][0], 1 + sclog.INDEX_SPAN)
+            self.assertEqual(got, want[:len(got)])
+            lost = len(want) - len(got)
+            self.assertGreater(lost, 0)
+            self.assertLessEqual(lost, max(len(records) for _, _, records in found))
+
+
+class StreamsTest(unittest.TestCase):
+    """Only the battery and events of the sail log, through the index."""
+
+    @classmethod
+    def setUpClass(cls):
+        cls.path = Path(OUT.name) / "sail.scl"
+        cls.expected = Expected(Path(OUT.name) / "sail.expect")
+
+    def test_read_log(self):
+        log = sclog.read_log(self.path, ("battery", "events"))
+        self.assertEqual(log.records, [])
+        self.assertEqual(log.nmea, [])
+        self.assertEqual(log.battery, self.expected.battery)
+        self.assertEqual(log.events, self.expected.events)
+        self.assertTrue(log.closed)
+        self.assertLess(log.sectors_read, sclog.read_log(self.path).sectors_read // 4)
+
+    def test_command_line(self):
+        with tempfile.TemporaryDirectory() as out:
+            subprocess.run([sys.executable, str(Path(sclog.__file__)), str(self.path), "--streams", "battery",
+                            "events", "--out-dir", out], check=True, stderr=subprocess.DEVNULL)
+            written = sorted(path.name for path in Path(out).iterdir())
+            self.assertEqual(written, ["sail_battery.csv", "sail_events.csv"])
+            lines = (Path(out) / "sail_battery.csv").read_text().splitlines()
+            self.assertEqual(len(lines), len(self.expected.battery) + 1)
+            lines = (Path(out) / "sail_events.csv").read_text().splitlines()
+            self.assertEqual(len(lines), len(self.expected.events) + 1)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        sys.exit("usage: test_sclog.py <log_roundtrip> [unittest options]")
+    HARNESS = sys.argv.pop(1)
+    unittest.main()
@@ -0,0 +1,32 @@
+#pragma once
+#include "pico/stdlib.h"
+
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+typedef struct { uint32_t size, read_increment, write_increment, dreq; } dma_channel_config;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int dma_claim_unused_channel(bool required);
+dma_channel_config dma_channel_get_default_config(uint channel);
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) { c->size = size; }
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr) { c->read_increment = incr; }
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr) { c->write_increment = incr; }
+static inline void channel_config_set_dreq(dma_channel_config *c, uint dreq) { c->dreq = dreq; }
+void dma_channel_configure(uint channel, const dma_channel_config *c, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
+// There is only DMA_IRQ_0 on the host, the index is ignored
+static inline void dma_irqn_set_channel_enabled(uint irq_index, uint channel, bool enabled) { (void)irq_index; dma_channel_set_irq0_enabled(channel, enabled); }
+static inline bool dma_irqn_get_channel_status(uint irq_index, uint channel) { (void)irq_index; return dma_channel_get_irq0_status(channel); }
+static inline void dma_irqn_acknowledge_channel(uint irq_index, uint channel) { (void)irq_index; dma_channel_acknowledge_irq0(channel); }
+void dma_channel_wait_for_finish_blocking(uint channel);
+void dma_channel_abort(uint channel);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,19 @@
+#pragma once
+#include "pico/stdlib.h"
+
+typedef void (*irq_handler_t)(void);
+enum { DMA_IRQ_0 = 10, DMA_IRQ_1 = 11, IO_IRQ_BANK0 = 21 };
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+void irq_set_priority(uint num, uint8_t priority);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,9 @@
+#pragma once
+#include "pico/stdlib.h"
+
+// The virtual panel has no backlight, the duty goes nowhere
+static inline uint pwm_gpio_to_slice_num(uint gpio) { return (gpio >> 1) & 7; }
+static inline void pwm_set_wrap(uint slice_num, uint16_t wrap) { (void)slice_num; (void)wrap; }
+static inline void pwm_set_clkdiv(uint slice_num, float divider) { (void)slice_num; (void)divider; }
+static inline void pwm_set_gpio_level(uint gpio, uint16_t level) { (void)gpio; (void)level; }
+static inline void pwm_set_enabled(uint slice_num, bool enabled) { (void)slice_num; (void)enabled; }
@@ -0,0 +1,23 @@
+#pragma once
+#include "pico/stdlib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+static inline void __dmb(void) {}
+static inline void __wfe(void) {}
+static inline void __sev(void) {}
+
+// One core, a spin lock is masking interrupts
+typedef volatile uint32_t spin_lock_t;
+static inline int spin_lock_claim_unused(bool required) { (void)required; return 0; }
+static inline spin_lock_t *spin_lock_init(uint lock_num) { static spin_lock_t Lock; (void)lock_num; return &Lock; }
+static inline uint32_t spin_lock_blocking(spin_lock_t *lock) { (void)lock; return save_and_disable_interrupts(); }
+static inline void spin_unlock(spin_lock_t *lock, uint32_t saved_irq) { (void)lock; restore_interrupts(saved_irq); }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,13 @@
+#pragma once
+#include "pico/stdlib.h"
+
+#define PICO_OK 0
+
+// One core and nothing running from flash, the function runs right away
+static inline int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms)
+{
+    (void)enter_exit_timeout_ms;
+    func(param);
+    return PICO_OK;
+}
+static inline bool flash_safe_execute_core_init(void) { return true; }
@@ -0,0 +1,5 @@
+#pragma once
+#include "pico/stdlib.h"
+
+// There is no second core, whatever would run there does not
+static inline void multicore_launch_core1(void (*entry)(void)) { (void)entry; }
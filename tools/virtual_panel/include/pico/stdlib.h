@@ -0,0 +1,61 @@
+/*
+ * Host stand-in for the parts of the Pico SDK the display code uses.
+ * Time is virtual: it only moves when the SPI bus is busy or the code
+ * sleeps, see virtual_panel.h.
+ */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t time_us_64(void);
+static inline uint32_t time_us_32(void) { return (uint32_t)time_us_64(); }
+static inline absolute_time_t get_absolute_time(void) { return time_us_64(); }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+static inline bool stdio_init_all(void) { return true; }
+void tight_loop_contents(void);
+
+#define GPIO_IN 0
+#define GPIO_OUT 1
+enum gpio_function { GPIO_FUNC_SPI = 1, GPIO_FUNC_UART = 2, GPIO_FUNC_I2C = 3, GPIO_FUNC_PWM = 4, GPIO_FUNC_SIO = 5 };
+void gpio_init(uint pin);
+void gpio_set_dir(uint pin, bool out);
+void gpio_put(uint pin, bool value);
+bool gpio_get(uint pin);
+static inline void gpio_set_pulls(uint pin, bool up, bool down) { (void)pin; (void)up; (void)down; }
+static inline void gpio_pull_up(uint pin) { (void)pin; }
+static inline void gpio_set_function(uint pin, enum gpio_function fn) { (void)pin; (void)fn; }
+
+#define GPIO_IRQ_EDGE_FALL 0x4u
+#define GPIO_IRQ_EDGE_RISE 0x8u
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t mask, bool enabled, gpio_irq_callback_t cb);
+void gpio_set_irq_enabled(uint gpio, uint32_t mask, bool enabled);
+void gpio_add_raw_irq_handler(uint gpio, void (*handler)(void));
+void gpio_acknowledge_irq(uint gpio, uint32_t events);
+uint32_t gpio_get_irq_event_mask(uint gpio);
+
+#ifndef MIN
+#define MIN(a, b) ((b) > (a) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+#define __not_in_flash_func(f) f
+
+// The host is core 0
+static inline uint get_core_num(void) { return 0; }
+
+#ifdef __cplusplus
+}
+#endif
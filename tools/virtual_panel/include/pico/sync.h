@@ -0,0 +1,19 @@
+#pragma once
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+// Single threaded on the host, locks always succeed
+typedef struct { int unused; } mutex_t;
+typedef struct { int unused; } recursive_mutex_t;
+typedef struct { int unused; } critical_section_t;
+
+static inline void mutex_init(mutex_t *m) { (void)m; }
+static inline void mutex_enter_blocking(mutex_t *m) { (void)m; }
+static inline bool mutex_try_enter(mutex_t *m, uint32_t *owner) { (void)m; (void)owner; return true; }
+static inline void mutex_exit(mutex_t *m) { (void)m; }
+static inline void recursive_mutex_init(recursive_mutex_t *m) { (void)m; }
+static inline void recursive_mutex_enter_blocking(recursive_mutex_t *m) { (void)m; }
+static inline void recursive_mutex_exit(recursive_mutex_t *m) { (void)m; }
+static inline void critical_section_init(critical_section_t *c) { (void)c; }
+static inline void critical_section_enter_blocking(critical_section_t *c) { (void)c; }
+static inline void critical_section_exit(critical_section_t *c) { (void)c; }
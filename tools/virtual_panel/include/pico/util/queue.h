@@ -0,0 +1,49 @@
+#pragma once
+#include "pico/stdlib.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Single threaded on the host: a full queue would never drain and an empty
+// one never fill, blocking on either is a bug
+typedef struct {
+    uint8_t *data;
+    uint element_size;
+    uint count;
+    uint head, tail;
+} queue_t;
+
+static inline void queue_init(queue_t *q, uint element_size, uint element_count)
+{
+    q->data = (uint8_t *)malloc((size_t)element_size * element_count);
+    q->element_size = element_size;
+    q->count = element_count;
+    q->head = q->tail = 0;
+}
+
+static inline bool queue_try_add(queue_t *q, const void *data)
+{
+    if(q->head - q->tail == q->count)
+        return false;
+    memcpy(q->data + (q->head++ % q->count) * q->element_size, data, q->element_size);
+    return true;
+}
+
+static inline bool queue_try_remove(queue_t *q, void *data)
+{
+    if(q->head == q->tail)
+        return false;
+    memcpy(data, q->data + (q->tail++ % q->count) * q->element_size, q->element_size);
+    return true;
+}
+
+static inline void queue_add_blocking(queue_t *q, const void *data)
+{
+    if(!queue_try_add(q, data))
+        abort();
+}
+
+static inline void queue_remove_blocking(queue_t *q, void *data)
+{
+    if(!queue_try_remove(q, data))
+        abort();
+}
@@ -0,0 +1,274 @@
+// Writes session logs through GPSLogger and LogWriter to an SD card in RAM,
+// formatted by FatFs, then copies each one out next to what went into it.
+// tools/log_convert/test_sclog.py reads them back with sclog.py and checks
+// that the two agree.
+//
+//   log_roundtrip <output directory>
+//
+// NAME.scl comes with NAME.expect, a line per record logged, times in ms
+// since the session start and floats as C99 hex so they read back exact:
+//   fix timestamp ms raw_lat raw_lon raw_speed raw_course filtered_lat ... filtered_course
+//   nmea ms sentence
+//   battery ms percent current_mA
+//   event ms type text
+// and last "closed 1", or "closed 0" for a log the power was cut on.
+
+#include "gps_logger.h"
+#include <string>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+
+extern "C" {
+    #include "DEV_Config.h"
+}
+
+static std::string g_outDir;
+
+static constexpr uint32_t START = 1700000000;   // 2023-11-14 22:13:20 UTC
+
+static void fail(const char* what) {
+    fprintf(stderr, "log_roundtrip: %s\n", what);
+    exit(1);
+}
+
+static uint32_t bootMs() {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+// Small deterministic noise, -1 to 1
+static float noise(uint32_t& seed) {
+    seed = seed * 1664525u + 1013904223u;
+    return static_cast<float>(seed >> 8) / static_cast<float>(1u << 23) - 1.0f;
+}
+
+// A log being written, and what it has to read back as
+class Session {
+public:
+    void open(const char* name, uint32_t start_time) {
+        m_name = name;
+        m_start = start_time;
+        m_expect = fopen((g_outDir + "/" + name + ".expect").c_str(), "w");
+        if (!m_expect || !m_logger.init((m_name + ".scl").c_str(), start_time)) {
+            fail("could not start a log");
+        }
+        m_clockMs = -static_cast<int64_t>(bootMs());
+    }
+
+    void fix(const GPSFix& raw, const GPSFix& filtered) {
+        if (!m_logger.logData(raw, filtered)) {
+            fail("a fix was dropped");
+        }
+        int64_t ms = static_cast<int64_t>(raw.timestamp - m_start) * 1000 + raw.ms;
+        m_clockMs = ms - bootMs();
+        fprintf(m_expect, "fix %u %u %a %a %a %a %a %a %a %a\n", raw.timestamp, raw.ms,
+                raw.lat, raw.lon, raw.speed, raw.course,
+                filtered.lat, filtered.lon, filtered.speed, filtered.course);
+        drain();
+    }
+
+    void nmea(const char* sentence) {
+        if (!m_logger.logNmea(sentence, bootMs())) {
+            fail("a sentence was dropped");
+        }
+        fprintf(m_expect, "nmea %u %.*s\n", sessionMs(), static_cast<int>(strcspn(sentence, "\r\n")), sentence);
+        drain();
+    }
+
+    void battery(float percent, float current_mA) {
+        if (!m_logger.logBattery(percent, current_mA)) {
+            fail("a battery reading was dropped");
+        }
+        fprintf(m_expect, "battery %u %a %a\n", sessionMs(), percent, current_mA);
+        drain();
+    }
+
+    void event(uint8_t type, const char* text) {
+        if (!m_logger.logEvent(type, text)) {
+            fail("an event was dropped");
+        }
+        fprintf(m_expect, "event %u %u %s\n", sessionMs(), type, text);
+        drain();
+    }
+
+    void close() {
+        m_logger.close();
+        copyOut();
+        fprintf(m_expect, "closed 1\n");
+        fclose(m_expect);
+    }
+
+    // The power goes: what is on the card now is the log
+    void cut() {
+        copyOut();
+        fprintf(m_expect, "closed 0\n");
+        fclose(m_expect);
+    }
+
+    void syncSeconds(uint32_t seconds) { m_logger.setSyncSeconds(seconds); }
+
+private:
+    GPSLogger m_logger;
+    std::string m_name;
+    uint32_t m_start = 0;
+    int64_t m_clockMs = 0;
+    FILE* m_expect = nullptr;
+
+    // The boot clock on the GPS one, tied at every fix like the logger's
+    uint32_t sessionMs() const {
+        int64_t ms = bootMs() + m_clockMs;
+        return ms < 0 ? 0 : static_cast<uint32_t>(ms);
+    }
+
+    // The main loop keeps up with the card, nothing is dropped
+    void drain() {
+        while (m_logger.getWriterStats().queued > 0) {
+            m_logger.service();
+        }
+    }
+
+    // The file as the card has it, open or not
+    void copyOut() {
+        FIL file;
+        if (f_open(&file, ("0:" + m_name + ".scl").c_str(), FA_READ) != FR_OK) {
+            fail("could not open a log on the card");
+        }
+        FILE* out = fopen((g_outDir + "/" + m_name + ".scl").c_str(), "wb");
+        if (!out) {
+            fail("could not write a log out");
+        }
+        static uint8_t buffer[32 * SCLOG_SECTOR];
+        UINT read = 0;
+        while (f_read(&file, buffer, sizeof(buffer), &read) == FR_OK && read > 0) {
+            fwrite(buffer, 1, read, out);
+        }
+        fclose(out);
+        f_close(&file);
+    }
+};
+
+static void nmeaSentence(const GPSFix& fix, char* sentence, size_t size) {
+    char body[96];
+    snprintf(body, sizeof(body), "GPRMC,%06u.%03u,A,%.5f,N,%.5f,W,%.2f,%.2f,141123,,,A",
+             fix.timestamp % 86400, fix.ms, fix.lat * 100.0, -fix.lon * 100.0, fix.speed, fix.course);
+    uint8_t checksum = 0;
+    for (const char* c = body; *c; c++) {
+        checksum ^= static_cast<uint8_t>(*c);
+    }
+    snprintf(sentence, size, "$%s*%02X\r\n", body, checksum);
+}
+
+// Five minutes beating to windward at 5 Hz. Every tack turns the course
+// through north, the raw course wanders either side of it; once the raw
+// course flips half a turn, a GPS glitch. Halfway the GPS clock jumps 40
+// days ahead, more than a residual holds. Some 30 chunks of fixes and
+// more of NMEA, over several index spans.
+static void sail() {
+    Session s;
+    s.open("sail", START);
+    s.event(SCLOG_EVENT_BUTTON, "short");
+    s.event(SCLOG_EVENT_MARK, "SBYC");
+
+    GPSFix filtered = {START, 37.8f, -122.4f, 6.0f, 30.0f, true, 0};
+    uint32_t seed = 1;
+    double lat = filtered.lat, lon = filtered.lon;
+    for (int i = 0; i < 1500; i++) {
+        int leg = i / 150, turn = i % 150;
+        float from = leg % 2 ? 30.0f : -30.0f;
+        float heading = turn < 20 ? from - 2.0f * from * turn / 20.0f : -from;
+        if (turn == 0 && i > 0) {
+            s.event(SCLOG_EVENT_TACK, leg % 2 ? "330" : "030");
+        }
+
+        filtered.ms = static_cast<uint16_t>(filtered.ms + 200);
+        if (filtered.ms >= 1000) {
+            filtered.ms = static_cast<uint16_t>(filtered.ms - 1000);
+            filtered.timestamp++;
+        }
+        if (i == 800) {
+            filtered.timestamp += 40 * 86400;
+        }
+        filtered.speed = 6.0f + 0.5f * noise(seed);
+        filtered.course = fmodf(heading + 360.0f, 360.0f);
+        double metres = filtered.speed * 0.5144 * 0.2;
+        lat += metres * cos(filtered.course * M_PI / 180.0) / 111320.0;
+        lon += metres * sin(filtered.course * M_PI / 180.0) / (111320.0 * cos(lat * M_PI / 180.0));
+        filtered.lat = static_cast<float>(lat);
+        filtered.lon = static_cast<float>(lon);
+
+        GPSFix raw = filtered;
+        raw.lat += 3e-6f * noise(seed);
+        raw.lon += 3e-6f * noise(seed);
+        raw.speed += 0.3f * noise(seed);
+        raw.course = fmodf(filtered.course + 3.0f * noise(seed) + 360.0f, 360.0f);
+        if (i == 600) {
+            raw.course = fmodf(filtered.course + 180.0f, 360.0f);
+        }
+
+        sleep_ms(200);
+        s.fix(raw, filtered);
+        char sentence[128];
+        nmeaSentence(raw, sentence, sizeof(sentence));
+        s.nmea(sentence);
+        if (i % 25 == 0) {
+            s.battery(87.3f - i / 250.0f, -310.0f - 20.0f * noise(seed));
+        }
+    }
+    s.close();
+}
+
+// Battery readings only, as many as the chunks of one index span hold: the
+// index fills with its last entry and the trailer comes right after the span
+static void span() {
+    Session s;
+    s.open("span", START);
+    constexpr int READINGS = SCLOG_INDEX_ENTRIES * (SCLOG_CHUNK_BYTES / sizeof(SclogBattery));
+    for (int i = 0; i < READINGS; i++) {
+        sleep_ms(1000);
+        s.battery(95.0f - i / 100.0f, -300.0f + (i % 7));
+    }
+    s.close();
+}
+
+// Fixes and NMEA past the first index span, never synced, then the power
+// is cut: the second index and the filling chunks never reach the card
+static void cut() {
+    Session s;
+    s.open("cut", START);
+    s.syncSeconds(24 * 3600);
+    GPSFix fix = {START, 37.8f, -122.4f, 6.0f, 45.0f, true, 0};
+    uint32_t seed = 2;
+    for (int i = 0; i < 500; i++) {
+        fix.ms = static_cast<uint16_t>((fix.ms + 200) % 1000);
+        fix.timestamp += fix.ms == 0;
+        fix.lat += 1e-5f;
+        fix.lon += 1e-5f;
+        fix.speed = 6.0f + 0.5f * noise(seed);
+        fix.course = 45.0f + 5.0f * noise(seed);
+        sleep_ms(200);
+        s.fix(fix, fix);
+        char sentence[128];
+        nmeaSentence(fix, sentence, sizeof(sentence));
+        s.nmea(sentence);
+    }
+    s.cut();
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: log_roundtrip <output directory>\n");
+        return 2;
+    }
+    g_outDir = argv[1];
+
+    System_Init();
+    static FATFS fs;
+    if (f_mount(&fs, "", 0) != FR_OK || f_mkfs("", 1, 0) != FR_OK) {
+        fail("could not format the card");
+    }
+
+    sail();
+    span();
+    cut();
+    return 0;
+}
@@ -0,0 +1,184 @@
+// Runs NavigationGUI on the virtual panel: boots it, feeds it fixes through
+// the same update()/service() loop as speed-cube.cpp, steps through the
+// display modes and reports what each phase cost on the bus. A snapshot of
+// the screen is saved after every phase; with --golden each one is compared
+// with the PNG of the same name there, and any pixel that differs fails the
+// run. Saving to the golden directory updates it.
+//
+//   panel_bench [output directory] [--ppm] [--golden directory]
+
+#include "gui.h"
+#include <string>
+#include <cstring>
+#include <cmath>
+
+extern "C" {
+    #include "virtual_panel.h"
+}
+
+static std::string g_outDir = ".";
+static std::string g_goldenDir;
+static bool g_ppm = false;
+static int g_mismatches = 0;
+
+static void snapshot(const char* name) {
+    std::string path = g_outDir + "/" + name + (g_ppm ? ".ppm" : ".png");
+    bool saved = g_ppm ? VP_SavePPM(path.c_str()) : VP_SavePNG(path.c_str());
+    if (!saved) {
+        fprintf(stderr, "Could not write %s\n", path.c_str());
+    }
+
+    if (g_goldenDir.empty()) {
+        return;
+    }
+    std::string golden = g_goldenDir + "/" + name + ".png";
+    int32_t differ = VP_ComparePNG(golden.c_str());
+    if (differ < 0) {
+        fprintf(stderr, "Could not read %s\n", golden.c_str());
+        g_mismatches++;
+    } else if (differ > 0) {
+        fprintf(stderr, "%s: %d pixels differ from %s\n", name, differ, golden.c_str());
+        g_mismatches++;
+    }
+}
+
+static void report(const char* phase, const VP_STATS& start, uint32_t frames) {
+    VP_STATS d;
+    VP_StatsSince(&start, &d);
+    double n = frames ? frames : 1;
+    printf("%-12s %6u %10.0f %8.1f %8.1f %10.0f %9.0f\n", phase, frames,
+           d.Bytes / n, d.Cs_Toggles / n, d.Windows / n, d.Pixels / n, d.Bus_Us / n);
+}
+
+// One second of the main loop: a fix, then service() every 5 ms
+static void runSecond(NavigationGUI& gui, const GPSFix& fix) {
+    gui.update(fix);
+    for (int i = 0; i < 200; i++) {
+        gui.service();
+        sleep_ms(5);
+    }
+}
+
+static uint32_t framesSince(NavigationGUI& gui, uint32_t start) {
+    return gui.getFrameStats().frames - start;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ppm") == 0) {
+            g_ppm = true;
+        } else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            g_goldenDir = argv[++i];
+        } else {
+            g_outDir = argv[i];
+        }
+    }
+
+    VP_Init(VP_ILI9486);
+    NavigationGUI gui;
+    VP_STATS start;
+
+    printf("%-12s %6s %10s %8s %8s %10s %9s\n", "phase", "frames", "bytes/fr", "cs/fr", "win/fr", "pixels/fr", "bus us/fr");
+
+    VP_GetStats(&start);
+    gui.init();
+    report("boot", start, 1);
+    snapshot("boot");
+
+    GPSFix fix = {1700000000, 37.78f, -122.38f, 4.3f, 212.0f, true};
+    uint32_t frames = gui.getFrameStats().frames;
+    VP_GetStats(&start);
+    runSecond(gui, fix);
+    report("first fix", start, framesSince(gui, frames));
+    snapshot("first_fix");
+
+    frames = gui.getFrameStats().frames;
+    VP_GetStats(&start);
+    for (int i = 0; i < 60; i++) {
+        fix.timestamp++;
+        runSecond(gui, fix);
+    }
+    report("stationary", start, framesSince(gui, frames));
+
+    frames = gui.getFrameStats().frames;
+    VP_GetStats(&start);
+    for (int i = 0; i < 60; i++) {
+        fix.timestamp++;
+        fix.speed = 4.3f + 0.1f * (i % 3);
+        fix.course = 212 + (i % 2);
+        runSecond(gui, fix);
+    }
+    report("moving", start, framesSince(gui, frames));
+    snapshot("target");
+
+    const char* modes[] = {"sog", "huge"};
+    for (const char* mode : modes) {
+        frames = gui.getFrameStats().frames;
+        VP_GetStats(&start);
+        gui.cycleDisplayMode();
+        for (int i = 0; i < 10; i++) {
+            fix.timestamp++;
+            runSecond(gui, fix);
+        }
+        report(mode, start, framesSince(gui, frames));
+        snapshot(mode);
+    }
+
+    // Five minutes beating north at 6 kt, tacking every minute
+    frames = gui.getFrameStats().frames;
+    VP_GetStats(&start);
+    gui.cycleDisplayMode();
+    fix.speed = 6.0f;
+    for (int i = 0; i < 300; i++) {
+        fix.timestamp++;
+        fix.course = (i / 60) % 2 ? 320.0f : 40.0f;
+        float metres = fix.speed * 0.5144f;
+        fix.lat += metres * cosf(fix.course * FM_DEG2RAD) / 111320.0f;
+        fix.lon += metres * sinf(fix.course * FM_DEG2RAD) / (111320.0f * cosf(fix.lat * FM_DEG2RAD));
+        runSecond(gui, fix);
+    }
+    report("map", start, framesSince(gui, frames));
+    snapshot("map");
+
+    // Start page with the sequence running, then the stats of the beat
+    frames = gui.getFrameStats().frames;
+    VP_GetStats(&start);
+    gui.cycleDisplayMode();
+    gui.cycleToNextTarget();
+    for (int i = 0; i < 10; i++) {
+        fix.timestamp++;
+        runSecond(gui, fix);
+    }
+    report("start", start, framesSince(gui, frames));
+    snapshot("start");
+
+    frames = gui.getFrameStats().frames;
+    VP_GetStats(&start);
+    gui.cycleDisplayMode();
+    for (int i = 0; i < 10; i++) {
+        fix.timestamp++;
+        runSecond(gui, fix);
+    }
+    report("stats", start, framesSince(gui, frames));
+    snapshot("stats");
+
+    // Back to the first page, its chrome comes from the cache
+    frames = gui.getFrameStats().frames;
+    VP_GetStats(&start);
+    gui.cycleDisplayMode();
+    for (int i = 0; i < 10; i++) {
+        fix.timestamp++;
+        runSecond(gui, fix);
+    }
+    report("main again", start, framesSince(gui, frames));
+    snapshot("main_again");
+
+    const FrameScheduler::Stats& stats = gui.getFrameStats();
+    printf("%u frames, %u dropped, %u over budget, %u us average, %u us max\n",
+           stats.frames, stats.dropped, stats.overruns, stats.averageUs(), stats.maxUs);
+    if (g_mismatches > 0) {
+        fprintf(stderr, "%d snapshots do not match the golden images\n", g_mismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,460 @@
+/*****************************************************************************
+* | File      	:	pico_host.c
+* | Function    :	Pico SDK stand-ins that drive the virtual panel
+* | Info        :
+*   Only what DEV_Config.c, LCD_Driver.c and LCD_Touch.c use. Bytes
+*   written on the LCD SPI port reach the panel and the touch controller
+*   while their chip selects are low, MISO is wired-AND. A DMA transfer is
+*   clocked through when it is started; its completion IRQ, and a GPIO
+*   edge IRQ, run at the next point where interrupts could be taken (a
+*   sleep, a wait, a read of the pen pin), as long as they are not masked
+*   and no handler is running, like on the chip.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+* | Info        :   Basic version
+*
+******************************************************************************/
+#include "DEV_Config.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "virtual_panel.h"
+#include <string.h>
+
+#define CLK_PERI_HZ     150000000
+
+struct spi_inst { uint32_t Baudrate; uint8_t Data_Bits; };
+struct i2c_inst { int Unused; };
+
+static struct spi_inst Spi[2] = { {50000000, 8}, {50000000, 8} };
+static struct i2c_inst I2c[2];
+spi_inst_t *spi0 = &Spi[0], *spi1 = &Spi[1];
+i2c_inst_t *i2c0 = &I2c[0], *i2c1 = &I2c[1];
+
+static bool Pins[32];
+static spi_hw_t Spi_Hw;
+
+static void Irq_Run(void);
+static void Pen_Poll(void);
+
+/******************************************************************************
+function:	Time
+******************************************************************************/
+uint64_t time_us_64(void)
+{
+    return VP_Time_Us();
+}
+
+void sleep_us(uint64_t us)
+{
+    VP_Advance_Us(us);
+    Irq_Run();
+}
+
+void sleep_ms(uint32_t ms)
+{
+    VP_Advance_Us((uint64_t)ms * 1000);
+    Irq_Run();
+}
+
+/******************************************************************************
+function:	GPIO, the LCD chip select and DC lines go to the panel, the
+			touch chip select and PENIRQ to the touch controller
+******************************************************************************/
+void gpio_init(uint pin)
+{
+    Pins[pin] = false;
+}
+
+void gpio_set_dir(uint pin, bool out)
+{
+    (void)pin;
+    (void)out;
+}
+
+void gpio_put(uint pin, bool value)
+{
+    Pins[pin] = value;
+    if(pin == LCD_CS_PIN) {
+        VP_Select(!value);
+    } else if(pin == LCD_DC_PIN) {
+        VP_SetDataMode(value);
+    } else if(pin == TP_CS_PIN) {
+        VP_TouchSelect(!value);
+        Pen_Poll();
+    }
+}
+
+bool gpio_get(uint pin)
+{
+    if(pin == TP_IRQ_PIN) {
+        Irq_Run();
+        return VP_ReadPenIrq();
+    }
+    return Pins[pin];
+}
+
+/******************************************************************************
+function:	SPI
+******************************************************************************/
+uint spi_init(spi_inst_t *spi, uint baudrate)
+{
+    return spi_set_baudrate(spi, baudrate);
+}
+
+//The port divides clk_peri by an even prescaler and a postdivider and
+//takes the fastest rate not above the one asked for, like the SDK
+uint spi_set_baudrate(spi_inst_t *spi, uint baudrate)
+{
+    uint32_t Prescale, Postdiv;
+
+    for(Prescale = 2; Prescale < 254; Prescale += 2) {
+        if(CLK_PERI_HZ < (uint64_t)Prescale * 256 * baudrate)
+            break;
+    }
+    for(Postdiv = 256; Postdiv > 1; Postdiv--) {
+        if(CLK_PERI_HZ / (Prescale * (Postdiv - 1)) > baudrate)
+            break;
+    }
+    baudrate = CLK_PERI_HZ / (Prescale * Postdiv);
+    spi->Baudrate = baudrate;
+    if(spi == SPI_PORT)
+        VP_SetBaudrate(baudrate);
+    return baudrate;
+}
+
+uint spi_get_baudrate(const spi_inst_t *spi)
+{
+    return spi->Baudrate;
+}
+
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order)
+{
+    (void)cpol;
+    (void)cpha;
+    (void)order;
+    spi->Data_Bits = data_bits;
+}
+
+static uint8_t Spi_Byte(spi_inst_t *spi, uint8_t Byte)
+{
+    uint8_t Reply;
+
+    if(spi != SPI_PORT)
+        return 0xff;
+    Reply = VP_Transfer(Byte);
+    return Reply & VP_TouchTransfer(Byte);
+}
+
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len)
+{
+    size_t i;
+    for(i = 0; i < len; i++)
+        dst[i] = Spi_Byte(spi, src[i]);
+    return len;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len)
+{
+    size_t i;
+    for(i = 0; i < len; i++)
+        Spi_Byte(spi, src[i]);
+    return len;
+}
+
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len)
+{
+    size_t i;
+    for(i = 0; i < len; i++)
+        dst[i] = Spi_Byte(spi, repeated_tx_data);
+    return len;
+}
+
+int spi_write16_blocking(spi_inst_t *spi, const uint16_t *src, size_t len)
+{
+    size_t i;
+    if(spi->Data_Bits != 16)
+        fprintf(stderr, "pico_host: 16-bit write with the SPI in %u-bit mode\n", spi->Data_Bits);
+    for(i = 0; i < len; i++) {
+        Spi_Byte(spi, src[i] >> 8);
+        Spi_Byte(spi, src[i] & 0xff);
+    }
+    return len;
+}
+
+uint spi_get_dreq(spi_inst_t *spi, bool is_tx)
+{
+    return (spi == spi1 ? 18 : 16) + (is_tx ? 0 : 1);
+}
+
+bool spi_is_busy(const spi_inst_t *spi)
+{
+    (void)spi;
+    return false;
+}
+
+bool spi_is_readable(const spi_inst_t *spi)
+{
+    (void)spi;
+    return false;
+}
+
+spi_hw_t *spi_get_hw(spi_inst_t *spi)
+{
+    (void)spi;
+    return &Spi_Hw;
+}
+
+/******************************************************************************
+function:	Interrupts
+******************************************************************************/
+static irq_handler_t Dma_Handler;
+static bool Dma_Irq_Pending, Irq_Masked, In_Irq;
+
+//Edges latch whether or not their interrupt is enabled, like the chip's
+//raw interrupt status; a raw handler acknowledges its own
+static irq_handler_t Gpio_Raw_Handler[32];
+static gpio_irq_callback_t Gpio_Callback;
+static uint32_t Gpio_Irq_Enabled[32], Gpio_Irq_Events[32];
+static bool Gpio_Bank_Enabled;
+static bool Pen_Level = true;
+
+static void Pen_Poll(void)
+{
+    bool Level = VP_PenIrq();
+
+    if(Level != Pen_Level)
+        Gpio_Irq_Events[TP_IRQ_PIN] |= Level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    Pen_Level = Level;
+}
+
+//The first pin with an enabled event pending, 32 for none
+static uint Gpio_Pending(void)
+{
+    uint Pin;
+
+    for(Pin = 0; Pin < 32; Pin++) {
+        if(Gpio_Irq_Events[Pin] & Gpio_Irq_Enabled[Pin])
+            break;
+    }
+    return Pin;
+}
+
+static void Irq_Run(void)
+{
+    uint Pin;
+
+    Pen_Poll();
+    while(!Irq_Masked && !In_Irq) {
+        In_Irq = true;
+        if(Dma_Irq_Pending && Dma_Handler) {
+            Dma_Handler();
+        } else if(Gpio_Bank_Enabled && (Pin = Gpio_Pending()) < 32) {
+            if(Gpio_Raw_Handler[Pin]) {
+                Gpio_Raw_Handler[Pin]();
+            } else {
+                uint32_t Events = Gpio_Irq_Events[Pin] & Gpio_Irq_Enabled[Pin];
+                Gpio_Irq_Events[Pin] &= ~Events;
+                if(Gpio_Callback)
+                    Gpio_Callback(Pin, Events);
+            }
+        } else {
+            In_Irq = false;
+            break;
+        }
+        In_Irq = false;
+    }
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t mask, bool enabled)
+{
+    if(enabled)
+        Gpio_Irq_Enabled[gpio] |= mask;
+    else
+        Gpio_Irq_Enabled[gpio] &= ~mask;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t mask, bool enabled, gpio_irq_callback_t cb)
+{
+    Gpio_Callback = cb;
+    gpio_set_irq_enabled(gpio, mask, enabled);
+    Gpio_Bank_Enabled = true;
+}
+
+void gpio_add_raw_irq_handler(uint gpio, irq_handler_t handler)
+{
+    Gpio_Raw_Handler[gpio] = handler;
+}
+
+void gpio_acknowledge_irq(uint gpio, uint32_t events)
+{
+    Gpio_Irq_Events[gpio] &= ~events;
+}
+
+uint32_t gpio_get_irq_event_mask(uint gpio)
+{
+    return Gpio_Irq_Events[gpio] & Gpio_Irq_Enabled[gpio];
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority)
+{
+    (void)order_priority;
+    irq_set_exclusive_handler(num, handler);
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler)
+{
+    if(num == DMA_IRQ_0)
+        Dma_Handler = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+    if(num == IO_IRQ_BANK0)
+        Gpio_Bank_Enabled = enabled;
+}
+
+void irq_set_priority(uint num, uint8_t priority)
+{
+    (void)num;
+    (void)priority;
+}
+
+uint32_t save_and_disable_interrupts(void)
+{
+    uint32_t Status = Irq_Masked;
+    Irq_Masked = true;
+    return Status;
+}
+
+void restore_interrupts(uint32_t status)
+{
+    Irq_Masked = status;
+    Irq_Run();
+}
+
+void tight_loop_contents(void)
+{
+    Irq_Run();
+}
+
+/******************************************************************************
+function:	DMA, only transfers into the SPI data register are modelled
+******************************************************************************/
+int dma_claim_unused_channel(bool required)
+{
+    (void)required;
+    return 0;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+    dma_channel_config Config = { DMA_SIZE_32, true, false, 0x3f };
+    (void)channel;
+    return Config;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *c, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+    const volatile uint8_t *pByte = (const volatile uint8_t *)read_addr;
+    const volatile uint16_t *pWord = (const volatile uint16_t *)read_addr;
+    uint i;
+
+    (void)channel;
+    if(!trigger || write_addr != &Spi_Hw.dr)
+        return;
+
+    for(i = 0; i < transfer_count; i++) {
+        if(c->size == DMA_SIZE_16) {
+            uint16_t Word = c->read_increment ? pWord[i] : pWord[0];
+            Spi_Byte(SPI_PORT, Word >> 8);
+            Spi_Byte(SPI_PORT, Word & 0xff);
+        } else {
+            Spi_Byte(SPI_PORT, c->read_increment ? pByte[i] : pByte[0]);
+        }
+    }
+    Dma_Irq_Pending = true;
+}
+
+bool dma_channel_is_busy(uint channel)
+{
+    (void)channel;
+    Irq_Run();
+    return false;
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled)
+{
+    (void)channel;
+    (void)enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel)
+{
+    (void)channel;
+    return Dma_Irq_Pending;
+}
+
+void dma_channel_acknowledge_irq0(uint channel)
+{
+    (void)channel;
+    Dma_Irq_Pending = false;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel)
+{
+    (void)channel;
+}
+
+void dma_channel_abort(uint channel)
+{
+    (void)channel;
+}
+
+/******************************************************************************
+function:	I2C, nothing answers
+******************************************************************************/
+uint i2c_init(i2c_inst_t *i2c, uint baudrate)
+{
+    (void)i2c;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)i2c;
+    (void)addr;
+    (void)src;
+    (void)nostop;
+    return len;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop)
+{
+    (void)i2c;
+    (void)addr;
+    (void)nostop;
+    memset(dst, 0, len);
+    return len;
+}
+
+/******************************************************************************
+function:	Flash, erased to 0xff and programmed by clearing bits like the chip
+******************************************************************************/
+uint8_t host_flash[PICO_FLASH_SIZE_BYTES];
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    memset(host_flash + flash_offs, 0xff, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+    size_t i;
+    for(i = 0; i < count; i++)
+        host_flash[flash_offs + i] &= data[i];
+}
@@ -0,0 +1,161 @@
+// Runs the compass ring pointers of lib/navigation on the virtual panel and
+// holds them to the radial draws they replace: at every degree the mark and
+// the tack sprite have to cover exactly the pixels GUI_DrawRadialCircle and
+// GUI_DrawRadialTriangle paint there, in the same colors, while they move
+// from degree to degree over a background that is not LCD_BACKGROUND; and
+// once hidden, the background has to be back as it was.
+//
+//   pointers_test
+
+#include "pointers.h"
+#include <vector>
+#include <utility>
+
+extern "C" {
+    #include "LCD_GUI.h"
+    #include "LCD_Framebuffer.h"
+    #include "virtual_panel.h"
+}
+
+static int g_failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        g_failures++; \
+    } \
+} while (0)
+
+// Where NavigationGUI puts the ring, and the radial draws the pointers stand in for
+static constexpr int CENTER_X = 160;
+static constexpr int CENTER_Y = 150;
+static constexpr int RADIUS = 130;
+
+static void drawMark(int deg) {
+    GUI_DrawRadialCircle(deg, 10, CENTER_X, CENTER_Y, RADIUS + 15, YELLOW);
+}
+
+static void drawTack(int deg) {
+    GUI_DrawRadialTriangle(deg, RADIUS - 5, CENTER_X, CENTER_Y, deg > 180 ? GREEN : RED, 1);
+}
+
+// Something under the pointers to save and put back: the ring, and a block
+// at the top the pointers run off the screen over
+static void drawBackground() {
+    GUI_DrawRectangle(0, 0, VP_Width(), VP_Height(), BLACK, DRAW_FULL, DOT_PIXEL_1X1);
+    GUI_DrawCircle(CENTER_X, CENTER_Y, RADIUS, WHITE, DRAW_EMPTY, DOT_PIXEL_2X2);
+    GUI_DrawRectangle(140, 0, 180, 30, BLUE, DRAW_FULL, DOT_PIXEL_1X1);
+    GUI_DrawRectangle(280, 100, 320, 200, GRAY, DRAW_FULL, DOT_PIXEL_1X1);
+}
+
+// The pixels that differ from the background, by position
+using Diff = std::vector<std::pair<uint32_t, uint16_t>>;
+
+static std::vector<uint16_t> g_background;
+
+static std::vector<uint16_t> screen() {
+    FB_Flush();
+    LCD_WaitIdle();
+    std::vector<uint16_t> pixels(VP_Width() * VP_Height());
+    for (uint16_t y = 0; y < VP_Height(); y++) {
+        for (uint16_t x = 0; x < VP_Width(); x++) {
+            pixels[y * VP_Width() + x] = VP_GetPixel(x, y);
+        }
+    }
+    return pixels;
+}
+
+static Diff changed() {
+    std::vector<uint16_t> pixels = screen();
+    Diff diff;
+    for (uint32_t i = 0; i < pixels.size(); i++) {
+        if (pixels[i] != g_background[i]) {
+            diff.emplace_back(i, pixels[i]);
+        }
+    }
+    return diff;
+}
+
+// What a radial draw paints over the background, which is drawn again after
+template <typename Draw>
+static std::vector<Diff> references(Draw draw) {
+    std::vector<Diff> diffs(360);
+    for (int deg = 0; deg < 360; deg++) {
+        draw(deg);
+        diffs[deg] = changed();
+        drawBackground();
+    }
+    return diffs;
+}
+
+int main() {
+    VP_Init(VP_ILI9486);
+    System_Init();
+    LCD_Init(SCAN_DIR_DFT, 800);
+    FB_Init(BLACK);
+    CHECK(FB_Active());
+    drawBackground();
+    g_background = screen();
+
+    std::vector<Diff> marks = references(drawMark);
+    std::vector<Diff> tacks = references(drawTack);
+    std::vector<Diff> both = references([](int deg) { drawMark(deg); drawTack(deg); });
+    CHECK(changed().empty());
+    for (int deg = 0; deg < 360; deg++) {
+        CHECK(!marks[deg].empty() && !tacks[deg].empty());
+    }
+
+    // Each sprite on its own, moved a degree at a time all the way round
+    Pointers pointers(nullptr);
+    int mismatches = 0;
+    for (int deg = 0; deg < 360; deg++) {
+        pointers.updateMarkPointer(deg);
+        mismatches += changed() != marks[deg];
+    }
+    pointers.hide();
+    CHECK(mismatches == 0);
+    CHECK(changed().empty());
+
+    mismatches = 0;
+    for (int deg = 359; deg >= 0; deg--) {
+        pointers.updateTackPointer(deg);
+        mismatches += changed() != tacks[deg];
+    }
+    pointers.hide();
+    CHECK(mismatches == 0);
+    CHECK(changed().empty());
+
+    // Both, the tack over the mark where they overlap, moved in big steps
+    // as after a mark change
+    mismatches = 0;
+    for (int deg = 0; deg < 360; deg += 17) {
+        pointers.updateMarkPointer(deg);
+        pointers.updateTackPointer(deg);
+        mismatches += changed() != both[deg];
+    }
+    CHECK(mismatches == 0);
+
+    // A bearing rounds to its degree, a turn wraps
+    pointers.updateMarkPointer(359.6f);
+    pointers.updateTackPointer(-0.4f);
+    CHECK(changed() == both[0]);
+    pointers.updateMarkPointer(90.2f);
+    pointers.updateTackPointer(450.4f);
+    CHECK(changed() == both[90]);
+
+    // A new radius takes them off, the next update builds the shapes for it
+    pointers.setRadius(RADIUS + 20);
+    CHECK(changed().empty());
+    pointers.setRadius(RADIUS);
+    pointers.updateTackPointer(200.0f);
+    CHECK(changed() == tacks[200]);
+    pointers.hide();
+    CHECK(changed().empty());
+
+    if (g_failures) {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+    printf("Pointer checks passed\n");
+    return 0;
+}
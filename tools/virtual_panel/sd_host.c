@@ -0,0 +1,90 @@
+/*****************************************************************************
+* | File      	:	sd_host.c
+* | Function    :	An SD card in RAM behind the MMC_SD.h calls
+* | Info        :
+*   Only what diskio.c and the logger use. Sectors go to and come from an
+*   image in memory, zeroed like a new card. After every write the card
+*   answers one SD_IsReady poll busy, as if still programming, so the
+*   writer's passes that leave a busy card alone are taken too.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-19
+* | Info        :   Basic version
+*
+******************************************************************************/
+#include "MMC_SD.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SD_HOST_SECTORS		(96u * 1024 * 1024 / 512)
+
+uint8_t SD_Type = SD_TYPE_V2HC;
+SD_STATS sSD_Stats;
+
+static uint8_t *SD_Image;
+static uint8_t SD_Programming;
+
+uint8_t SD_Initialize(void)
+{
+    if(SD_Image == NULL)
+        SD_Image = calloc(SD_HOST_SECTORS, 512);
+    sSD_Stats.Clock_Hz = SD_SPI_BAUDRATE_DEFAULT;
+    return SD_Image != NULL ? 0 : MSD_RESPONSE_FAILURE;
+}
+
+void SD_SPI_SpeedLow(void)
+{
+}
+
+void SD_SPI_SpeedHigh(void)
+{
+}
+
+uint8_t SD_Select(void)
+{
+    SD_Programming = 0;
+    return 0;
+}
+
+void SD_DisSelect(void)
+{
+}
+
+uint8_t SD_WaitReady(void)
+{
+    SD_Programming = 0;
+    return 0;
+}
+
+uint8_t SD_IsReady(void)
+{
+    uint8_t Ready = !SD_Programming;
+
+    SD_Programming = 0;
+    return Ready;
+}
+
+uint8_t SD_ReadDisk(uint8_t *buf, uint32_t sector, uint8_t cnt)
+{
+    if(SD_Image == NULL || sector + cnt > SD_HOST_SECTORS)
+        return MSD_ADDRESS_ERROR;
+    memcpy(buf, SD_Image + (size_t)sector * 512, (size_t)cnt * 512);
+    sSD_Stats.Read_Bytes += cnt * 512;
+    SD_Programming = 0;
+    return 0;
+}
+
+uint8_t SD_WriteDisk(uint8_t *buf, uint32_t sector, uint8_t cnt)
+{
+    if(SD_Image == NULL || sector + cnt > SD_HOST_SECTORS)
+        return MSD_ADDRESS_ERROR;
+    memcpy(SD_Image + (size_t)sector * 512, buf, (size_t)cnt * 512);
+    sSD_Stats.Write_Bytes += cnt * 512;
+    SD_Programming = 1;
+    return 0;
+}
+
+uint32_t SD_GetSectorCount(void)
+{
+    return SD_HOST_SECTORS;
+}
@@ -0,0 +1,202 @@
+// Runs LCD_Touch.c against the XPT2046 model of the virtual panel: the
+// calibration screen with a stylus that follows the crosses, the bursts and
+// their filtering in TP_Service, the pen interrupt, the bus clock the touch
+// controller gets and gives back, and the calibration kept in flash.
+//
+//   touch_test
+
+#include "LCD_Touch.h"
+#include "DEV_Bus.h"
+#include "hardware/flash.h"
+#include "virtual_panel.h"
+#include <string.h>
+
+static int Failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        Failures++; \
+    } \
+} while (0)
+
+#define CAL_OFFSET		(PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+#define MARGIN			12		//Of the calibration crosses
+
+//What the panel under the stylus reads, a little off square like a real one
+static uint16_t X_Adc(int X) { return 250 + 11 * X; }
+static uint16_t Y_Adc(int Y) { return 200 + 15 * Y / 2; }
+
+static void Press(int X, int Y)
+{
+    VP_SetPen(true, X_Adc(X), Y_Adc(Y));
+}
+
+/******************************************************************************
+function:	The stylus during TP_Adjust: presses the red cross for a few
+			reads of the pen pin, lets go and waits for the next cross
+******************************************************************************/
+static int Stylus_Corner = -1;		//Pressed last
+static int Stylus_Reads;			//Left of the press
+static int Stylus_Calls;
+
+static void Stylus_Hook(void)
+{
+    const int X[4] = {MARGIN, 320 - MARGIN, MARGIN, 320 - MARGIN};
+    const int Y[4] = {MARGIN, MARGIN, 480 - MARGIN, 480 - MARGIN};
+    int i;
+
+    if (++Stylus_Calls > 100000) {
+        printf("The calibration never finished\n");
+        exit(1);
+    }
+    if (Stylus_Reads > 0) {
+        if (--Stylus_Reads == 0)
+            VP_SetPen(false, 0, 0);
+        return;
+    }
+    for (i = 0; i < 4; i++) {
+        if (i != Stylus_Corner && VP_GetPixel(X[i], Y[i]) == RED) {
+            Stylus_Corner = i;
+            Stylus_Reads = 4;
+            Press(X[i], Y[i]);
+            return;
+        }
+    }
+}
+
+/******************************************************************************
+function:	The main loop until TP_Service has something, at most Ms
+******************************************************************************/
+static bool Next_Event(TP_EVENT *pEvent, uint32_t Ms)
+{
+    uint32_t i;
+
+    for (i = 0; i < Ms; i++) {
+        if (TP_Service(pEvent))
+            return true;
+        sleep_ms(1);
+    }
+    return false;
+}
+
+static bool Near(int Value, int Expected)
+{
+    return Value >= Expected - 1 && Value <= Expected + 1;
+}
+
+int main(void)
+{
+    static const int16_t Outliers[] = {3, -2, 0, 400, 1, -1, 2, -300, 0, 1};
+    static const int16_t Spread[] = {-100, 100};
+    TP_EVENT Event;
+    TP_STATS Start;
+    VP_STATS Bus_Start, Bus;
+    float Fac;
+    int16_t Off;
+    uint32_t Lcd_Hz, Down_Ms;
+    int i;
+
+    VP_Init(VP_ILI9486);
+    System_Init();
+    LCD_Init(SCAN_DIR_DFT, 800);
+    Lcd_Hz = spi_get_baudrate(SPI_PORT);
+    TP_Init(SCAN_DIR_DFT);
+    CHECK(!TP_Calibrated());
+
+    //Calibration, saved to flash
+    VP_SetPenHook(Stylus_Hook);
+    TP_Adjust();
+    VP_SetPenHook(NULL);
+    CHECK(Stylus_Corner == 3);
+    CHECK(TP_Calibrated());
+    memcpy(&Fac, host_flash + CAL_OFFSET + 8, sizeof(Fac));
+    CHECK(Fac > 0.0905f && Fac < 0.0913f);		//1/11
+    memcpy(&Fac, host_flash + CAL_OFFSET + 12, sizeof(Fac));
+    CHECK(Fac > 0.1329f && Fac < 0.1338f);		//2/15
+    memcpy(&Off, host_flash + CAL_OFFSET + 16, sizeof(Off));
+    CHECK(Off == -22);
+    memcpy(&Off, host_flash + CAL_OFFSET + 18, sizeof(Off));
+    CHECK(Off == -26);
+
+    //A press through a noisy burst: the median drops one outlier each way
+    Start = sTP_Stats;
+    VP_GetStats(&Bus_Start);
+    VP_SetPenNoise(Outliers, sizeof(Outliers) / sizeof(Outliers[0]));
+    Press(100, 200);
+    CHECK(Next_Event(&Event, 50));
+    CHECK(Event.Type == TP_EVENT_DOWN);
+    CHECK(Near(Event.Xpoint, 101) && Near(Event.Ypoint, 201));
+    CHECK(sTP_Stats.Irqs - Start.Irqs == 1);
+    CHECK(sTP_Stats.Rejected == Start.Rejected);
+    Down_Ms = to_ms_since_boot(get_absolute_time());
+
+    //A move closes in a quarter of the way per burst
+    Press(200, 300);
+    CHECK(Next_Event(&Event, 50));
+    CHECK(Event.Type == TP_EVENT_MOVE);
+    CHECK(Near(Event.Xpoint, 101 + 25) && Near(Event.Ypoint, 201 + 25));
+    for (i = 0; i < 40; i++) {
+        CHECK(Next_Event(&Event, 50));
+        CHECK(Event.Type == TP_EVENT_MOVE);
+    }
+    CHECK(Near(Event.Xpoint, 201) && Near(Event.Ypoint, 301));
+    CHECK(sTP_Stats.Rejected == Start.Rejected);
+
+    //Readings spread wider than TP_SPREAD_MAX are no position
+    VP_SetPenNoise(Spread, sizeof(Spread) / sizeof(Spread[0]));
+    Start.Rejected = sTP_Stats.Rejected;
+    CHECK(!Next_Event(&Event, 50));
+    CHECK(sTP_Stats.Rejected - Start.Rejected >= 4);
+    VP_SetPenNoise(NULL, 0);
+
+    //The bursts toggle PENIRQ, the interrupt stays off until the release
+    CHECK(sTP_Stats.Irqs - Start.Irqs == 1);
+    VP_SetPen(false, 0, 0);
+    CHECK(Next_Event(&Event, 50));
+    CHECK(Event.Type == TP_EVENT_UP);
+    CHECK(Near(Event.Xpoint, 201) && Near(Event.Ypoint, 301));
+    Down_Ms = to_ms_since_boot(get_absolute_time()) - Down_Ms;
+    CHECK(Event.Held_Ms <= Down_Ms && Event.Held_Ms + 10 >= Down_Ms);
+    CHECK(!Next_Event(&Event, 50));
+
+    //Armed again
+    Press(50, 60);
+    CHECK(Next_Event(&Event, 50));
+    CHECK(Event.Type == TP_EVENT_DOWN);
+    CHECK(Near(Event.Xpoint, 51) && Near(Event.Ypoint, 61));
+    CHECK(sTP_Stats.Irqs - Start.Irqs == 2);
+    VP_SetPen(false, 0, 0);
+    CHECK(Next_Event(&Event, 50) && Event.Type == TP_EVENT_UP);
+
+    //The touch controller is clocked within its limit, the LCD gets its
+    //own clock back
+    VP_StatsSince(&Bus_Start, &Bus);
+    CHECK(Bus.Tp_Bytes >= 40 * (4 * TP_SAMPLES + 1));
+    CHECK(Bus.Tp_Fast_Bytes == 0);
+    GUI_DrawRectangle(0, 0, 40, 40, BLUE, DRAW_FULL, DOT_PIXEL_1X1);
+    sleep_ms(1);
+    CHECK(spi_get_baudrate(SPI_PORT) == Lcd_Hz);
+    CHECK(VP_GetPixel(20, 20) == BLUE);
+
+    //The calibration comes back from flash, and not once it is damaged
+    TP_Init(SCAN_DIR_DFT);
+    CHECK(TP_Calibrated());
+    Press(100, 200);
+    CHECK(Next_Event(&Event, 50));
+    CHECK(Event.Type == TP_EVENT_DOWN);
+    CHECK(Near(Event.Xpoint, 101) && Near(Event.Ypoint, 201));
+    VP_SetPen(false, 0, 0);
+    CHECK(Next_Event(&Event, 50) && Event.Type == TP_EVENT_UP);
+
+    host_flash[CAL_OFFSET + 8] ^= 0x01;
+    TP_Init(SCAN_DIR_DFT);
+    CHECK(!TP_Calibrated());
+
+    if (Failures) {
+        printf("%d checks failed\n", Failures);
+        return 1;
+    }
+    printf("Touch checks passed\n");
+    return 0;
+}
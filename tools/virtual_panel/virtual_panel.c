@@ -0,0 +1,583 @@
+/*****************************************************************************
+* | File      	:	virtual_panel.c
+* | Function    :	Host model of the LCD controller behind the SPI bus
+* | Info        :
+*   The GRAM is kept in the controller's own orientation. A window is
+*   addressed in columns and pages, MADCTL MV swaps them onto the GRAM,
+*   MX/MY and the SS/GS bits of 0xB6 mirror them. Snapshots undo the
+*   mapping that is current, so they show what the driver meant to draw;
+*   pixels written under another scan direction (the BMP loader) come out
+*   mirrored or rotated the way they would on the glass. MADCTL BGR and
+*   COLMOD are ignored, pixels are taken as RGB565.
+*   The XPT2046 shifts each conversion out over the 16 clocks after its
+*   command, the busy clock first, so the next command can go out with the
+*   low byte. PENIRQ is low while the pen is down, except while the chip
+*   is selected and converting.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+* | Info        :   Basic version
+*
+******************************************************************************/
+#include "virtual_panel.h"
+#include <stdio.h>
+#include <string.h>
+
+#define VP_GRAM_MAX		(320 * 480)
+
+#define VP_CMD_CASET	0x2A
+#define VP_CMD_PASET	0x2B
+#define VP_CMD_RAMWR	0x2C
+#define VP_CMD_RAMWRC	0x3C
+#define VP_CMD_MADCTL	0x36
+#define VP_CMD_DFC		0xB6	//ILI9486 display function control
+#define VP_CMD_RDID3	0xDC
+
+#define VP_MADCTL_MY	0x80
+#define VP_MADCTL_MX	0x40
+#define VP_MADCTL_MV	0x20
+#define VP_DFC_GS		0x40
+#define VP_DFC_SS		0x20
+
+#define VP_TP_BAUD_MAX	2500000		//XPT2046 DCLK at 2.7 V
+#define VP_TP_START		0x80		//Start bit of a touch command
+#define VP_TP_CHANNEL	0x70
+#define VP_TP_X			0x50		//X+ channel
+#define VP_TP_Y			0x10		//Y+ channel
+#define VP_TP_NOISE_MAX	16
+
+static struct {
+    VP_MODEL Model;
+    uint16_t Gram_W, Gram_H;
+    bool Wide_Params;		//Every parameter is a 16-bit word, value in the low byte
+    uint8_t Id;				//What RDID3 answers
+
+    bool Selected, Data;
+    int16_t Cmd;
+    uint8_t Param[4];
+    uint8_t Param_Num;
+    bool Low_Byte;			//Next byte is the second of a word or pixel
+    uint8_t High;
+
+    uint8_t Madctl, Dfc;
+    uint16_t Col_S, Col_E, Page_S, Page_E;
+    uint16_t Col, Page;
+    bool Window_Moved;
+
+    uint32_t Byte_Ns;
+    uint64_t Time_Ns;
+    uint64_t Bus_Ns;
+    VP_STATS Stats;
+} VP;
+
+static struct {
+    bool Down;
+    uint16_t X_Adc, Y_Adc;
+    int16_t Noise[VP_TP_NOISE_MAX];
+    uint8_t Noise_Len, Noise_Idx;
+    bool Selected;
+    uint16_t Shift;			//Conversion on its way out, MSB first
+    void (*pHook)(void);
+} VP_Tp;
+
+static uint16_t VP_Gram[VP_GRAM_MAX];
+
+/******************************************************************************
+function:	Reset the panel
+******************************************************************************/
+void VP_Init(VP_MODEL Model)
+{
+    uint32_t Baudrate = VP.Byte_Ns ? 8000000000ULL / VP.Byte_Ns : 50000000;
+
+    memset(&VP, 0, sizeof(VP));
+    memset(&VP_Tp, 0, sizeof(VP_Tp));
+    memset(VP_Gram, 0, sizeof(VP_Gram));
+    VP.Model = Model;
+    if(Model == VP_ST7789) {
+        VP.Gram_W = 240;
+        VP.Gram_H = 320;
+        VP.Id = 0x52;
+    } else {
+        VP.Gram_W = 320;
+        VP.Gram_H = 480;
+        VP.Wide_Params = true;
+    }
+    VP.Cmd = -1;
+    VP.Col_E = VP.Gram_W - 1;
+    VP.Page_E = VP.Gram_H - 1;
+    VP_SetBaudrate(Baudrate);
+}
+
+void VP_GetStats(VP_STATS *pStats)
+{
+    *pStats = VP.Stats;
+}
+
+void VP_StatsSince(const VP_STATS *pStart, VP_STATS *pDelta)
+{
+    pDelta->Bytes = VP.Stats.Bytes - pStart->Bytes;
+    pDelta->Cs_Toggles = VP.Stats.Cs_Toggles - pStart->Cs_Toggles;
+    pDelta->Commands = VP.Stats.Commands - pStart->Commands;
+    pDelta->Windows = VP.Stats.Windows - pStart->Windows;
+    pDelta->Pixels = VP.Stats.Pixels - pStart->Pixels;
+    pDelta->Bus_Us = VP.Stats.Bus_Us - pStart->Bus_Us;
+    pDelta->Tp_Bytes = VP.Stats.Tp_Bytes - pStart->Tp_Bytes;
+    pDelta->Tp_Fast_Bytes = VP.Stats.Tp_Fast_Bytes - pStart->Tp_Fast_Bytes;
+}
+
+/******************************************************************************
+function:	Columns and pages the current scan direction addresses
+******************************************************************************/
+uint16_t VP_Width(void)
+{
+    return (VP.Madctl & VP_MADCTL_MV) ? VP.Gram_H : VP.Gram_W;
+}
+
+uint16_t VP_Height(void)
+{
+    return (VP.Madctl & VP_MADCTL_MV) ? VP.Gram_W : VP.Gram_H;
+}
+
+/******************************************************************************
+function:	GRAM index of a column and page
+return:
+	-1 outside the GRAM
+******************************************************************************/
+static int32_t VP_Index(uint16_t Col, uint16_t Page)
+{
+    uint16_t X = Col, Y = Page;
+    bool Mirror_X = !!(VP.Madctl & VP_MADCTL_MX);
+    bool Mirror_Y = !!(VP.Madctl & VP_MADCTL_MY);
+
+    if(VP.Madctl & VP_MADCTL_MV) {
+        X = Page;
+        Y = Col;
+    }
+    if(X >= VP.Gram_W || Y >= VP.Gram_H)
+        return -1;
+
+    if(VP.Model == VP_ILI9486) {
+        Mirror_X ^= !!(VP.Dfc & VP_DFC_SS);
+        Mirror_Y ^= !!(VP.Dfc & VP_DFC_GS);
+    }
+    if(Mirror_X)
+        X = VP.Gram_W - 1 - X;
+    if(Mirror_Y)
+        Y = VP.Gram_H - 1 - Y;
+    return (int32_t)Y * VP.Gram_W + X;
+}
+
+uint16_t VP_GetPixel(uint16_t X, uint16_t Y)
+{
+    int32_t Index = VP_Index(X, Y);
+    return Index < 0 ? 0 : VP_Gram[Index];
+}
+
+/******************************************************************************
+function:	Snapshots
+******************************************************************************/
+static void VP_Rgb888(uint16_t Color, uint8_t *pRgb)
+{
+    pRgb[0] = (Color >> 11) << 3 | (Color >> 13);
+    pRgb[1] = ((Color >> 5) & 0x3f) << 2 | ((Color >> 9) & 0x03);
+    pRgb[2] = (Color & 0x1f) << 3 | ((Color >> 2) & 0x07);
+}
+
+bool VP_SavePPM(const char *pPath)
+{
+    FILE *pFile = fopen(pPath, "wb");
+    uint16_t X, Y;
+    uint8_t Rgb[3];
+
+    if(pFile == NULL)
+        return false;
+    fprintf(pFile, "P6\n%u %u\n255\n", VP_Width(), VP_Height());
+    for(Y = 0; Y < VP_Height(); Y++) {
+        for(X = 0; X < VP_Width(); X++) {
+            VP_Rgb888(VP_GetPixel(X, Y), Rgb);
+            fwrite(Rgb, 1, 3, pFile);
+        }
+    }
+    return fclose(pFile) == 0;
+}
+
+static uint32_t VP_Crc(uint32_t Crc, const uint8_t *pData, uint32_t Len)
+{
+    uint32_t i;
+    uint8_t Bit;
+
+    Crc = ~Crc;
+    for(i = 0; i < Len; i++) {
+        Crc ^= pData[i];
+        for(Bit = 0; Bit < 8; Bit++)
+            Crc = (Crc >> 1) ^ (0xEDB88320u & -(Crc & 1));
+    }
+    return ~Crc;
+}
+
+static void VP_Put32(uint8_t *pOut, uint32_t Value)
+{
+    pOut[0] = Value >> 24;
+    pOut[1] = Value >> 16;
+    pOut[2] = Value >> 8;
+    pOut[3] = Value;
+}
+
+static uint32_t VP_Get32(const uint8_t *pIn)
+{
+    return (uint32_t)pIn[0] << 24 | (uint32_t)pIn[1] << 16 | (uint32_t)pIn[2] << 8 | pIn[3];
+}
+
+static void VP_Chunk(FILE *pFile, const char *pType, const uint8_t *pData, uint32_t Len)
+{
+    uint8_t Head[8], Tail[4];
+    uint32_t Crc;
+
+    VP_Put32(Head, Len);
+    memcpy(Head + 4, pType, 4);
+    Crc = VP_Crc(0, Head + 4, 4);
+    Crc = VP_Crc(Crc, pData, Len);
+    VP_Put32(Tail, Crc);
+    fwrite(Head, 1, 8, pFile);
+    fwrite(pData, 1, Len, pFile);
+    fwrite(Tail, 1, 4, pFile);
+}
+
+static const uint8_t VP_Png_Signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+static uint8_t VP_Idat[2 + 480 * (5 + 1 + 480 * 3) + 4];	//Image data of the largest panel
+
+/******************************************************************************
+function:	Save a PNG
+note:
+	Uncompressed: one stored deflate block per image row, no zlib needed
+******************************************************************************/
+bool VP_SavePNG(const char *pPath)
+{
+    uint16_t W = VP_Width(), H = VP_Height(), X, Y;
+    uint32_t Row_Len = 1 + (uint32_t)W * 3, Pos = 0, A = 1, B = 0, i;
+    uint8_t Ihdr[13];
+    FILE *pFile = fopen(pPath, "wb");
+
+    if(pFile == NULL)
+        return false;
+
+    VP_Put32(Ihdr, W);
+    VP_Put32(Ihdr + 4, H);
+    Ihdr[8] = 8;		//Bit depth
+    Ihdr[9] = 2;		//RGB
+    Ihdr[10] = Ihdr[11] = Ihdr[12] = 0;
+
+    VP_Idat[Pos++] = 0x78;
+    VP_Idat[Pos++] = 0x01;
+    for(Y = 0; Y < H; Y++) {
+        uint8_t *pRow;
+        VP_Idat[Pos++] = Y == H - 1;	//Last block
+        VP_Idat[Pos++] = Row_Len & 0xff;
+        VP_Idat[Pos++] = Row_Len >> 8;
+        VP_Idat[Pos++] = ~Row_Len & 0xff;
+        VP_Idat[Pos++] = (~Row_Len >> 8) & 0xff;
+        pRow = &VP_Idat[Pos];
+        pRow[0] = 0;		//No filter
+        for(X = 0; X < W; X++)
+            VP_Rgb888(VP_GetPixel(X, Y), &pRow[1 + X * 3]);
+        for(i = 0; i < Row_Len; i++) {
+            A = (A + pRow[i]) % 65521;
+            B = (B + A) % 65521;
+        }
+        Pos += Row_Len;
+    }
+    VP_Put32(&VP_Idat[Pos], B << 16 | A);
+    Pos += 4;
+
+    fwrite(VP_Png_Signature, 1, 8, pFile);
+    VP_Chunk(pFile, "IHDR", Ihdr, sizeof(Ihdr));
+    VP_Chunk(pFile, "IDAT", VP_Idat, Pos);
+    VP_Chunk(pFile, "IEND", NULL, 0);
+    return fclose(pFile) == 0;
+}
+
+/******************************************************************************
+function:	Compare the picture with a PNG
+note:
+	Reads what VP_SavePNG writes, stored deflate blocks and unfiltered
+	rows: golden images are saved by the bench, not by an image editor
+return:	Pixels that differ, -1 for a file that cannot be read or is
+		another size
+******************************************************************************/
+int32_t VP_ComparePNG(const char *pPath)
+{
+    uint16_t W = VP_Width(), H = VP_Height(), X, Y;
+    uint32_t Row_Len = 1 + (uint32_t)W * 3, Pos = 0, In = 2, Out = 0, Len;
+    uint8_t Head[8], Ihdr[13], Rgb[3];
+    bool Sized = false, Final = false;
+    int32_t Differ = 0;
+    FILE *pFile = fopen(pPath, "rb");
+
+    if(pFile == NULL)
+        return -1;
+    if(fread(Head, 1, 8, pFile) != 8 || memcmp(Head, VP_Png_Signature, 8) != 0) {
+        fclose(pFile);
+        return -1;
+    }
+    while(fread(Head, 1, 8, pFile) == 8 && memcmp(Head + 4, "IEND", 4) != 0) {
+        Len = VP_Get32(Head);
+        if(memcmp(Head + 4, "IHDR", 4) == 0 && Len == sizeof(Ihdr)) {
+            if(fread(Ihdr, 1, sizeof(Ihdr), pFile) != sizeof(Ihdr))
+                break;
+            Sized = VP_Get32(Ihdr) == W && VP_Get32(Ihdr + 4) == H && Ihdr[8] == 8 && Ihdr[9] == 2;
+        } else if(memcmp(Head + 4, "IDAT", 4) == 0 && Pos + Len <= sizeof(VP_Idat)) {
+            if(fread(VP_Idat + Pos, 1, Len, pFile) != Len)
+                break;
+            Pos += Len;
+        } else {
+            fseek(pFile, Len, SEEK_CUR);
+        }
+        fseek(pFile, 4, SEEK_CUR);		//CRC
+    }
+    fclose(pFile);
+    if(!Sized)
+        return -1;
+
+    //The stored blocks' data back to back, in place
+    while(!Final) {
+        if(In + 5 > Pos || (VP_Idat[In] & 0x06) != 0)
+            return -1;
+        Final = VP_Idat[In] & 0x01;
+        Len = VP_Idat[In + 1] | VP_Idat[In + 2] << 8;
+        In += 5;
+        if(In + Len > Pos)
+            return -1;
+        memmove(VP_Idat + Out, VP_Idat + In, Len);
+        In += Len;
+        Out += Len;
+    }
+    if(Out != Row_Len * H)
+        return -1;
+
+    for(Y = 0; Y < H; Y++) {
+        const uint8_t *pRow = &VP_Idat[Y * Row_Len];
+        if(pRow[0] != 0)
+            return -1;
+        for(X = 0; X < W; X++) {
+            VP_Rgb888(VP_GetPixel(X, Y), Rgb);
+            Differ += memcmp(Rgb, &pRow[1 + X * 3], 3) != 0;
+        }
+    }
+    return Differ;
+}
+
+/******************************************************************************
+function:	Virtual clock
+******************************************************************************/
+uint64_t VP_Time_Us(void)
+{
+    return VP.Time_Ns / 1000;
+}
+
+void VP_Advance_Us(uint64_t Us)
+{
+    VP.Time_Ns += Us * 1000;
+}
+
+/******************************************************************************
+function:	Bus side
+******************************************************************************/
+void VP_SetBaudrate(uint32_t Baudrate)
+{
+    VP.Byte_Ns = 8000000000ULL / Baudrate;
+}
+
+void VP_Select(bool Selected)
+{
+    if(Selected && !VP.Selected)
+        VP.Stats.Cs_Toggles++;
+    VP.Selected = Selected;
+    VP.Low_Byte = false;
+}
+
+void VP_SetDataMode(bool Data)
+{
+    VP.Data = Data;
+}
+
+/******************************************************************************
+function:	One parameter byte of the current command
+******************************************************************************/
+static void VP_Param(uint8_t Value)
+{
+    if(VP.Param_Num < sizeof(VP.Param))
+        VP.Param[VP.Param_Num] = Value;
+    VP.Param_Num++;
+
+    switch(VP.Cmd) {
+    case VP_CMD_CASET:
+    case VP_CMD_PASET:
+        if(VP.Param_Num == 4) {
+            uint16_t Start = VP.Param[0] << 8 | VP.Param[1];
+            uint16_t End = VP.Param[2] << 8 | VP.Param[3];
+            if(VP.Cmd == VP_CMD_CASET) {
+                VP.Col_S = Start;
+                VP.Col_E = End;
+            } else {
+                VP.Page_S = Start;
+                VP.Page_E = End;
+            }
+            VP.Window_Moved = true;
+        }
+        break;
+    case VP_CMD_MADCTL:
+        if(VP.Param_Num == 1)
+            VP.Madctl = Value;
+        break;
+    case VP_CMD_DFC:
+        if(VP.Param_Num == 2)
+            VP.Dfc = Value;
+        break;
+    }
+}
+
+/******************************************************************************
+function:	One pixel at the address counter
+******************************************************************************/
+static void VP_Pixel(uint16_t Color)
+{
+    int32_t Index = VP_Index(VP.Col, VP.Page);
+    uint16_t Col_E = VP.Col_E < VP.Col_S ? VP.Col_S : VP.Col_E;
+    uint16_t Page_E = VP.Page_E < VP.Page_S ? VP.Page_S : VP.Page_E;
+
+    if(Index >= 0)
+        VP_Gram[Index] = Color;
+    VP.Stats.Pixels++;
+
+    if(++VP.Col > Col_E) {
+        VP.Col = VP.Col_S;
+        if(++VP.Page > Page_E)
+            VP.Page = VP.Page_S;
+    }
+}
+
+/******************************************************************************
+function:	Clock one byte through the panel
+return:
+	The byte the panel drives back
+******************************************************************************/
+uint8_t VP_Transfer(uint8_t Byte)
+{
+    uint8_t Reply = 0;
+
+    VP.Time_Ns += VP.Byte_Ns;
+    VP.Bus_Ns += VP.Byte_Ns;
+    VP.Stats.Bus_Us = VP.Bus_Ns / 1000;
+    if(!VP.Selected)
+        return 0xff;
+    VP.Stats.Bytes++;
+
+    if(!VP.Data) {
+        //RDID3 answers on the byte after the command
+        if(VP.Cmd == VP_CMD_RDID3)
+            Reply = VP.Id;
+        VP.Cmd = Byte;
+        VP.Param_Num = 0;
+        VP.Low_Byte = false;
+        VP.Stats.Commands++;
+        if(Byte == VP_CMD_RAMWR) {
+            VP.Col = VP.Col_S;
+            VP.Page = VP.Page_S;
+            if(VP.Window_Moved)
+                VP.Stats.Windows++;
+            VP.Window_Moved = false;
+        }
+        return Reply;
+    }
+
+    if(VP.Cmd == VP_CMD_RAMWR || VP.Cmd == VP_CMD_RAMWRC) {
+        if(!VP.Low_Byte) {
+            VP.High = Byte;
+            VP.Low_Byte = true;
+        } else {
+            VP.Low_Byte = false;
+            VP_Pixel(VP.High << 8 | Byte);
+        }
+    } else if(VP.Wide_Params) {
+        if(!VP.Low_Byte) {
+            VP.Low_Byte = true;
+        } else {
+            VP.Low_Byte = false;
+            VP_Param(Byte);
+        }
+    } else {
+        VP_Param(Byte);
+    }
+    return Reply;
+}
+
+/******************************************************************************
+function:	Touch controller, the side a test drives
+******************************************************************************/
+void VP_SetPen(bool Down, uint16_t X_Adc, uint16_t Y_Adc)
+{
+    VP_Tp.Down = Down;
+    VP_Tp.X_Adc = X_Adc;
+    VP_Tp.Y_Adc = Y_Adc;
+}
+
+void VP_SetPenNoise(const int16_t *pNoise, uint8_t Len)
+{
+    VP_Tp.Noise_Len = Len < VP_TP_NOISE_MAX ? Len : VP_TP_NOISE_MAX;
+    memcpy(VP_Tp.Noise, pNoise, VP_Tp.Noise_Len * sizeof(int16_t));
+    VP_Tp.Noise_Idx = 0;
+}
+
+void VP_SetPenHook(void (*pHook)(void))
+{
+    VP_Tp.pHook = pHook;
+}
+
+/******************************************************************************
+function:	Touch controller, the bus side
+******************************************************************************/
+void VP_TouchSelect(bool Selected)
+{
+    VP_Tp.Selected = Selected;
+    VP_Tp.Shift = 0;
+}
+
+uint8_t VP_TouchTransfer(uint8_t Byte)
+{
+    uint8_t Reply = VP_Tp.Shift >> 8;
+    uint8_t Channel = Byte & VP_TP_CHANNEL;
+    int32_t Value = 0;
+
+    if(!VP_Tp.Selected)
+        return 0xff;
+    VP.Stats.Tp_Bytes++;
+    if(VP.Byte_Ns < 8000000000ULL / VP_TP_BAUD_MAX)
+        VP.Stats.Tp_Fast_Bytes++;
+    VP_Tp.Shift <<= 8;
+
+    if(!(Byte & VP_TP_START))
+        return Reply;
+    //Nothing to measure with the pen up, the driver takes 0 as no touch
+    if(VP_Tp.Down && (Channel == VP_TP_X || Channel == VP_TP_Y)) {
+        Value = Channel == VP_TP_X ? VP_Tp.X_Adc : VP_Tp.Y_Adc;
+        if(VP_Tp.Noise_Len) {
+            Value += VP_Tp.Noise[VP_Tp.Noise_Idx];
+            VP_Tp.Noise_Idx = (VP_Tp.Noise_Idx + 1) % VP_Tp.Noise_Len;
+        }
+        Value = Value < 0 ? 0 : Value > 4095 ? 4095 : Value;
+    }
+    VP_Tp.Shift = Value << 3;
+    return Reply;
+}
+
+bool VP_PenIrq(void)
+{
+    return !VP_Tp.Down || VP_Tp.Selected;
+}
+
+bool VP_ReadPenIrq(void)
+{
+    if(VP_Tp.pHook)
+        VP_Tp.pHook();
+    return VP_PenIrq();
+}
@@ -0,0 +1,89 @@
+/*****************************************************************************
+* | File      	:	virtual_panel.h
+* | Function    :	Host model of the LCD controller behind the SPI bus
+* | Info        :
+*   Decodes the command stream LCD_Driver.c sends: CASET/PASET windows,
+*   RAMWR/RAMWRC pixel data, MADCTL and the ILI9486 scan direction in
+*   0xB6. Pixels land in an in-memory GRAM that can be saved as PPM or
+*   PNG. Every byte the panel sees is counted, and the virtual clock
+*   behind time_us_64() moves by the time the byte takes on the wire.
+*   The XPT2046 touch controller on the same bus answers conversions
+*   with a pen position the caller sets, and drives PENIRQ.
+*----------------
+* |	This version:   V1.0
+* | Date        :   2026-10-18
+* | Info        :   Basic version
+*
+******************************************************************************/
+#ifndef __VIRTUAL_PANEL_H
+#define __VIRTUAL_PANEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************************************************************************
+function:
+			Controllers the driver can talk to
+********************************************************************************/
+typedef enum {
+    VP_ILI9486 = 0,		//Pico-ResTouch-LCD-3.5, 320x480, parameters as 16-bit words
+    VP_ST7789,			//Pico-ResTouch-LCD-2.8, 240x320, parameters as bytes
+} VP_MODEL;
+
+/********************************************************************************
+function:
+			Bus counters, take two and subtract for the cost of a frame
+********************************************************************************/
+typedef struct {
+    uint64_t Bytes;			//Bytes clocked in while the panel was selected
+    uint64_t Cs_Toggles;	//Times chip select was asserted
+    uint64_t Commands;		//Command bytes
+    uint64_t Windows;		//Memory writes started after the window moved
+    uint64_t Pixels;		//Pixels written
+    uint64_t Bus_Us;		//Time the bus was busy
+    uint64_t Tp_Bytes;		//Bytes clocked in while the touch controller was selected
+    uint64_t Tp_Fast_Bytes;	//Of those, faster than the XPT2046's 2.5 MHz
+} VP_STATS;
+
+void VP_Init(VP_MODEL Model);
+void VP_GetStats(VP_STATS *pStats);
+void VP_StatsSince(const VP_STATS *pStart, VP_STATS *pDelta);
+
+//The picture in the coordinates of the current scan direction
+uint16_t VP_Width(void);
+uint16_t VP_Height(void);
+uint16_t VP_GetPixel(uint16_t X, uint16_t Y);
+bool VP_SavePPM(const char *pPath);
+bool VP_SavePNG(const char *pPath);
+int32_t VP_ComparePNG(const char *pPath);	//Pixels that differ, -1 unreadable
+
+//Touch controller. The position is in ADC counts, the noise is added to
+//the conversions in turn. The hook runs each time the driver reads
+//PENIRQ, a test moves the pen from there while a driver loop polls it.
+void VP_SetPen(bool Down, uint16_t X_Adc, uint16_t Y_Adc);
+void VP_SetPenNoise(const int16_t *pNoise, uint8_t Len);
+void VP_SetPenHook(void (*pHook)(void));
+
+//Virtual clock
+uint64_t VP_Time_Us(void);
+void VP_Advance_Us(uint64_t Us);
+
+//Bus side, called by the SDK stand-ins
+void VP_SetBaudrate(uint32_t Baudrate);
+void VP_Select(bool Selected);
+void VP_SetDataMode(bool Data);
+uint8_t VP_Transfer(uint8_t Byte);
+void VP_TouchSelect(bool Selected);
+uint8_t VP_TouchTransfer(uint8_t Byte);
+bool VP_PenIrq(void);		//PENIRQ, low while the pen is down
+bool VP_ReadPenIrq(void);	//The same, read by the driver, runs the hook
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif